@@ -292,6 +292,19 @@ namespace Keysticks.Core
         public const int REQUEST_INSTALL_PACKAGES = 18;
         public const int REQUEST_UNINSTALL_PACKAGES = 19;
         public const int REQUEST_SET_ACTIVE_DICTIONARIES = 20;
+        public const int REQUEST_CONFIGURE_CORRECTION = 21;
+        public const int REQUEST_GET_NEXT_LETTERS = 22;
+        public const int REQUEST_CONFIGURE_PHRASES = 23;
+        public const int REQUEST_SET_KEY_GROUPS = 24;
+        public const int REQUEST_INSERT_AMBIGUOUS = 25;
+        public const int REQUEST_SET_PERSONAL_CAPACITY = 26;
+        public const int REQUEST_GET_PERSONAL_STATUS = 27;
+        public const int REQUEST_LEARN_FILES = 28;
+        public const int REQUEST_GET_PERSONAL_PAGE = 29;
+        public const int REQUEST_EXPORT_PERSONAL = 30;
+        public const int REQUEST_IMPORT_PERSONAL = 31;
+        public const int REQUEST_SET_PARTITION = 32;
+        public const int REQUEST_GET_LEARN_PROGRESS = 33;
         public const int RESPONSE_ERROR_UNRECOGNISED_MSG_TYPE = 200;
         public const int RESPONSE_ERROR_BUFFER_OVERFLOW = 201;
         public const int RESPONSE_ERROR_RESET = 210;
@@ -305,6 +318,23 @@ namespace Keysticks.Core
         public const int RESPONSE_ERROR_INSTALL_PACKAGES = 218;
         public const int RESPONSE_ERROR_UNINSTALL_PACKAGES = 219;
         public const int RESPONSE_ERROR_SET_ACTIVE_DICTIONARIES = 220;
+        public const int RESPONSE_ERROR_CONFIGURE_CORRECTION = 221;
+        public const int RESPONSE_ERROR_GET_NEXT_LETTERS = 222;
+        public const int RESPONSE_ERROR_CONFIGURE_PHRASES = 223;
+        public const int RESPONSE_ERROR_SET_KEY_GROUPS = 224;
+        public const int RESPONSE_ERROR_INSERT_AMBIGUOUS = 225;
+        public const int RESPONSE_ERROR_SET_PERSONAL_CAPACITY = 226;
+        public const int RESPONSE_ERROR_GET_PERSONAL_STATUS = 227;
+        public const int RESPONSE_ERROR_LEARN_FILES = 228;
+        public const int RESPONSE_ERROR_GET_PERSONAL_PAGE = 229;
+        public const int RESPONSE_ERROR_EXPORT_PERSONAL = 230;
+        public const int RESPONSE_ERROR_IMPORT_PERSONAL = 231;
+        public const int RESPONSE_ERROR_SET_PARTITION = 232;
+        public const int RESPONSE_ERROR_GET_LEARN_PROGRESS = 233;
+        public const int LEARN_STATE_IDLE = 0;
+        public const int LEARN_STATE_COUNTING = 1;
+        public const int LEARN_STATE_LEARNING = 2;
+        public const int LEARN_STATE_DONE = 3;
 
         // UI settings
         public const int MaxTinyDescriptionLen = 16;
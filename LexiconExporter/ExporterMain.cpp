@@ -0,0 +1,63 @@
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+
+#include "stdafx.h"
+#include <stdio.h>
+#include "FrameworkWrapper.h"
+#include "LexiconExporter.h"
+
+// Export the native word lists that are missing, for a comma-delimited list of dictionaries or the active dictionaries
+// Usage: LexiconExporter <base path> [<dictionary>,<dictionary>...]
+// Returns 0 if every missing word list was exported
+int wmain(int argc, wchar_t *argv[])
+{
+	if (argc < 2)
+	{
+		wprintf(_T("Usage: LexiconExporter <base path> [<dictionary>,<dictionary>...]\n"));
+		return 2;
+	}
+
+	const KPTSysCharT *pBasePath = argv[1];
+	FrameworkWrapper framework;
+	if (framework.Create(pBasePath) != 0)
+	{
+		wprintf(_T("Couldn't create the OpenAdaptxt framework for %s\n"), pBasePath);
+		return 1;
+	}
+
+	KPTUniCharT dictList[MAX_STR_LEN];
+	bool success = false;
+	if (argc > 2)
+	{
+		wcsncpy_s(dictList, argv[2], MAX_STR_LEN);
+		success = true;
+	}
+	else if (KPTRESULT_ISSUCCESS(framework.DICTIONARY_GETACTIVELIST(dictList, MAX_STR_LEN)))
+	{
+		success = true;
+	}
+	else
+	{
+		wprintf(_T("Couldn't get the active dictionaries\n"));
+	}
+
+	if (success)
+	{
+		LexiconExporter exporter(framework);
+		success = exporter.ExportMissing(pBasePath, dictList);
+	}
+	framework.Destroy();
+
+	return success ? 0 : 1;
+}
@@ -0,0 +1,279 @@
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+#include "stdafx.h"
+#include <algorithm>
+#include <deque>
+#include "Lexicon.h"
+#include "LexiconExporter.h"
+#include "MappedFile.h"
+#include "WordListFile.h"
+
+	// Constructor
+	LexiconExporter::LexiconExporter(FrameworkWrapper &framework)
+		: _framework(framework)
+	{
+		_maxSuggestions = LEXICON_EXPORT_SUGGESTIONS;
+		_queryCount = 0;
+		_hasMore = false;
+	}
+
+	// Destructor
+	LexiconExporter::~LexiconExporter(void)
+	{
+	}
+
+	// Export the word list of each dictionary in a comma-delimited list that doesn't have one
+	// Returns false if any of them couldn't be exported
+	bool LexiconExporter::ExportMissing(const KPTSysCharT *pBasePath, const KPTUniCharT *dictList)
+	{
+		// Copy token list string into modifiable string
+		KPTUniCharT *nextToken;
+		KPTUniCharT dictListCopy[MAX_STR_LEN];
+		wcsncpy_s(dictListCopy, dictList, MAX_STR_LEN);
+
+		std::vector<std::wstring> missing;
+		KPTSysCharT filePath[MAX_PATH];
+		uint64_t fileSize;
+		uint64_t fileTime;
+		KPTUniCharT *token = wcstok_s(dictListCopy, _T(","), &nextToken);
+		while (token != NULL)
+		{
+			swprintf_s(filePath, MAX_PATH, _T("%s\\%s\\%s%s"), pBasePath, LEXICON_FOLDER, token, LEXICON_FILE_EXT);
+			if (!MappedFile::GetFileStamp(filePath, fileSize, fileTime))
+			{
+				missing.push_back(token);
+			}
+
+			token = wcstok_s(NULL, _T(","), &nextToken);
+		}
+
+		if (missing.empty())
+		{
+			wprintf(_T("No word lists are missing\n"));
+			return true;
+		}
+
+		KPTSuggConfigT savedConfig = { 0 };
+		uint32_t savedLearnOptions = 0;
+		if (!KPTRESULT_ISSUCCESS(_framework.SUGGS_GETCONFIG(savedConfig)) ||
+			!KPTRESULT_ISSUCCESS(_framework.LEARN_GETOPTIONS(savedLearnOptions)))
+		{
+			wprintf(_T("Couldn't read the suggestion settings\n"));
+			return false;
+		}
+
+		// Ask for completions from the dictionary as stored, without learning the text of the queries
+		KPTSuggConfigT config = savedConfig;
+		config.maxNumSuggestions = LEXICON_EXPORT_SUGGESTIONS;
+		config.suggestionThreshold = 0;
+		config.proximitySuggestionOn = eKPTFalse;
+		config.errorCorrectionOn = eKPTFalse;
+		config.completionOn = eKPTTrue;
+		config.useStoredCaps = eKPTTrue;
+		config.forceLower = eKPTFalse;
+		config.forceUpper = eKPTFalse;
+		config.useSentenceCase = eKPTFalse;
+		_framework.LEARN_SETOPTIONS(savedLearnOptions & ~(uint32_t)eKPTLearnEnabled);
+		_framework.SUGGS_SETCONFIG(config);
+
+		// The engine may allow fewer suggestions than asked for
+		_maxSuggestions = LEXICON_EXPORT_SUGGESTIONS;
+		if (KPTRESULT_ISSUCCESS(_framework.SUGGS_GETCONFIG(config)) && config.maxNumSuggestions != 0)
+		{
+			_maxSuggestions = config.maxNumSuggestions;
+		}
+
+		// Export each dictionary on its own, so that its words aren't mixed with the others'
+		bool success = true;
+		for (size_t i = 0; i < missing.size(); i++)
+		{
+			if (!KPTRESULT_ISSUCCESS(_framework.DICTIONARY_SETACTIVELIST(missing[i].c_str())) ||
+				!Export(pBasePath, missing[i].c_str()))
+			{
+				wprintf(_T("Couldn't export the word list of %s\n"), missing[i].c_str());
+				success = false;
+			}
+		}
+
+		// The settings are stored in the base path, so put them back as they were
+		_framework.DICTIONARY_SETACTIVELIST(dictList);
+		_framework.SUGGS_SETCONFIG(savedConfig);
+		_framework.LEARN_SETOPTIONS(savedLearnOptions);
+		_framework.INPUTMGR_RESET();
+
+		return success;
+	}
+
+	// Find the words of the active dictionary and write its word list
+	bool LexiconExporter::Export(const KPTSysCharT *pBasePath, const KPTUniCharT *dictName)
+	{
+		_queryCount = 0;
+		_words.clear();
+		_wordIndexes.clear();
+
+		FindWords();
+		if (_words.empty())
+		{
+			wprintf(_T("Couldn't find any words to export for %s\n"), dictName);
+			return false;
+		}
+		SetCounts(_words);
+
+		KPTSysCharT filePath[MAX_PATH];
+		swprintf_s(filePath, MAX_PATH, _T("%s\\%s"), pBasePath, LEXICON_FOLDER);
+		CreateDirectoryW(filePath, NULL);
+
+		swprintf_s(filePath, MAX_PATH, _T("%s\\%s\\%s%s"), pBasePath, LEXICON_FOLDER, dictName, LEXICON_FILE_EXT);
+		bool success = WriteList(filePath, _words);
+		if (success)
+		{
+			wprintf(_T("Exported %u words to %s using %u queries\n"), (unsigned)_words.size(), filePath, (unsigned)_queryCount);
+		}
+
+		return success;
+	}
+
+	// Get the suggestions for some text, or return false if the query limit has been reached or the query failed
+	bool LexiconExporter::Query(const std::wstring &text)
+	{
+		_completions.clear();
+		_nextLetters.clear();
+		_hasMore = false;
+		if (_queryCount >= LEXICON_EXPORT_MAX_QUERIES)
+		{
+			wprintf(_T("Stopped exporting after %u queries, so some rare words are missing\n"), (unsigned)_queryCount);
+			return false;
+		}
+		_queryCount++;
+
+		if (!KPTRESULT_ISSUCCESS(_framework.INPUTMGR_RESET()) ||
+			(!text.empty() && !KPTRESULT_ISSUCCESS(_framework.INPUTMGR_INSERTSTRING(text.c_str(), text.size(), 0))) ||
+			!KPTRESULT_ISSUCCESS(_framework.SUGGS_GETSUGGESTIONS()))
+		{
+			return false;
+		}
+
+		const KPTSuggWordsReplyT &reply = _framework.GetCurrentSuggestions();
+		for (size_t i = 0; i < reply.count; i++)
+		{
+			const KPTSuggEntryT &entry = reply.suggestions[i];
+			if (entry.suggestionString == NULL || entry.suggestionLength == 0)
+			{
+				continue;
+			}
+
+			if (entry.suggestionType == KPTSUGGSTYPE_NEXTLETTER)
+			{
+				_nextLetters.assign(entry.suggestionString, entry.suggestionLength);
+			}
+			else if (entry.suggestionType == KPTSUGGSTYPE_WORD)
+			{
+				_completions.push_back(std::wstring(entry.suggestionString, entry.suggestionLength));
+			}
+		}
+		_hasMore = reply.count >= _maxSuggestions;
+
+		return true;
+	}
+
+	// Find the dictionary's words breadth first, so that they are found roughly in descending order of frequency
+	void LexiconExporter::FindWords(void)
+	{
+		std::deque<std::wstring> prefixes;
+		prefixes.push_back(std::wstring());
+		while (!prefixes.empty() && Query(prefixes.front()))
+		{
+			std::wstring prefix = prefixes.front();
+			prefixes.pop_front();
+
+			size_t i;
+			for (i = 0; i < _completions.size(); i++)
+			{
+				const std::wstring &completion = _completions[i];
+				if (completion.find(L' ') == std::wstring::npos && completion.size() <= MAX_WORD_LEN)
+				{
+					AddWord(completion);
+				}
+			}
+
+			// The empty input gives the first letters, but other prefixes only need extending if there may be more completions
+			if ((!prefix.empty() && !_hasMore) || prefix.size() >= MAX_WORD_LEN)
+			{
+				continue;
+			}
+			if (prefix.empty() && _nextLetters.empty())
+			{
+				for (i = 0; i < _completions.size(); i++)
+				{
+					_nextLetters.push_back(_completions[i][0]);
+				}
+			}
+
+			// Letters that differ only by case lead to the same words
+			std::wstring foldedLetters;
+			for (i = 0; i < _nextLetters.size(); i++)
+			{
+				KPTUniCharT ch = _nextLetters[i];
+				if (ch != L' ' && foldedLetters.find(Lexicon::Fold(ch)) == std::wstring::npos)
+				{
+					foldedLetters.push_back(Lexicon::Fold(ch));
+					prefixes.push_back(prefix + ch);
+				}
+			}
+		}
+	}
+
+	// Add a word unless it has already been found with any capitalisation
+	void LexiconExporter::AddWord(const std::wstring &text)
+	{
+		std::wstring folded(text);
+		std::transform(folded.begin(), folded.end(), folded.begin(), Lexicon::Fold);
+		if (_wordIndexes.find(folded) == _wordIndexes.end())
+		{
+			_wordIndexes[folded] = _words.size();
+			WordCountT item = { text, 0 };
+			_words.push_back(item);
+		}
+	}
+
+	// Set the counts of words found most frequent first, from Zipf's law
+	void LexiconExporter::SetCounts(std::vector<WordCountT> &items)
+	{
+		for (size_t i = 0; i < items.size(); i++)
+		{
+			items[i].count = (std::max)((uint32_t)(LEXICON_EXPORT_TOP_COUNT / (i + 1)), 1u);
+		}
+	}
+
+	// Write a list to a temporary file and move it into place, so that a partly written list is never loaded
+	bool LexiconExporter::WriteList(const KPTSysCharT *pFilePath, const std::vector<WordCountT> &items)
+	{
+		KPTSysCharT tempPath[MAX_PATH];
+		swprintf_s(tempPath, MAX_PATH, _T("%s.tmp"), pFilePath);
+
+		WordListWriter writer;
+		if (!writer.Open(tempPath))
+		{
+			return false;
+		}
+		writer.WriteWords(items);
+		if (!writer.Close() || !MappedFile::ReplaceFile(tempPath, pFilePath))
+		{
+			DeleteFileW(tempPath);
+			wprintf(_T("Couldn't write %s\n"), pFilePath);
+			return false;
+		}
+
+		return true;
+	}
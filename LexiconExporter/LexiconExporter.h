@@ -0,0 +1,56 @@
+#pragma once
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "kptapi.h"
+#include "CorpusLearner.h"
+#include "FrameworkWrapper.h"
+
+	// Exports the native word list of a dictionary that doesn't have one e.g. Lexicon\enggb.txt, from the OpenAdaptxt
+	// dictionary. The engine can't list its words, so they are found by asking for the completions of prefixes breadth
+	// first, only extending a prefix whose completions filled the suggestion list. The engine suggests more frequent words
+	// first, so counts are assigned by Zipf's law from the order words are found. Next-word n-grams and phrases aren't
+	// exported, because the engine gives no counts for them.
+	// This runs in the LexiconExporter tool rather than in the component, because an export takes thousands of queries
+	// and changes the engine's settings and input while it runs.
+	class LexiconExporter
+	{
+	private:
+		FrameworkWrapper &_framework;
+		size_t _maxSuggestions;
+		size_t _queryCount;
+		bool _hasMore;											// Whether the last query filled the suggestion list
+		std::vector<std::wstring> _completions;					// Word suggestions from the last query
+		std::wstring _nextLetters;								// Letters that can follow the text of the last query
+		std::vector<WordCountT> _words;							// Words in the order they were found
+		std::unordered_map<std::wstring, size_t> _wordIndexes;	// Index of each word by its folded text
+
+	public:
+		LexiconExporter(FrameworkWrapper &framework);
+		~LexiconExporter(void);
+
+		bool ExportMissing(const KPTSysCharT *pBasePath, const KPTUniCharT *dictList);
+
+	private:
+		LexiconExporter &operator=(const LexiconExporter &);
+		bool Export(const KPTSysCharT *pBasePath, const KPTUniCharT *dictName);
+		bool Query(const std::wstring &text);
+		void FindWords(void);
+		void AddWord(const std::wstring &text);
+		static void SetCounts(std::vector<WordCountT> &items);
+		static bool WriteList(const KPTSysCharT *pFilePath, const std::vector<WordCountT> &items);
+	};
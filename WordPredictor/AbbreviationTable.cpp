@@ -0,0 +1,162 @@
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+#include "stdafx.h"
+#include "Lexicon.h"
+#include "AbbreviationTable.h"
+
+	// Constructor
+	AbbreviationTable::AbbreviationTable(void)
+	{
+	}
+
+	// Destructor
+	AbbreviationTable::~AbbreviationTable(void)
+	{
+	}
+
+	// Read the abbreviations file in the base path, replacing any abbreviations already loaded
+	bool AbbreviationTable::Load(const KPTSysCharT *pBasePath)
+	{
+		Clear();
+
+		KPTSysCharT filePath[MAX_PATH];
+		swprintf_s(filePath, MAX_PATH, _T("%s\\%s"), pBasePath, ABBREVIATION_FILE);
+
+		FILE *pFile = NULL;
+		if (0 != _wfopen_s(&pFile, filePath, _T("rt, ccs=UTF-8")) || pFile == NULL)
+		{
+			return false;
+		}
+
+		KPTUniCharT line[MAX_STR_LEN];
+		while (fgetws(line, MAX_STR_LEN, pFile) != NULL)
+		{
+			// Split into abbreviation and expansion
+			size_t keyLength = wcscspn(line, _T("\t\r\n"));
+			if (line[keyLength] != L'\t')
+			{
+				continue;
+			}
+			const KPTUniCharT *expansion = &line[keyLength + 1];
+			size_t expansionLength = wcscspn(expansion, _T("\r\n"));
+			if (keyLength > 0 && keyLength <= MAX_WORD_LEN && expansionLength > 0 && expansionLength <= MAX_PHRASE_LEN)
+			{
+				AddEntry(line, keyLength, expansion, expansionLength);
+			}
+		}
+
+		fclose(pFile);
+
+		if (_entries.empty())
+		{
+			return false;
+		}
+
+		BuildTable();
+		TRACE(_T("Loaded %u abbreviations from %s\n"), (unsigned)_entries.size(), filePath);
+
+		return true;
+	}
+
+	// Remove all the abbreviations
+	void AbbreviationTable::Clear(void)
+	{
+		std::vector<KPTUniCharT>().swap(_chars);
+		std::vector<AbbreviationT>().swap(_entries);
+		std::vector<AbbreviationSlotT>().swap(_slots);
+	}
+
+	// Find the expansions of a word, in the order they are listed
+	void AbbreviationTable::Find(const KPTUniCharT *word, size_t length, std::vector<uint32_t> &entries) const
+	{
+		entries.clear();
+		if (_slots.empty() || length == 0 || length > MAX_WORD_LEN)
+		{
+			return;
+		}
+
+		uint64_t hash = Lexicon::HashWord(word, length);
+		uint32_t fingerprint = (uint32_t)(hash >> 32);
+		size_t mask = _slots.size() - 1;
+		for (size_t slot = (size_t)hash & mask; _slots[slot].entry != ABBREVIATION_NO_ENTRY; slot = (slot + 1) & mask)
+		{
+			if (_slots[slot].fingerprint == fingerprint && IsMatch(_slots[slot].entry, word, length))
+			{
+				entries.push_back(_slots[slot].entry);
+			}
+		}
+	}
+
+	// Add an abbreviation to the character pool
+	void AbbreviationTable::AddEntry(const KPTUniCharT *key, size_t keyLength, const KPTUniCharT *expansion, size_t expansionLength)
+	{
+		AbbreviationT entry;
+		entry.keyOffset = (uint32_t)_chars.size();
+		entry.keyLength = (uint16_t)keyLength;
+		_chars.insert(_chars.end(), key, key + keyLength);
+		_chars.push_back(L'\0');
+
+		entry.expansionOffset = (uint32_t)_chars.size();
+		entry.expansionLength = (uint16_t)expansionLength;
+		_chars.insert(_chars.end(), expansion, expansion + expansionLength);
+		_chars.push_back(L'\0');
+
+		_entries.push_back(entry);
+	}
+
+	// Hash every abbreviation into a power of two sized table that is at most half full
+	// Entries are inserted in file order, so the expansions of an abbreviation are probed in that order
+	void AbbreviationTable::BuildTable(void)
+	{
+		size_t slotCount = 2;
+		while (slotCount < 2 * _entries.size())
+		{
+			slotCount *= 2;
+		}
+
+		AbbreviationSlotT emptySlot = { 0, ABBREVIATION_NO_ENTRY };
+		_slots.assign(slotCount, emptySlot);
+		for (uint32_t i = 0; i < _entries.size(); i++)
+		{
+			uint64_t hash = Lexicon::HashWord(&_chars[_entries[i].keyOffset], _entries[i].keyLength);
+			size_t slot = (size_t)hash & (slotCount - 1);
+			while (_slots[slot].entry != ABBREVIATION_NO_ENTRY)
+			{
+				slot = (slot + 1) & (slotCount - 1);
+			}
+			_slots[slot].fingerprint = (uint32_t)(hash >> 32);
+			_slots[slot].entry = i;
+		}
+	}
+
+	// See whether an entry's abbreviation is a word, ignoring case
+	bool AbbreviationTable::IsMatch(uint32_t entry, const KPTUniCharT *word, size_t length) const
+	{
+		const AbbreviationT &abbreviation = _entries[entry];
+		if (abbreviation.keyLength != length)
+		{
+			return false;
+		}
+
+		const KPTUniCharT *key = &_chars[abbreviation.keyOffset];
+		for (size_t i = 0; i < length; i++)
+		{
+			if (Lexicon::Fold(key[i]) != Lexicon::Fold(word[i]))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
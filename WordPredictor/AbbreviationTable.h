@@ -0,0 +1,65 @@
+#pragma once
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+
+#include <vector>
+#include "kptapi.h"
+
+	#define ABBREVIATION_NO_ENTRY 0xFFFFFFFF
+
+	// An abbreviation and its expansion in the character pool
+	struct AbbreviationT
+	{
+		uint32_t keyOffset;			// Offset of the abbreviation in the character pool
+		uint32_t expansionOffset;	// Offset of the expansion in the character pool
+		uint16_t keyLength;			// Number of characters in the abbreviation, excluding NULL
+		uint16_t expansionLength;	// Number of characters in the expansion, excluding NULL
+	};
+
+	// A slot in the open-addressing hash table
+	struct AbbreviationSlotT
+	{
+		uint32_t fingerprint;		// High bits of the abbreviation's hash, so that most mismatches need no string comparison
+		uint32_t entry;				// Index of the abbreviation, or ABBREVIATION_NO_ENTRY for an empty slot
+	};
+
+	// User-editable table of abbreviations and their expansions e.g. "brb" -> "be right back"
+	// Abbreviations are hashed ignoring case into an open-addressing table at most half full, so looking up the current
+	// word costs one hash and usually one probe. An abbreviation may be listed more than once with different expansions.
+	// The table is read from a UTF-8 text file in the base path with one entry per line in the form abbreviation<tab>expansion.
+	class AbbreviationTable
+	{
+	private:
+		std::vector<KPTUniCharT> _chars;
+		std::vector<AbbreviationT> _entries;
+		std::vector<AbbreviationSlotT> _slots;
+
+	public:
+		AbbreviationTable(void);
+		~AbbreviationTable(void);
+
+		bool Load(const KPTSysCharT *pBasePath);
+		void Clear(void);
+		bool IsLoaded(void) const { return !_slots.empty(); }
+		size_t Count(void) const { return _entries.size(); }
+
+		void Find(const KPTUniCharT *word, size_t length, std::vector<uint32_t> &entries) const;
+		const KPTUniCharT *GetExpansion(uint32_t entry) const { return &_chars[_entries[entry].expansionOffset]; }
+		size_t GetExpansionLength(uint32_t entry) const { return _entries[entry].expansionLength; }
+
+	private:
+		void AddEntry(const KPTUniCharT *key, size_t keyLength, const KPTUniCharT *expansion, size_t expansionLength);
+		void BuildTable(void);
+		bool IsMatch(uint32_t entry, const KPTUniCharT *word, size_t length) const;
+	};
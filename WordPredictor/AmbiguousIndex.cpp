@@ -0,0 +1,226 @@
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+#include "stdafx.h"
+#include <algorithm>
+#include "AmbiguousIndex.h"
+
+	// Key sequences of the words being indexed
+	struct AmbiguousKeysT
+	{
+		const std::vector<uint32_t> *pWordIds;
+		const std::vector<uint8_t> *pKeys;
+		const std::vector<uint32_t> *pKeyOffsets;	// Offset of each word's keys, by word id
+	};
+
+	// Get the key at a depth of the key sequence of a sorted word, for building the trie
+	static uint32_t GetKeySymbol(uint32_t index, size_t depth, intptr_t context)
+	{
+		const AmbiguousKeysT *pKeys = (const AmbiguousKeysT *)context;
+		uint32_t wordId = (*pKeys->pWordIds)[index];
+		uint32_t offset = (*pKeys->pKeyOffsets)[wordId];
+
+		return depth < (*pKeys->pKeyOffsets)[wordId + 1] - offset ? (*pKeys->pKeys)[offset + depth] : SORTED_TRIE_END;
+	}
+
+	// Constructor
+	AmbiguousIndex::AmbiguousIndex(void)
+	{
+	}
+
+	// Destructor
+	AmbiguousIndex::~AmbiguousIndex(void)
+	{
+	}
+
+	// Check that there are no more key groups than the index allows and none are empty
+	bool AmbiguousIndex::IsValidKeyGroups(const std::vector<std::wstring> &keyGroups)
+	{
+		if (keyGroups.size() > MAX_KEY_GROUPS)
+		{
+			return false;
+		}
+
+		for (size_t key = 0; key < keyGroups.size(); key++)
+		{
+			if (keyGroups[key].empty())
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// Set the characters on each key e.g. "abc", "def", ... and clear the index, or return false if the groups aren't valid
+	// The first character of each group is the one inserted into the buffer when the key is pressed
+	bool AmbiguousIndex::SetKeyGroups(const std::vector<std::wstring> &keyGroups)
+	{
+		Clear();
+		_keyGroups.clear();
+		_charKeys.clear();
+		if (!IsValidKeyGroups(keyGroups))
+		{
+			return false;
+		}
+
+		for (size_t key = 0; key < keyGroups.size(); key++)
+		{
+			for (size_t i = 0; i < keyGroups[key].length(); i++)
+			{
+				_charKeys[Lexicon::Fold(keyGroups[key][i])] = (uint8_t)key;
+			}
+		}
+		_keyGroups = keyGroups;
+
+		return true;
+	}
+
+	// Index the words of a lexicon that can be typed with the key groups
+	void AmbiguousIndex::Build(const Lexicon &lexicon)
+	{
+		Clear();
+		if (_keyGroups.empty() || !lexicon.IsLoaded())
+		{
+			return;
+		}
+
+		// Work out the key sequence of each word, skipping words with characters that aren't on any key
+		std::vector<uint8_t> keys;
+		std::vector<uint32_t> keyOffsets(lexicon.WordCount() + 1, 0);
+		for (uint32_t wordId = 0; wordId < lexicon.WordCount(); wordId++)
+		{
+			const KPTUniCharT *text = lexicon.GetText(wordId);
+			size_t length = lexicon.GetWord(wordId).length;
+			size_t i;
+			for (i = 0; i < length; i++)
+			{
+				std::unordered_map<KPTUniCharT, uint8_t>::const_iterator it = _charKeys.find(Lexicon::Fold(text[i]));
+				if (it == _charKeys.end())
+				{
+					break;
+				}
+				keys.push_back(it->second);
+			}
+			if (i < length)
+			{
+				keys.resize(keyOffsets[wordId]);
+			}
+			else
+			{
+				_wordIds.push_back(wordId);
+			}
+			keyOffsets[wordId + 1] = (uint32_t)keys.size();
+		}
+
+		// Sort by key sequence, best word first within each sequence
+		std::sort(_wordIds.begin(), _wordIds.end(), [&](uint32_t a, uint32_t b)
+		{
+			uint32_t lengthA = keyOffsets[a + 1] - keyOffsets[a];
+			uint32_t lengthB = keyOffsets[b + 1] - keyOffsets[b];
+			uint32_t i = 0;
+			while (i < lengthA && i < lengthB && keys[keyOffsets[a] + i] == keys[keyOffsets[b] + i])
+			{
+				i++;
+			}
+			if (i < lengthA && i < lengthB)
+			{
+				return keys[keyOffsets[a] + i] < keys[keyOffsets[b] + i];
+			}
+			if (lengthA != lengthB)
+			{
+				return lengthA < lengthB;
+			}
+			return IsBetter(lexicon, a, b);
+		});
+
+		// Build the trie, where the words whose sequence ends at each node are listed first
+		AmbiguousKeysT context = { &_wordIds, &keys, &keyOffsets };
+		std::vector<SortedTrieNodeT> trie;
+		SortedTrie::Build((uint32_t)_wordIds.size(), GetKeySymbol, (intptr_t)&context, trie);
+		_nodes.resize(trie.size());
+		for (size_t i = 0; i < trie.size(); i++)
+		{
+			AmbiguousNodeT &node = _nodes[i];
+			node.key = (uint8_t)trie[i].symbol;
+			node.childCount = (uint8_t)trie[i].childCount;
+			node.firstChild = trie[i].firstChild;
+			node.firstWord = trie[i].first;
+			node.wordCount = trie[i].endCount;
+			std::fill(node.completions, node.completions + MAX_AMBIGUOUS_COMPLETIONS, AMBIGUOUS_NO_WORD);
+		}
+
+		// Record the best longer words below each node, working upwards from the leaves
+		for (size_t i = _nodes.size(); i-- > 0; )
+		{
+			AmbiguousNodeT &node = _nodes[i];
+			for (uint32_t child = node.firstChild; child < node.firstChild + node.childCount; child++)
+			{
+				const AmbiguousNodeT &childNode = _nodes[child];
+				for (uint32_t w = 0; w < childNode.wordCount && w < MAX_AMBIGUOUS_COMPLETIONS; w++)
+				{
+					AddCompletion(lexicon, node, _wordIds[childNode.firstWord + w]);
+				}
+				for (size_t j = 0; j < MAX_AMBIGUOUS_COMPLETIONS && childNode.completions[j] != AMBIGUOUS_NO_WORD; j++)
+				{
+					AddCompletion(lexicon, node, childNode.completions[j]);
+				}
+			}
+		}
+
+		TRACE(_T("Ambiguous index has %u words and %u nodes\n"), (unsigned)_wordIds.size(), (unsigned)_nodes.size());
+	}
+
+	// Release the trie, keeping the key groups
+	void AmbiguousIndex::Clear(void)
+	{
+		std::vector<AmbiguousNodeT>().swap(_nodes);
+		std::vector<uint32_t>().swap(_wordIds);
+	}
+
+	// Find the child of a node for the specified key
+	uint32_t AmbiguousIndex::FindChild(uint32_t nodeIndex, uint8_t key) const
+	{
+		return SortedTrie::FindChild(_nodes, nodeIndex, &AmbiguousNodeT::key, key);
+	}
+
+	// Decide whether one word should be suggested before another
+	bool AmbiguousIndex::IsBetter(const Lexicon &lexicon, uint32_t wordA, uint32_t wordB)
+	{
+		const LexiconWordT &a = lexicon.GetWord(wordA);
+		const LexiconWordT &b = lexicon.GetWord(wordB);
+		if (a.priority != b.priority)
+		{
+			return a.priority < b.priority;
+		}
+
+		return a.frequency > b.frequency;
+	}
+
+	// Insert a word into a node's list of best longer words if it is good enough
+	void AmbiguousIndex::AddCompletion(const Lexicon &lexicon, AmbiguousNodeT &node, uint32_t wordId)
+	{
+		size_t j = MAX_AMBIGUOUS_COMPLETIONS;
+		while (j > 0 && (node.completions[j - 1] == AMBIGUOUS_NO_WORD || IsBetter(lexicon, wordId, node.completions[j - 1])))
+		{
+			if (j < MAX_AMBIGUOUS_COMPLETIONS)
+			{
+				node.completions[j] = node.completions[j - 1];
+			}
+			j--;
+		}
+		if (j < MAX_AMBIGUOUS_COMPLETIONS)
+		{
+			node.completions[j] = wordId;
+		}
+	}
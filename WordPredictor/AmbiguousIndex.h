@@ -0,0 +1,69 @@
+#pragma once
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "Lexicon.h"
+#include "SortedTrie.h"
+
+	#define AMBIGUOUS_NO_NODE SORTED_TRIE_NO_NODE
+	#define AMBIGUOUS_NO_WORD 0xFFFFFFFF
+	#define AMBIGUOUS_ROOT SORTED_TRIE_ROOT
+
+	// A node in the key sequence trie
+	// The children of a node are contiguous and sorted by key
+	struct AmbiguousNodeT
+	{
+		uint8_t key;			// Key group on the edge into this node
+		uint8_t childCount;		// Number of children
+		uint32_t firstChild;	// Index of the first child
+		uint32_t firstWord;		// First of the words whose key sequence ends at this node, best first
+		uint32_t wordCount;		// Number of words whose key sequence ends at this node
+		uint32_t completions[MAX_AMBIGUOUS_COMPLETIONS];	// Best words with longer key sequences, padded with AMBIGUOUS_NO_WORD
+	};
+
+	// Index of the lexicon's words by the sequence of grouped-letter keys that types them, e.g. with groups "abc", "def",
+	// "ghi" ... "good", "home" and "gone" share one sequence. Keys are added one at a time, so each key press is a single
+	// step down the trie, after which the node lists the matching words and the best longer words without a search.
+	class AmbiguousIndex
+	{
+	private:
+		std::vector<std::wstring> _keyGroups;
+		std::unordered_map<KPTUniCharT, uint8_t> _charKeys;	// Key group of each case-folded character
+		std::vector<AmbiguousNodeT> _nodes;
+		std::vector<uint32_t> _wordIds;		// Lexicon word ids sorted by key sequence, best first within each sequence
+
+	public:
+		AmbiguousIndex(void);
+		~AmbiguousIndex(void);
+
+		static bool IsValidKeyGroups(const std::vector<std::wstring> &keyGroups);
+		bool SetKeyGroups(const std::vector<std::wstring> &keyGroups);
+		void Build(const Lexicon &lexicon);
+		void Clear(void);
+		bool IsLoaded(void) const { return !_nodes.empty(); }
+		size_t KeyGroupCount(void) const { return _keyGroups.size(); }
+		const std::vector<std::wstring> &GetKeyGroups(void) const { return _keyGroups; }
+		KPTUniCharT GetKeyChar(size_t key) const { return key < _keyGroups.size() ? _keyGroups[key][0] : L'\0'; }
+
+		const AmbiguousNodeT &GetNode(uint32_t nodeIndex) const { return _nodes[nodeIndex]; }
+		uint32_t GetWordId(uint32_t index) const { return _wordIds[index]; }
+		uint32_t FindChild(uint32_t nodeIndex, uint8_t key) const;
+
+	private:
+		static bool IsBetter(const Lexicon &lexicon, uint32_t wordA, uint32_t wordB);
+		static void AddCompletion(const Lexicon &lexicon, AmbiguousNodeT &node, uint32_t wordId);
+	};
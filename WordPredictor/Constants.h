@@ -25,6 +25,19 @@
 	#define REQUEST_INSTALL_PACKAGES 18
 	#define REQUEST_UNINSTALL_PACKAGES 19
 	#define REQUEST_SET_ACTIVE_DICTIONARIES 20
+	#define REQUEST_CONFIGURE_CORRECTION 21
+	#define REQUEST_GET_NEXT_LETTERS 22
+	#define REQUEST_CONFIGURE_PHRASES 23
+	#define REQUEST_SET_KEY_GROUPS 24
+	#define REQUEST_INSERT_AMBIGUOUS 25
+	#define REQUEST_SET_PERSONAL_CAPACITY 26
+	#define REQUEST_GET_PERSONAL_STATUS 27
+	#define REQUEST_LEARN_FILES 28
+	#define REQUEST_GET_PERSONAL_PAGE 29
+	#define REQUEST_EXPORT_PERSONAL 30
+	#define REQUEST_IMPORT_PERSONAL 31
+	#define REQUEST_SET_PARTITION 32
+	#define REQUEST_GET_LEARN_PROGRESS 33
 
 	#define RESPONSE_ERROR_UNRECOGNISED_MSG_TYPE 200
 	#define RESPONSE_ERROR_BUFFER_OVERFLOW 201
@@ -39,7 +52,124 @@
 	#define RESPONSE_ERROR_INSTALL_PACKAGES 218
 	#define RESPONSE_ERROR_UNINSTALL_PACKAGES 219
 	#define RESPONSE_ERROR_SET_ACTIVE_DICTIONARIES 220
+	#define RESPONSE_ERROR_CONFIGURE_CORRECTION 221
+	#define RESPONSE_ERROR_GET_NEXT_LETTERS 222
+	#define RESPONSE_ERROR_CONFIGURE_PHRASES 223
+	#define RESPONSE_ERROR_SET_KEY_GROUPS 224
+	#define RESPONSE_ERROR_INSERT_AMBIGUOUS 225
+	#define RESPONSE_ERROR_SET_PERSONAL_CAPACITY 226
+	#define RESPONSE_ERROR_GET_PERSONAL_STATUS 227
+	#define RESPONSE_ERROR_LEARN_FILES 228
+	#define RESPONSE_ERROR_GET_PERSONAL_PAGE 229
+	#define RESPONSE_ERROR_EXPORT_PERSONAL 230
+	#define RESPONSE_ERROR_IMPORT_PERSONAL 231
+	#define RESPONSE_ERROR_SET_PARTITION 232
+	#define RESPONSE_ERROR_GET_LEARN_PROGRESS 233
 
 	#define MAX_STR_LEN 1024	
 	#define MAX_DICTIONARIES 100
 	#define DEFAULT_RELATIVE_BASE_PATH L"..\\data\\base"
+
+	// Native word lists, one per dictionary e.g. Lexicon\enggb.txt
+	#define LEXICON_FOLDER L"Lexicon"
+	#define LEXICON_FILE_EXT L".txt"
+	#define MAX_WORD_LEN 64
+
+	// The LexiconExporter tool exports missing word lists from the OpenAdaptxt dictionaries by asking for prefix completions
+	#define LEXICON_EXPORT_SUGGESTIONS 64
+	#define LEXICON_EXPORT_MAX_QUERIES 20000
+	#define LEXICON_EXPORT_TOP_COUNT 1000000
+
+	// Images that are replaced while still mapped are renamed e.g. to Lexicon\enggb.sym.0.old until they are unmapped
+	#define MAX_REPLACED_FILES 16
+
+	// Error correction
+	#define FUZZY_MAX_EDIT_DISTANCE 2
+	#define MAX_NATIVE_CORRECTIONS 3
+	#define MAX_RESCORED_CORRECTIONS 16
+
+	// Splitting run-together words e.g. "inthe" into "in the"
+	#define MIN_SEGMENT_LEN 4
+	#define MAX_SEGMENT_LEN 64
+	#define SEGMENT_CONTEXT_WEIGHT 0.5f
+
+	// Optional deletion index of each dictionary's words, e.g. Lexicon\enggb.sym
+	#define DELETION_INDEX_FILE_EXT L".sym"
+	#define DEFAULT_DELETION_INDEX_PREFIX_LEN 7
+
+	// Next-word context models built from n-gram counts, e.g. Lexicon\enggb_ngrams.txt is compiled to Lexicon\enggb.ngm
+	// A dictionary without n-gram counts has no context model, and its next-word predictions come from OpenAdaptxt
+	#define CONTEXT_NGRAM_FILE_SUFFIX L"_ngrams.txt"
+	#define CONTEXT_MODEL_FILE_EXT L".ngm"
+	#define CONTEXT_MAX_WORDS 2
+	#define CONTEXT_SCAN_LIMIT 256
+	#define INPUT_RETENTION_WINDOW 4096
+	#define MIN_INPUT_GAP_SIZE 256
+	#define MAX_NATIVE_PREDICTIONS 3
+	#define MIN_NATIVE_PREDICTION_PROB 0.01f
+	#define NEXT_WORD_CACHE_SIZE 1024
+
+	// Multi-word phrase completions, e.g. Lexicon\enggb_phrases.txt
+	#define PHRASE_FILE_SUFFIX L"_phrases.txt"
+	#define MAX_PHRASE_COMPLETIONS 3
+	#define MAX_PHRASE_LEN 128
+
+	// User-editable abbreviations in the base path, one per line in the form abbreviation<tab>expansion
+	#define ABBREVIATION_FILE L"Abbreviations.txt"
+
+	// Ambiguous input from grouped-letter keys e.g. "abc", "def", ...
+	#define MAX_KEY_GROUPS 32
+	#define MAX_AMBIGUOUS_MATCHES 5
+	#define MAX_AMBIGUOUS_COMPLETIONS 3
+
+	// Cache of the words typed in the session, with the weight of each word decaying by a factor per word typed
+	#define SESSION_CACHE_SIZE 4096
+	#define SESSION_CACHE_DECAY 0.999f
+	#define MAX_SESSION_COMPLETIONS 2
+	#define MIN_SESSION_WEIGHT 0.1f
+
+	// Words learned from the user's typing, with counts decaying by a factor per epoch of learned words
+	#define PD_EPOCH_WORDS 1000
+	#define PD_EPOCH_DECAY 0.98f
+	#define PD_REBASE_EPOCH 0xC000
+	#define PD_REBASE_BATCH 64
+	#define PD_MIN_SLOTS 256
+	#define PD_PAGE_WORDS 64
+	#define PD_DEFAULT_CAPACITY 20000
+	#define PD_SKETCH_RESET_FACTOR 10
+	#define PD_ADMISSION_SIGHTINGS 3
+	#define PD_CANDIDATE_SKETCH_WIDTH 4096
+	#define PD_CANDIDATE_RESET_INTERVAL 40960
+	#define MAX_LEARNED_COMPLETIONS 2
+	#define MIN_LEARNED_COUNT 2.0f
+
+	// Personal dictionary image and write-ahead log of learned words in the base path
+	#define PD_IMAGE_FILE L"Learned.dat"
+	#define PD_LOG_FILE L"Learned.log"
+	#define PD_OLD_LOG_FILE L"Learned.old"
+	#define PD_LOG_BATCH 32
+	#define PD_LOG_COMPACT_SIZE 0x100000
+	#define PD_IMAGE_BLOCK_WORDS 16
+
+	// Learning the words in text files, using a thread per file up to the number of cores
+	#define MAX_LEARN_THREADS 16
+	#define LEARN_PROGRESS_INTERVAL_MS 100
+	#define LEARN_PROGRESS_BYTES 0x10000
+	#define LEARN_BUFFER_CHARS 0x10000
+	#define LEARN_MAX_REPEATS 16
+	#define LEARN_BUFFERS_PER_REQUEST 4
+
+	// States of learning from text files, as reported to the client
+	#define LEARN_STATE_IDLE 0
+	#define LEARN_STATE_COUNTING 1
+	#define LEARN_STATE_LEARNING 2
+	#define LEARN_STATE_DONE 3
+
+	// Importing and exporting personal dictionary word lists a batch of words at a time
+	#define PD_IO_BATCH 256
+	#define PD_IO_BUFFER_BYTES 0x10000
+
+	// Per-application learning partitions, each with its own image and log in a subfolder e.g. Learned\PowerPoint
+	#define PD_PARTITION_FOLDER L"Learned"
+	#define MAX_PARTITION_NAME 32
+	#define PD_PARTITION_CAPACITY 5000
@@ -0,0 +1,659 @@
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+#include "stdafx.h"
+#include <math.h>
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include "Lexicon.h"
+#include "ContextModel.h"
+
+	// An n-gram read from the counts file
+	struct ContextNGramT
+	{
+		uint32_t words[3];
+		uint32_t count;
+	};
+
+	// A successor with its probability while the image is being built
+	struct ContextSuccessorT
+	{
+		uint32_t wordId;
+		float prob;
+	};
+
+	// Round a section offset up to a multiple of four bytes
+	static size_t AlignOffset(size_t offset)
+	{
+		return (offset + 3) & ~(size_t)3;
+	}
+
+	// Quantize a probability as a negative log10 in steps
+	static uint32_t QuantizeProb(float prob, float step)
+	{
+		float level = prob > 0.0f ? -log10f(prob) / step : 255.0f;
+
+		return (uint32_t)(std::min)(255.0f, (std::max)(0.0f, level + 0.5f));
+	}
+
+	// Absolute discount from the count-of-counts (Ney's estimate), falling back to 0.75
+	static float EstimateDiscount(size_t countOnes, size_t countTwos)
+	{
+		if (countOnes == 0 || countTwos == 0)
+		{
+			return 0.75f;
+		}
+
+		return (std::min)(0.9f, (std::max)(0.1f, (float)countOnes / (float)(countOnes + 2 * countTwos)));
+	}
+
+	// Constructor
+	ContextModel::ContextModel(void)
+	{
+		_pHeader = NULL;
+		_pFingerprints = NULL;
+		_pWordOffsets = NULL;
+		_pChars = NULL;
+		_pUnigramBackoffs = NULL;
+		_pBigramStarts = NULL;
+		_pBigrams = NULL;
+		_pTrigramSlots = NULL;
+		_pTrigrams = NULL;
+	}
+
+	// Destructor
+	ContextModel::~ContextModel(void)
+	{
+	}
+
+	// Map the model for a dictionary, building it first if it is missing or out of date
+	bool ContextModel::Load(const KPTSysCharT *pBasePath, const KPTUniCharT *dictName)
+	{
+		Close();
+
+		KPTSysCharT sourcePath[MAX_PATH];
+		KPTSysCharT imagePath[MAX_PATH];
+		uint64_t sourceSize;
+		uint64_t sourceTime;
+		swprintf_s(sourcePath, MAX_PATH, _T("%s\\%s\\%s%s"), pBasePath, LEXICON_FOLDER, dictName, CONTEXT_NGRAM_FILE_SUFFIX);
+		swprintf_s(imagePath, MAX_PATH, _T("%s\\%s\\%s%s"), pBasePath, LEXICON_FOLDER, dictName, CONTEXT_MODEL_FILE_EXT);
+		if (!MappedFile::GetFileStamp(sourcePath, sourceSize, sourceTime))
+		{
+			TRACE(_T("No n-gram counts for %s, so it has no context model\n"), dictName);
+			return false;
+		}
+
+		if (Map(imagePath, sourceSize, sourceTime))
+		{
+			return true;
+		}
+
+		TRACE(_T("Building context model %s\n"), imagePath);
+		if (!Build(sourcePath, imagePath, sourceSize, sourceTime))
+		{
+			return false;
+		}
+
+		return Map(imagePath, sourceSize, sourceTime);
+	}
+
+	// Unmap the model
+	void ContextModel::Close(void)
+	{
+		_file.Close();
+		_wordHash.Detach();
+		_pHeader = NULL;
+		_pFingerprints = NULL;
+		_pWordOffsets = NULL;
+		_pChars = NULL;
+		_pUnigramBackoffs = NULL;
+		_pBigramStarts = NULL;
+		_pBigrams = NULL;
+		_pTrigramSlots = NULL;
+		_pTrigrams = NULL;
+	}
+
+	// Map an image and check that it matches the n-gram file it was built from
+	bool ContextModel::Map(const KPTSysCharT *pImagePath, uint64_t sourceSize, uint64_t sourceTime)
+	{
+		if (!_file.Open(pImagePath) || _file.Size() < sizeof(ContextModelHeaderT))
+		{
+			_file.Close();
+			return false;
+		}
+
+		const ContextModelHeaderT *pHeader = (const ContextModelHeaderT *)_file.Data();
+		size_t hashPos = sizeof(ContextModelHeaderT);
+		size_t fingerprintsPos = hashPos + (size_t)pHeader->hashWordCount * sizeof(uint64_t);
+		size_t wordOffsetsPos = fingerprintsPos + (size_t)pHeader->wordCount * sizeof(uint32_t);
+		size_t charsPos = wordOffsetsPos + ((size_t)pHeader->wordCount + 1) * sizeof(uint32_t);
+		size_t backoffsPos = charsPos + (size_t)pHeader->charCount * sizeof(KPTUniCharT);
+		size_t bigramStartsPos = AlignOffset(backoffsPos + pHeader->wordCount);
+		size_t bigramsPos = bigramStartsPos + ((size_t)pHeader->wordCount + 1) * sizeof(uint32_t);
+		size_t slotsPos = bigramsPos + (size_t)pHeader->bigramCount * sizeof(uint32_t);
+		size_t trigramsPos = slotsPos + (size_t)pHeader->trigramSlotCount * sizeof(ContextSlotT);
+		size_t expectedSize = trigramsPos + (size_t)pHeader->trigramCount * sizeof(uint32_t);
+		if (pHeader->magic != CONTEXT_MODEL_MAGIC ||
+			pHeader->version != CONTEXT_MODEL_VERSION ||
+			pHeader->sourceSize != sourceSize ||
+			pHeader->sourceTime != sourceTime ||
+			pHeader->wordCount == 0 ||
+			pHeader->trigramSlotCount == 0 ||
+			(pHeader->trigramSlotCount & (pHeader->trigramSlotCount - 1)) != 0 ||
+			expectedSize != _file.Size() ||
+			!_wordHash.Attach((const uint64_t *)(_file.Data() + hashPos), pHeader->hashWordCount))
+		{
+			_file.Close();
+			return false;
+		}
+
+		const uint8_t *pData = _file.Data();
+		_pHeader = pHeader;
+		_pFingerprints = (const uint32_t *)(pData + fingerprintsPos);
+		_pWordOffsets = (const uint32_t *)(pData + wordOffsetsPos);
+		_pChars = (const KPTUniCharT *)(pData + charsPos);
+		_pUnigramBackoffs = pData + backoffsPos;
+		_pBigramStarts = (const uint32_t *)(pData + bigramStartsPos);
+		_pBigrams = (const uint32_t *)(pData + bigramsPos);
+		_pTrigramSlots = (const ContextSlotT *)(pData + slotsPos);
+		_pTrigrams = (const uint32_t *)(pData + trigramsPos);
+		TRACE(_T("Mapped context model %s (%u words, %u bytes)\n"), pImagePath, _pHeader->wordCount, (unsigned)_file.Size());
+
+		return true;
+	}
+
+	// Find the id of a word in the model's vocabulary (ignoring case)
+	uint32_t ContextModel::FindWord(const KPTUniCharT *word, size_t length) const
+	{
+		if (_pHeader == NULL || length == 0 || length > MAX_WORD_LEN)
+		{
+			return CONTEXT_NO_WORD;
+		}
+
+		// The perfect hash gives most words some id, so check the fingerprint to reject words that aren't in the vocabulary
+		uint64_t hash = Lexicon::HashWord(word, length);
+		uint32_t wordId = _wordHash.Lookup(hash);
+		if (wordId == PERFECT_HASH_NOT_FOUND || _pFingerprints[wordId] != PerfectHash::Fingerprint(hash))
+		{
+			return CONTEXT_NO_WORD;
+		}
+
+		return wordId;
+	}
+
+	// Get one of the most likely words overall, most likely first, or CONTEXT_NO_WORD if there are fewer
+	uint32_t ContextModel::GetTopWord(size_t index) const
+	{
+		if (_pHeader == NULL || index >= CONTEXT_TOP_UNIGRAMS || _pHeader->topUnigrams[index] == CONTEXT_NO_WORD)
+		{
+			return CONTEXT_NO_WORD;
+		}
+
+		return _pHeader->topUnigrams[index] >> 8;
+	}
+
+	// See whether there are trigram counts for a two-word context, otherwise only the previous word affects predictions
+	bool ContextModel::HasContext(uint32_t word1, uint32_t word2) const
+	{
+		return _pHeader != NULL && word1 != CONTEXT_NO_WORD && word2 != CONTEXT_NO_WORD && FindContext(word1, word2) != NULL;
+	}
+
+	// Predict the most likely words to follow the context word1 word2, where word1 and/or word2 may be CONTEXT_NO_WORD
+	// Words that follow the two-word context are listed with their interpolated probabilities, then words that follow word2
+	// are added with the context's backoff weight, then the most likely words overall
+	void ContextModel::Predict(uint32_t word1, uint32_t word2, size_t maxCount, std::vector<ContextPredictionT> &predictions) const
+	{
+		predictions.clear();
+		if (_pHeader == NULL)
+		{
+			return;
+		}
+
+		float backoff = 1.0f;
+		size_t i, j;
+		const ContextSlotT *pSlot = NULL;
+		if (word1 != CONTEXT_NO_WORD && word2 != CONTEXT_NO_WORD)
+		{
+			pSlot = FindContext(word1, word2);
+		}
+		if (pSlot != NULL)
+		{
+			for (i = 0; i < pSlot->count && i < maxCount; i++)
+			{
+				uint32_t successor = _pTrigrams[pSlot->start + i];
+				AddPrediction(successor >> 8, Dequantize(successor & 0xFF), predictions);
+			}
+			backoff = Dequantize(pSlot->backoff);
+		}
+
+		if (word2 != CONTEXT_NO_WORD)
+		{
+			size_t added = 0;
+			for (i = _pBigramStarts[word2]; i < _pBigramStarts[word2 + 1] && added < maxCount; i++)
+			{
+				// Words listed for the two-word context already have their interpolated probability
+				uint32_t wordId = _pBigrams[i] >> 8;
+				bool isListed = false;
+				for (j = 0; pSlot != NULL && j < pSlot->count && !isListed; j++)
+				{
+					isListed = (_pTrigrams[pSlot->start + j] >> 8) == wordId;
+				}
+				if (!isListed)
+				{
+					AddPrediction(wordId, backoff * Dequantize(_pBigrams[i] & 0xFF), predictions);
+					added++;
+				}
+			}
+			backoff *= Dequantize(_pUnigramBackoffs[word2]);
+		}
+
+		for (i = 0; i < CONTEXT_TOP_UNIGRAMS && predictions.size() < maxCount; i++)
+		{
+			uint32_t successor = _pHeader->topUnigrams[i];
+			if (successor != CONTEXT_NO_WORD)
+			{
+				AddPrediction(successor >> 8, backoff * Dequantize(successor & 0xFF), predictions);
+			}
+		}
+
+		std::sort(predictions.begin(), predictions.end(), [](const ContextPredictionT &a, const ContextPredictionT &b)
+		{
+			return a.prob > b.prob;
+		});
+		if (predictions.size() > maxCount)
+		{
+			predictions.resize(maxCount);
+		}
+	}
+
+	// Add a prediction, keeping the higher probability if the word is already listed
+	void ContextModel::AddPrediction(uint32_t wordId, float prob, std::vector<ContextPredictionT> &predictions)
+	{
+		for (size_t i = 0; i < predictions.size(); i++)
+		{
+			if (predictions[i].wordId == wordId)
+			{
+				predictions[i].prob = (std::max)(predictions[i].prob, prob);
+				return;
+			}
+		}
+
+		ContextPredictionT prediction = { wordId, prob };
+		predictions.push_back(prediction);
+	}
+
+	// Find a two-word context in the trigram hash table
+	const ContextSlotT *ContextModel::FindContext(uint32_t word1, uint32_t word2) const
+	{
+		uint32_t mask = _pHeader->trigramSlotCount - 1;
+		uint32_t slot = HashContext(word1, word2) & mask;
+		while (_pTrigramSlots[slot].word1 != CONTEXT_NO_WORD)
+		{
+			if (_pTrigramSlots[slot].word1 == word1 && _pTrigramSlots[slot].word2 == word2)
+			{
+				return &_pTrigramSlots[slot];
+			}
+			slot = (slot + 1) & mask;
+		}
+
+		return NULL;
+	}
+
+	// Convert a quantized log probability back to a probability
+	float ContextModel::Dequantize(uint32_t quantized) const
+	{
+		return powf(10.0f, -(float)quantized * _pHeader->quantStep);
+	}
+
+	// Mix the ids of a two-word context
+	uint32_t ContextModel::HashContext(uint32_t word1, uint32_t word2)
+	{
+		uint32_t hash = word1 * 0x9E3779B1u;
+		hash ^= word2 + 0x7F4A7C15u + (hash << 6) + (hash >> 2);
+
+		return hash * 0x85EBCA6Bu;
+	}
+
+	// Build the model image from an n-gram counts file
+	bool ContextModel::Build(const KPTSysCharT *pSourcePath, const KPTSysCharT *pImagePath, uint64_t sourceSize, uint64_t sourceTime)
+	{
+		FILE *pFile = NULL;
+		if (0 != _wfopen_s(&pFile, pSourcePath, _T("rt, ccs=UTF-8")) || pFile == NULL)
+		{
+			return false;
+		}
+
+		// Read the n-grams, giving each distinct word a provisional id
+		std::unordered_map<std::wstring, uint32_t> vocabulary;
+		std::vector<std::wstring> words;
+		std::vector<ContextNGramT> bigrams;
+		std::vector<ContextNGramT> trigrams;
+		KPTUniCharT line[MAX_STR_LEN];
+		while (fgetws(line, MAX_STR_LEN, pFile) != NULL)
+		{
+			size_t length = wcscspn(line, _T("\t\r\n"));
+			if (line[length] != L'\t')
+			{
+				continue;
+			}
+			ContextNGramT ngram = { { 0, 0, 0 }, (uint32_t)wcstoul(&line[length + 1], NULL, 10) };
+			line[length] = L'\0';
+
+			size_t n = 0;
+			KPTUniCharT *nextToken;
+			KPTUniCharT *token = wcstok_s(line, _T(" "), &nextToken);
+			while (token != NULL && n < 4)
+			{
+				std::wstring word(token, (std::min)(wcslen(token), (size_t)MAX_WORD_LEN));
+				std::transform(word.begin(), word.end(), word.begin(), Lexicon::Fold);
+				std::unordered_map<std::wstring, uint32_t>::iterator it = vocabulary.find(word);
+				if (it == vocabulary.end())
+				{
+					it = vocabulary.insert(std::make_pair(word, (uint32_t)words.size())).first;
+					words.push_back(word);
+				}
+				if (n < 3)
+				{
+					ngram.words[n] = it->second;
+				}
+				n++;
+				token = wcstok_s(NULL, _T(" "), &nextToken);
+			}
+
+			if (ngram.count != 0 && n == 2)
+			{
+				bigrams.push_back(ngram);
+			}
+			else if (ngram.count != 0 && n == 3)
+			{
+				trigrams.push_back(ngram);
+			}
+		}
+		fclose(pFile);
+
+		uint32_t wordCount = (uint32_t)words.size();
+		if (wordCount == 0 || wordCount >= (1u << CONTEXT_WORD_BITS))
+		{
+			return false;
+		}
+
+		// Renumber the words by their perfect hash index
+		std::vector<uint64_t> hashes(wordCount);
+		std::vector<uint64_t> hashImage;
+		uint32_t w;
+		for (w = 0; w < wordCount; w++)
+		{
+			hashes[w] = Lexicon::HashWord(words[w].c_str(), words[w].length());
+		}
+		PerfectHash wordHash;
+		if (!PerfectHash::Build(hashes, hashImage) || !wordHash.Attach(hashImage.data(), hashImage.size()))
+		{
+			return false;
+		}
+		std::vector<uint32_t> order(wordCount);
+		std::vector<uint32_t> newIds(wordCount);
+		std::vector<uint32_t> fingerprints(wordCount);
+		for (w = 0; w < wordCount; w++)
+		{
+			newIds[w] = wordHash.Lookup(hashes[w]);
+			order[newIds[w]] = w;
+			fingerprints[newIds[w]] = PerfectHash::Fingerprint(hashes[w]);
+		}
+		size_t i, j;
+		for (i = 0; i < bigrams.size(); i++)
+		{
+			bigrams[i].words[0] = newIds[bigrams[i].words[0]];
+			bigrams[i].words[1] = newIds[bigrams[i].words[1]];
+		}
+		for (i = 0; i < trigrams.size(); i++)
+		{
+			for (j = 0; j < 3; j++)
+			{
+				trigrams[i].words[j] = newIds[trigrams[i].words[j]];
+			}
+		}
+
+		// Merge duplicate n-grams
+		std::vector<ContextNGramT> *lists[2] = { &bigrams, &trigrams };
+		size_t countOnes[2] = { 0, 0 };
+		size_t countTwos[2] = { 0, 0 };
+		for (int order2 = 0; order2 < 2; order2++)
+		{
+			std::vector<ContextNGramT> &list = *lists[order2];
+			std::sort(list.begin(), list.end(), [](const ContextNGramT &a, const ContextNGramT &b)
+			{
+				return std::lexicographical_compare(a.words, a.words + 3, b.words, b.words + 3);
+			});
+			size_t merged = 0;
+			for (i = 0; i < list.size(); i++)
+			{
+				if (merged > 0 && std::equal(list[i].words, list[i].words + 3, list[merged - 1].words))
+				{
+					list[merged - 1].count += list[i].count;
+				}
+				else
+				{
+					list[merged++] = list[i];
+				}
+			}
+			list.resize(merged);
+			for (i = 0; i < list.size(); i++)
+			{
+				countOnes[order2] += list[i].count == 1 ? 1 : 0;
+				countTwos[order2] += list[i].count == 2 ? 1 : 0;
+			}
+		}
+		float bigramDiscount = EstimateDiscount(countOnes[0], countTwos[0]);
+		float trigramDiscount = EstimateDiscount(countOnes[1], countTwos[1]);
+
+		// Unigram distribution from continuation counts: the number of different words that each word follows
+		std::vector<float> unigramProbs(wordCount, 1.0f);
+		for (i = 0; i < bigrams.size(); i++)
+		{
+			unigramProbs[bigrams[i].words[1]] += 1.0f;
+		}
+		float continuationTotal = (float)(bigrams.size() + wordCount);
+		for (w = 0; w < wordCount; w++)
+		{
+			unigramProbs[w] /= continuationTotal;
+		}
+
+		// Bigram distributions, interpolated with the unigram distribution
+		float quantStep = CONTEXT_LOGPROB_RANGE / 255.0f;
+		std::vector<float> unigramBackoffs(wordCount, 1.0f);
+		std::vector<uint32_t> bigramStarts(wordCount + 1, 0);
+		std::vector<uint32_t> packedBigrams;
+		std::unordered_map<uint64_t, float> bigramProbs;
+		std::vector<ContextSuccessorT> successors;
+		for (i = 0; i < bigrams.size(); )
+		{
+			uint32_t word1 = bigrams[i].words[0];
+			size_t end = i;
+			float total = 0.0f;
+			while (end < bigrams.size() && bigrams[end].words[0] == word1)
+			{
+				total += (float)bigrams[end].count;
+				end++;
+			}
+
+			float backoff = bigramDiscount * (float)(end - i) / total;
+			unigramBackoffs[word1] = backoff;
+			successors.clear();
+			for (j = i; j < end; j++)
+			{
+				uint32_t word2 = bigrams[j].words[1];
+				float prob = (std::max)((float)bigrams[j].count - bigramDiscount, 0.0f) / total + backoff * unigramProbs[word2];
+				ContextSuccessorT successor = { word2, prob };
+				successors.push_back(successor);
+				bigramProbs[((uint64_t)word1 << 32) | word2] = prob;
+			}
+			std::sort(successors.begin(), successors.end(), [](const ContextSuccessorT &a, const ContextSuccessorT &b) { return a.prob > b.prob; });
+
+			bigramStarts[word1] = (uint32_t)packedBigrams.size();
+			for (j = 0; j < successors.size(); j++)
+			{
+				packedBigrams.push_back((successors[j].wordId << 8) | QuantizeProb(successors[j].prob, quantStep));
+			}
+			i = end;
+		}
+
+		// Fill in the starts of words that have no successors, working backwards
+		bigramStarts[wordCount] = (uint32_t)packedBigrams.size();
+		std::vector<bool> hasBigrams(wordCount, false);
+		for (i = 0; i < bigrams.size(); i++)
+		{
+			hasBigrams[bigrams[i].words[0]] = true;
+		}
+		for (w = wordCount; w-- > 0; )
+		{
+			if (!hasBigrams[w])
+			{
+				bigramStarts[w] = bigramStarts[w + 1];
+			}
+		}
+
+		// Trigram distributions, interpolated with the bigram distributions, in a hash table of two-word contexts
+		size_t contextCount = 0;
+		for (i = 0; i < trigrams.size(); i++)
+		{
+			if (i == 0 || trigrams[i].words[0] != trigrams[i - 1].words[0] || trigrams[i].words[1] != trigrams[i - 1].words[1])
+			{
+				contextCount++;
+			}
+		}
+		uint32_t slotCount = 16;
+		while (slotCount < 2 * contextCount)
+		{
+			slotCount <<= 1;
+		}
+		ContextSlotT emptySlot = { CONTEXT_NO_WORD, CONTEXT_NO_WORD, 0, 0, 0 };
+		std::vector<ContextSlotT> slots(slotCount, emptySlot);
+		std::vector<uint32_t> packedTrigrams;
+		for (i = 0; i < trigrams.size(); )
+		{
+			uint32_t word1 = trigrams[i].words[0];
+			uint32_t word2 = trigrams[i].words[1];
+			size_t end = i;
+			float total = 0.0f;
+			while (end < trigrams.size() && trigrams[end].words[0] == word1 && trigrams[end].words[1] == word2)
+			{
+				total += (float)trigrams[end].count;
+				end++;
+			}
+
+			float backoff = trigramDiscount * (float)(end - i) / total;
+			successors.clear();
+			for (j = i; j < end; j++)
+			{
+				uint32_t word3 = trigrams[j].words[2];
+				std::unordered_map<uint64_t, float>::const_iterator it = bigramProbs.find(((uint64_t)word2 << 32) | word3);
+				float lowerProb = it != bigramProbs.end() ? it->second : unigramBackoffs[word2] * unigramProbs[word3];
+				float prob = (std::max)((float)trigrams[j].count - trigramDiscount, 0.0f) / total + backoff * lowerProb;
+				ContextSuccessorT successor = { word3, prob };
+				successors.push_back(successor);
+			}
+			std::sort(successors.begin(), successors.end(), [](const ContextSuccessorT &a, const ContextSuccessorT &b) { return a.prob > b.prob; });
+
+			uint32_t slot = HashContext(word1, word2) & (slotCount - 1);
+			while (slots[slot].word1 != CONTEXT_NO_WORD)
+			{
+				slot = (slot + 1) & (slotCount - 1);
+			}
+			slots[slot].word1 = word1;
+			slots[slot].word2 = word2;
+			slots[slot].start = (uint32_t)packedTrigrams.size();
+			slots[slot].count = (uint32_t)successors.size();
+			slots[slot].backoff = QuantizeProb(backoff, quantStep);
+			for (j = 0; j < successors.size(); j++)
+			{
+				packedTrigrams.push_back((successors[j].wordId << 8) | QuantizeProb(successors[j].prob, quantStep));
+			}
+			i = end;
+		}
+
+		// Vocabulary in id order
+		std::vector<uint32_t> wordOffsets;
+		std::vector<KPTUniCharT> chars;
+		for (w = 0; w < wordCount; w++)
+		{
+			const std::wstring &word = words[order[w]];
+			wordOffsets.push_back((uint32_t)chars.size());
+			chars.insert(chars.end(), word.begin(), word.end());
+			chars.push_back(L'\0');
+		}
+		wordOffsets.push_back((uint32_t)chars.size());
+
+		std::vector<uint8_t> quantizedBackoffs(wordCount);
+		for (w = 0; w < wordCount; w++)
+		{
+			quantizedBackoffs[w] = (uint8_t)QuantizeProb(unigramBackoffs[w], quantStep);
+		}
+
+		ContextModelHeaderT header = { 0 };
+		header.magic = CONTEXT_MODEL_MAGIC;
+		header.version = CONTEXT_MODEL_VERSION;
+		header.sourceSize = sourceSize;
+		header.sourceTime = sourceTime;
+		header.wordCount = wordCount;
+		header.charCount = (uint32_t)chars.size();
+		header.bigramCount = (uint32_t)packedBigrams.size();
+		header.trigramSlotCount = slotCount;
+		header.trigramCount = (uint32_t)packedTrigrams.size();
+		header.quantStep = quantStep;
+		header.hashWordCount = (uint32_t)hashImage.size();
+
+		// Most likely words overall
+		std::vector<uint32_t> byProb(wordCount);
+		for (w = 0; w < wordCount; w++)
+		{
+			byProb[w] = w;
+		}
+		size_t topCount = (std::min)((size_t)CONTEXT_TOP_UNIGRAMS, (size_t)wordCount);
+		std::partial_sort(byProb.begin(), byProb.begin() + topCount, byProb.end(), [&unigramProbs](uint32_t a, uint32_t b) { return unigramProbs[a] > unigramProbs[b]; });
+		for (i = 0; i < CONTEXT_TOP_UNIGRAMS; i++)
+		{
+			header.topUnigrams[i] = i < topCount ? (byProb[i] << 8) | QuantizeProb(unigramProbs[byProb[i]], quantStep) : CONTEXT_NO_WORD;
+		}
+
+		// Write to a temporary file and then move it into place
+		KPTSysCharT tempPath[MAX_PATH];
+		swprintf_s(tempPath, MAX_PATH, _T("%s.tmp"), pImagePath);
+		pFile = NULL;
+		if (0 != _wfopen_s(&pFile, tempPath, _T("wb")) || pFile == NULL)
+		{
+			return false;
+		}
+		size_t padding = AlignOffset(chars.size() * sizeof(KPTUniCharT) + wordCount) - (chars.size() * sizeof(KPTUniCharT) + wordCount);
+		uint8_t zeros[4] = { 0, 0, 0, 0 };
+		bool success = fwrite(&header, sizeof(header), 1, pFile) == 1 &&
+			fwrite(hashImage.data(), sizeof(uint64_t), hashImage.size(), pFile) == hashImage.size() &&
+			fwrite(fingerprints.data(), sizeof(uint32_t), fingerprints.size(), pFile) == fingerprints.size() &&
+			fwrite(wordOffsets.data(), sizeof(uint32_t), wordOffsets.size(), pFile) == wordOffsets.size() &&
+			fwrite(chars.data(), sizeof(KPTUniCharT), chars.size(), pFile) == chars.size() &&
+			fwrite(quantizedBackoffs.data(), 1, quantizedBackoffs.size(), pFile) == quantizedBackoffs.size() &&
+			fwrite(zeros, 1, padding, pFile) == padding &&
+			fwrite(bigramStarts.data(), sizeof(uint32_t), bigramStarts.size(), pFile) == bigramStarts.size() &&
+			fwrite(packedBigrams.data(), sizeof(uint32_t), packedBigrams.size(), pFile) == packedBigrams.size() &&
+			fwrite(slots.data(), sizeof(ContextSlotT), slots.size(), pFile) == slots.size() &&
+			fwrite(packedTrigrams.data(), sizeof(uint32_t), packedTrigrams.size(), pFile) == packedTrigrams.size();
+		success = (fclose(pFile) == 0) && success;
+
+		if (!success || !MappedFile::ReplaceFile(tempPath, pImagePath))
+		{
+			DeleteFileW(tempPath);
+			return false;
+		}
+
+		return true;
+	}
@@ -0,0 +1,110 @@
+#pragma once
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+
+#include <vector>
+#include "kptapi.h"
+#include "MappedFile.h"
+#include "PerfectHash.h"
+
+	#define CONTEXT_MODEL_MAGIC 0x4D474E43		// "CNGM"
+	#define CONTEXT_MODEL_VERSION 2
+	#define CONTEXT_NO_WORD 0xFFFFFFFF
+	#define CONTEXT_TOP_UNIGRAMS 16
+	#define CONTEXT_LOGPROB_RANGE 8.0f			// Quantized log10 probabilities cover 1 down to 1e-8
+	#define CONTEXT_WORD_BITS 24				// Successors are packed as (word id << 8) | quantized log probability
+
+	// Header of a context model image
+	struct ContextModelHeaderT
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint64_t sourceSize;			// Size of the n-gram file the image was built from
+		uint64_t sourceTime;			// Last write time of the n-gram file the image was built from
+		uint32_t wordCount;				// Number of words in the vocabulary
+		uint32_t charCount;				// Number of characters in the word pool, including NULLs
+		uint32_t bigramCount;			// Number of bigram successors
+		uint32_t trigramSlotCount;		// Number of slots in the trigram context hash table (a power of two)
+		uint32_t trigramCount;			// Number of trigram successors
+		float quantStep;				// log10 units per quantization level
+		uint32_t hashWordCount;			// Size of the perfect hash image in 64-bit words
+		uint32_t topUnigrams[CONTEXT_TOP_UNIGRAMS];	// Most likely words when there is no usable context
+	};
+
+	// A two-word context in the trigram hash table
+	struct ContextSlotT
+	{
+		uint32_t word1;			// CONTEXT_NO_WORD for an empty slot
+		uint32_t word2;
+		uint32_t start;			// First successor in the trigram array
+		uint32_t count;			// Number of successors
+		uint32_t backoff;		// Quantized log10 weight of the bigram distribution for words not listed
+	};
+
+	// A predicted next word
+	struct ContextPredictionT
+	{
+		uint32_t wordId;
+		float prob;
+	};
+
+	// Native next-word model built from bigram and trigram counts
+	// Probabilities are interpolated absolute discounting with Kneser-Ney continuation counts for the unigram distribution.
+	// Word ids are assigned by a minimal perfect hash of the vocabulary, so looking up a context word needs no string comparisons.
+	// Successors of each one-word context are stored contiguously by word id (the ids are dense, so no hashing is needed)
+	// and successors of each two-word context are found through an open-addressing hash table. Each successor list is sorted
+	// by probability, so the best predictions are read from the front. Log probabilities are quantized to 8 bits.
+	// N-gram counts are read from a UTF-8 file in the Lexicon folder named after the dictionary e.g. enggb_ngrams.txt,
+	// with one n-gram per line in the form word1 word2[ word3]<tab>count.
+	// Layout: header, perfect hash, word fingerprints, word offsets (wordCount + 1), case-folded words, unigram backoff weights,
+	// bigram starts (wordCount + 1), bigram successors, trigram context slots, trigram successors.
+	class ContextModel
+	{
+	private:
+		MappedFile _file;
+		const ContextModelHeaderT *_pHeader;
+		PerfectHash _wordHash;
+		const uint32_t *_pFingerprints;
+		const uint32_t *_pWordOffsets;
+		const KPTUniCharT *_pChars;
+		const uint8_t *_pUnigramBackoffs;
+		const uint32_t *_pBigramStarts;
+		const uint32_t *_pBigrams;
+		const ContextSlotT *_pTrigramSlots;
+		const uint32_t *_pTrigrams;
+
+	public:
+		ContextModel(void);
+		~ContextModel(void);
+
+		bool Load(const KPTSysCharT *pBasePath, const KPTUniCharT *dictName);
+		void Close(void);
+		bool IsLoaded(void) const { return _pHeader != NULL; }
+		size_t MemoryFootprint(void) const { return _file.Size(); }
+
+		uint32_t FindWord(const KPTUniCharT *word, size_t length) const;
+		const KPTUniCharT *GetText(uint32_t wordId) const { return &_pChars[_pWordOffsets[wordId]]; }
+		uint32_t GetTopWord(size_t index) const;
+		bool HasContext(uint32_t word1, uint32_t word2) const;
+		void Predict(uint32_t word1, uint32_t word2, size_t maxCount, std::vector<ContextPredictionT> &predictions) const;
+
+		static bool Build(const KPTSysCharT *pSourcePath, const KPTSysCharT *pImagePath, uint64_t sourceSize, uint64_t sourceTime);
+
+	private:
+		bool Map(const KPTSysCharT *pImagePath, uint64_t sourceSize, uint64_t sourceTime);
+		const ContextSlotT *FindContext(uint32_t word1, uint32_t word2) const;
+		float Dequantize(uint32_t quantized) const;
+		static void AddPrediction(uint32_t wordId, float prob, std::vector<ContextPredictionT> &predictions);
+		static uint32_t HashContext(uint32_t word1, uint32_t word2);
+	};
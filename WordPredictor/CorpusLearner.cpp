@@ -0,0 +1,374 @@
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+#include "stdafx.h"
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include "Lexicon.h"
+#include "MappedFile.h"
+#include "CorpusLearner.h"
+
+	// Constructor
+	CorpusLearner::CorpusLearner(void)
+	{
+		_nextFile = 0;
+		_filesDone = 0;
+		_bytesDone = 0;
+		_tokenCount = 0;
+		_isCancelled = false;
+		_isCounted = false;
+		_totalBytes = 0;
+		_nextWord = 0;
+	}
+
+	// Destructor
+	CorpusLearner::~CorpusLearner(void)
+	{
+		Cancel();
+	}
+
+	// Start counting the words in some text files in the background, or return false if counting is already under way
+	// The progress callback is called on the background thread, and can cancel counting by returning an error
+	bool CorpusLearner::Start(const std::vector<std::wstring> &filePaths, KPTProgressFnT progress, intptr_t progressContext)
+	{
+		if (_thread.joinable() && !_isCounted)
+		{
+			return false;
+		}
+		if (_thread.joinable())
+		{
+			_thread.join();
+		}
+
+		_filePaths = filePaths;
+		std::vector<WordCountT>().swap(_counts);
+		_nextFile = 0;
+		_filesDone = 0;
+		_bytesDone = 0;
+		_tokenCount = 0;
+		_isCancelled = false;
+		_isCounted = false;
+		_totalBytes = 0;
+		_nextWord = 0;
+		_thread = std::thread(&CorpusLearner::Run, this, progress, progressContext);
+
+		return true;
+	}
+
+	// Wait for the background thread once counting has ended, and return false if it was cancelled
+	bool CorpusLearner::FinishCounting(void)
+	{
+		if (_thread.joinable())
+		{
+			_thread.join();
+		}
+
+		return _isCounted && !_isCancelled;
+	}
+
+	// Stop counting and wait for the threads to finish
+	void CorpusLearner::Cancel(void)
+	{
+		_isCancelled = true;
+		if (_thread.joinable())
+		{
+			_thread.join();
+		}
+	}
+
+	// Get the number of files done out of the total, and the bytes read overall
+	void CorpusLearner::GetProgress(KPTProgressDataT &data) const
+	{
+		uint64_t totalBytes = _totalBytes;
+		data.current.maximum = _filePaths.size();
+		data.current.position = _filesDone;
+		data.overall.maximum = (size_t)totalBytes;
+		data.overall.position = (size_t)(std::min)((uint64_t)_bytesDone, totalBytes);
+	}
+
+	// Put the next counted words into a buffer of text for the engine to learn, and say which stage of a multi-phase pass
+	// it is, or return false if there are no more. Each occurrence of a word goes on its own line, so that repeating a
+	// word doesn't teach the engine that it follows itself.
+	bool CorpusLearner::GetLearnBuffer(std::vector<KPTUniCharT> &buffer, KPTLearningStageT &stage)
+	{
+		buffer.clear();
+		if (_nextWord == _counts.size())
+		{
+			return false;
+		}
+
+		bool isFirst = _nextWord == 0;
+		while (_nextWord < _counts.size() && buffer.size() < LEARN_BUFFER_CHARS)
+		{
+			const WordCountT &wordCount = _counts[_nextWord++];
+			uint32_t repeats = (std::min)(wordCount.count, (uint32_t)LEARN_MAX_REPEATS);
+			for (uint32_t i = 0; i < repeats; i++)
+			{
+				buffer.insert(buffer.end(), wordCount.word.begin(), wordCount.word.end());
+				buffer.push_back(L'\n');
+			}
+		}
+
+		bool isLast = _nextWord == _counts.size();
+		if (isFirst)
+		{
+			stage = isLast ? eKPTLearnSingle : eKPTLearnMultiStart;
+		}
+		else
+		{
+			stage = isLast ? eKPTLearnMultiEnd : eKPTLearnMultiContinue;
+		}
+
+		return true;
+	}
+
+	// Background thread that counts the words in the files, most frequent first, reporting progress until they are done
+	void CorpusLearner::Run(KPTProgressFnT progress, intptr_t progressContext)
+	{
+		uint64_t totalBytes = 0;
+		for (size_t i = 0; i < _filePaths.size(); i++)
+		{
+			uint64_t size;
+			uint64_t lastWriteTime;
+			if (MappedFile::GetFileStamp(_filePaths[i].c_str(), size, lastWriteTime))
+			{
+				totalBytes += size;
+			}
+		}
+		_totalBytes = totalBytes;
+
+		// One thread per file, up to the number of cores
+		size_t threadCount = (std::min)((size_t)(std::max)(std::thread::hardware_concurrency(), 1u), (std::min)(_filePaths.size(), (size_t)MAX_LEARN_THREADS));
+		_threadCounts.assign(threadCount, WordCountTableT());
+		std::vector<std::thread> threads;
+		for (size_t i = 0; i < threadCount; i++)
+		{
+			threads.push_back(std::thread(&CorpusLearner::RunThread, this, i));
+		}
+
+		while (_filesDone < _filePaths.size() && !_isCancelled)
+		{
+			ReportProgress(progress, progressContext);
+			std::this_thread::sleep_for(std::chrono::milliseconds(LEARN_PROGRESS_INTERVAL_MS));
+		}
+		for (size_t i = 0; i < threads.size(); i++)
+		{
+			threads[i].join();
+		}
+		if (_isCancelled)
+		{
+			std::vector<WordCountTableT>().swap(_threadCounts);
+			_isCounted = true;
+			return;
+		}
+		ReportProgress(progress, progressContext);
+
+		// Merge the threads' tables into the first
+		for (size_t i = 1; i < _threadCounts.size(); i++)
+		{
+			for (WordCountTableT::const_iterator it = _threadCounts[i].begin(); it != _threadCounts[i].end(); ++it)
+			{
+				_threadCounts[0][it->first] += it->second;
+			}
+			WordCountTableT().swap(_threadCounts[i]);
+		}
+		if (!_threadCounts.empty())
+		{
+			_counts.reserve(_threadCounts[0].size());
+			for (WordCountTableT::const_iterator it = _threadCounts[0].begin(); it != _threadCounts[0].end(); ++it)
+			{
+				WordCountT wordCount = { it->first, it->second };
+				_counts.push_back(wordCount);
+			}
+		}
+		std::vector<WordCountTableT>().swap(_threadCounts);
+		std::sort(_counts.begin(), _counts.end(), [](const WordCountT &a, const WordCountT &b) { return a.count > b.count; });
+
+		TRACE(_T("Counted %u distinct words in %u files\n"), (unsigned)_counts.size(), (unsigned)_filePaths.size());
+		_isCounted = true;
+	}
+
+	// Worker thread that counts files until there are none left
+	void CorpusLearner::RunThread(size_t threadIndex)
+	{
+		size_t fileIndex;
+		while (!_isCancelled && (fileIndex = _nextFile++) < _filePaths.size())
+		{
+			CountFile(_filePaths[fileIndex], _threadCounts[threadIndex]);
+			_filesDone++;
+		}
+	}
+
+	// Count the words in a file
+	void CorpusLearner::CountFile(const std::wstring &filePath, WordCountTableT &counts)
+	{
+		MappedFile file;
+		if (!file.Open(filePath.c_str()))
+		{
+			TRACE(_T("Couldn't read %s\n"), filePath.c_str());
+			return;
+		}
+
+		// Check for a byte order mark
+		const uint8_t *pData = file.Data();
+		size_t size = file.Size();
+		size_t offset = 0;
+		TextEncodingT encoding = eTextEncodingUtf8;
+		if (size >= 2 && pData[0] == 0xFF && pData[1] == 0xFE)
+		{
+			encoding = eTextEncodingUtf16LE;
+			offset = 2;
+		}
+		else if (size >= 2 && pData[0] == 0xFE && pData[1] == 0xFF)
+		{
+			encoding = eTextEncodingUtf16BE;
+			offset = 2;
+		}
+		else if (size >= 3 && pData[0] == 0xEF && pData[1] == 0xBB && pData[2] == 0xBF)
+		{
+			offset = 3;
+		}
+
+		// Words longer than the maximum are skipped
+		std::wstring word;
+		bool isTooLong = false;
+		uint64_t tokenCount = 0;
+		size_t reported = offset;
+		while (offset <= size)
+		{
+			KPTUniCharT ch = L' ';
+			if (offset < size)
+			{
+				offset += DecodeChar(pData + offset, size - offset, encoding, ch);
+			}
+			else
+			{
+				offset++;
+			}
+
+			if (Lexicon::IsWordChar(ch))
+			{
+				if (word.length() < MAX_WORD_LEN)
+				{
+					word.push_back(ch);
+				}
+				else
+				{
+					isTooLong = true;
+				}
+			}
+			else if (!word.empty())
+			{
+				if (!isTooLong)
+				{
+					counts[word]++;
+				}
+				tokenCount++;
+				word.clear();
+				isTooLong = false;
+			}
+
+			if (offset - reported >= LEARN_PROGRESS_BYTES)
+			{
+				_bytesDone += offset - reported;
+				reported = offset;
+				if (_isCancelled)
+				{
+					return;
+				}
+			}
+		}
+		_bytesDone += size - (std::min)(reported, size);
+		_tokenCount += tokenCount;
+	}
+
+	// Call the progress callback with the files done and the bytes read overall, and cancel if it returns an error
+	void CorpusLearner::ReportProgress(KPTProgressFnT progress, intptr_t progressContext)
+	{
+		if (progress == NULL)
+		{
+			return;
+		}
+
+		KPTProgressDataT data;
+		GetProgress(data);
+		if (!KPTRESULT_ISSUCCESS(progress(&data, progressContext)))
+		{
+			_isCancelled = true;
+		}
+	}
+
+	// Decode the character at the start of some text and return the number of bytes it takes up
+	// Invalid sequences and characters outside the basic multilingual plane are returned as spaces
+	size_t CorpusLearner::DecodeChar(const uint8_t *pData, size_t size, TextEncodingT encoding, KPTUniCharT &ch)
+	{
+		if (encoding != eTextEncodingUtf8)
+		{
+			if (size < 2)
+			{
+				ch = L' ';
+				return size;
+			}
+			uint16_t unit = encoding == eTextEncodingUtf16LE ? (uint16_t)(pData[0] | (pData[1] << 8)) : (uint16_t)((pData[0] << 8) | pData[1]);
+			ch = (unit >= 0xD800 && unit <= 0xDFFF) ? L' ' : (KPTUniCharT)unit;
+			return 2;
+		}
+
+		uint8_t lead = pData[0];
+		size_t length;
+		uint32_t codePoint;
+		if (lead < 0x80)
+		{
+			ch = (KPTUniCharT)lead;
+			return 1;
+		}
+		else if ((lead & 0xE0) == 0xC0)
+		{
+			length = 2;
+			codePoint = lead & 0x1F;
+		}
+		else if ((lead & 0xF0) == 0xE0)
+		{
+			length = 3;
+			codePoint = lead & 0x0F;
+		}
+		else if ((lead & 0xF8) == 0xF0)
+		{
+			length = 4;
+			codePoint = lead & 0x07;
+		}
+		else
+		{
+			ch = L' ';
+			return 1;
+		}
+
+		if (length > size)
+		{
+			ch = L' ';
+			return size;
+		}
+		for (size_t i = 1; i < length; i++)
+		{
+			if ((pData[i] & 0xC0) != 0x80)
+			{
+				ch = L' ';
+				return i;
+			}
+			codePoint = (codePoint << 6) | (pData[i] & 0x3F);
+		}
+		ch = codePoint <= 0xFFFF ? (KPTUniCharT)codePoint : L' ';
+
+		return length;
+	}
@@ -0,0 +1,85 @@
+#pragma once
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <atomic>
+#include <thread>
+#include "kptapi.h"
+#include "kptapi_progress.h"
+#include "kptapi_learn.h"
+
+	// A word found in a text and the number of times it occurred
+	struct WordCountT
+	{
+		std::wstring word;
+		uint32_t count;
+	};
+
+	// Character encodings of text files
+	enum TextEncodingT
+	{
+		eTextEncodingUtf8 = 0,
+		eTextEncodingUtf16LE = 1,
+		eTextEncodingUtf16BE = 2
+	};
+
+	typedef std::unordered_map<std::wstring, uint32_t> WordCountTableT;
+
+	// Counts the words in a set of text files in parallel, e.g. to learn a user's vocabulary from their documents.
+	// Counting runs in the background, so the caller's thread is free to poll the progress. A pool of threads takes
+	// files from a shared index, and each thread counts the words of its files into its own table, so that the threads
+	// never contend. The tables are merged when every file has been read. Files are UTF-8 unless they start with a
+	// UTF-16 byte order mark, and are tokenized into words the same way as the input buffer.
+	// Once the caller has chosen which of the counted words to learn, they are handed out as text for the engine to learn
+	// a buffer at a time, with each word repeated as many times as it occurred, up to a cap.
+	class CorpusLearner
+	{
+	private:
+		std::thread _thread;
+		std::vector<std::wstring> _filePaths;
+		std::vector<WordCountTableT> _threadCounts;
+		std::vector<WordCountT> _counts;		// Words counted, most frequent first
+		std::atomic<size_t> _nextFile;
+		std::atomic<size_t> _filesDone;
+		std::atomic<uint64_t> _bytesDone;
+		std::atomic<uint64_t> _tokenCount;
+		std::atomic<bool> _isCancelled;
+		std::atomic<bool> _isCounted;
+		std::atomic<uint64_t> _totalBytes;
+		size_t _nextWord;						// Next of the counts to put in a learning buffer
+
+	public:
+		CorpusLearner(void);
+		~CorpusLearner(void);
+
+		bool Start(const std::vector<std::wstring> &filePaths, KPTProgressFnT progress, intptr_t progressContext);
+		bool IsCounted(void) const { return _isCounted; }
+		bool FinishCounting(void);
+		void Cancel(void);
+		void GetProgress(KPTProgressDataT &data) const;
+		std::vector<WordCountT> &Counts(void) { return _counts; }
+		uint64_t TokenCount(void) const { return _tokenCount; }
+		size_t LearnedCount(void) const { return _nextWord; }
+		bool GetLearnBuffer(std::vector<KPTUniCharT> &buffer, KPTLearningStageT &stage);
+
+	private:
+		void Run(KPTProgressFnT progress, intptr_t progressContext);
+		void RunThread(size_t threadIndex);
+		void CountFile(const std::wstring &filePath, WordCountTableT &counts);
+		void ReportProgress(KPTProgressFnT progress, intptr_t progressContext);
+		static size_t DecodeChar(const uint8_t *pData, size_t size, TextEncodingT encoding, KPTUniCharT &ch);
+	};
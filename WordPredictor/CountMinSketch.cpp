@@ -0,0 +1,118 @@
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+#include "stdafx.h"
+#include <algorithm>
+#include "CountMinSketch.h"
+
+	// Constructor
+	CountMinSketch::CountMinSketch(void)
+	{
+		_widthMask = 0;
+		_additions = 0;
+		_resetInterval = 0;
+	}
+
+	// Destructor
+	CountMinSketch::~CountMinSketch(void)
+	{
+	}
+
+	// Allocate at least the specified number of counters per row, and halve the counts after each reset interval of sightings
+	void CountMinSketch::SetSize(size_t width, uint32_t resetInterval)
+	{
+		size_t rowSize = 16;
+		while (rowSize < width)
+		{
+			rowSize *= 2;
+		}
+
+		_counters.assign(rowSize * SKETCH_DEPTH, 0);
+		_widthMask = rowSize - 1;
+		_resetInterval = resetInterval;
+		_additions = 0;
+	}
+
+	// Forget all the sightings
+	void CountMinSketch::Clear(void)
+	{
+		std::fill(_counters.begin(), _counters.end(), (uint8_t)0);
+		_additions = 0;
+	}
+
+	// Record a sighting of a key and return its new estimated count
+	// Only the counters holding the current minimum are incremented, which keeps the overestimate from other keys down
+	uint32_t CountMinSketch::Add(uint64_t hash)
+	{
+		if (_counters.empty())
+		{
+			return 0;
+		}
+
+		uint32_t estimate = Estimate(hash);
+		if (estimate < SKETCH_MAX_COUNT)
+		{
+			for (size_t row = 0; row < SKETCH_DEPTH; row++)
+			{
+				uint8_t &counter = _counters[GetIndex(hash, row)];
+				if (counter == estimate)
+				{
+					counter++;
+				}
+			}
+			estimate++;
+		}
+
+		if (++_additions >= _resetInterval)
+		{
+			Halve();
+		}
+
+		return estimate;
+	}
+
+	// Get the estimated number of sightings of a key
+	uint32_t CountMinSketch::Estimate(uint64_t hash) const
+	{
+		if (_counters.empty())
+		{
+			return 0;
+		}
+
+		uint32_t estimate = SKETCH_MAX_COUNT;
+		for (size_t row = 0; row < SKETCH_DEPTH; row++)
+		{
+			estimate = (std::min)(estimate, (uint32_t)_counters[GetIndex(hash, row)]);
+		}
+
+		return estimate;
+	}
+
+	// Get the position of a key's counter in a row, combining two halves of the hash with a different multiple for each row
+	size_t CountMinSketch::GetIndex(uint64_t hash, size_t row) const
+	{
+		uint32_t low = (uint32_t)hash;
+		uint32_t high = (uint32_t)(hash >> 32) | 1;
+
+		return row * (_widthMask + 1) + ((low + (uint32_t)row * high) & _widthMask);
+	}
+
+	// Halve every counter, so that recent sightings outweigh older ones
+	void CountMinSketch::Halve(void)
+	{
+		for (size_t i = 0; i < _counters.size(); i++)
+		{
+			_counters[i] >>= 1;
+		}
+		_additions /= 2;
+	}
@@ -0,0 +1,46 @@
+#pragma once
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+
+#include <vector>
+#include "kptapi.h"
+
+	#define SKETCH_DEPTH 4
+	#define SKETCH_MAX_COUNT 255
+
+	// Fixed-size approximate counter of how often each hashed key has been seen, which can overestimate but never
+	// underestimates. Each key has a saturating 8-bit counter in each of SKETCH_DEPTH rows and its estimate is the
+	// smallest of them. Every time the reset interval is reached all counters are halved, so that old sightings fade.
+	class CountMinSketch
+	{
+	private:
+		std::vector<uint8_t> _counters;
+		size_t _widthMask;					// Counters per row, minus one
+		uint32_t _additions;				// Number of sightings since the counters were last halved
+		uint32_t _resetInterval;
+
+	public:
+		CountMinSketch(void);
+		~CountMinSketch(void);
+
+		void SetSize(size_t width, uint32_t resetInterval);
+		void Clear(void);
+
+		uint32_t Add(uint64_t hash);
+		uint32_t Estimate(uint64_t hash) const;
+
+	private:
+		size_t GetIndex(uint64_t hash, size_t row) const;
+		void Halve(void);
+	};
@@ -0,0 +1,296 @@
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+#include "stdafx.h"
+#include <algorithm>
+#include "Lexicon.h"
+#include "DeletionIndex.h"
+
+	// Constructor
+	DeletionIndex::DeletionIndex(void)
+	{
+		_pHeader = NULL;
+		_pBuckets = NULL;
+		_pEntries = NULL;
+		_pWordOffsets = NULL;
+		_pChars = NULL;
+	}
+
+	// Destructor
+	DeletionIndex::~DeletionIndex(void)
+	{
+	}
+
+	// Map the index for a dictionary, building it first if it is missing or out of date
+	bool DeletionIndex::Load(const KPTSysCharT *pBasePath, const KPTUniCharT *dictName, uint32_t maxDistance, uint32_t prefixLength)
+	{
+		Close();
+
+		KPTSysCharT sourcePath[MAX_PATH];
+		KPTSysCharT imagePath[MAX_PATH];
+		uint64_t sourceSize;
+		uint64_t sourceTime;
+		swprintf_s(sourcePath, MAX_PATH, _T("%s\\%s\\%s%s"), pBasePath, LEXICON_FOLDER, dictName, LEXICON_FILE_EXT);
+		swprintf_s(imagePath, MAX_PATH, _T("%s\\%s\\%s%s"), pBasePath, LEXICON_FOLDER, dictName, DELETION_INDEX_FILE_EXT);
+		if (!MappedFile::GetFileStamp(sourcePath, sourceSize, sourceTime))
+		{
+			return false;
+		}
+
+		if (Map(imagePath, maxDistance, prefixLength, sourceSize, sourceTime))
+		{
+			return true;
+		}
+
+		TRACE(_T("Building deletion index %s\n"), imagePath);
+		if (!Build(pBasePath, dictName, imagePath, maxDistance, prefixLength, sourceSize, sourceTime))
+		{
+			return false;
+		}
+
+		return Map(imagePath, maxDistance, prefixLength, sourceSize, sourceTime);
+	}
+
+	// Unmap the index
+	void DeletionIndex::Close(void)
+	{
+		_file.Close();
+		_pHeader = NULL;
+		_pBuckets = NULL;
+		_pEntries = NULL;
+		_pWordOffsets = NULL;
+		_pChars = NULL;
+	}
+
+	// Map an image and check that it matches the settings and the word list it was built from
+	bool DeletionIndex::Map(const KPTSysCharT *pImagePath, uint32_t maxDistance, uint32_t prefixLength, uint64_t sourceSize, uint64_t sourceTime)
+	{
+		if (!_file.Open(pImagePath) || _file.Size() < sizeof(DeletionIndexHeaderT))
+		{
+			_file.Close();
+			return false;
+		}
+
+		const DeletionIndexHeaderT *pHeader = (const DeletionIndexHeaderT *)_file.Data();
+		size_t expectedSize = sizeof(DeletionIndexHeaderT) +
+			((size_t)pHeader->bucketCount + 1) * sizeof(uint32_t) +
+			(size_t)pHeader->entryCount * sizeof(DeletionEntryT) +
+			((size_t)pHeader->wordCount + 1) * sizeof(uint32_t) +
+			(size_t)pHeader->charCount * sizeof(KPTUniCharT);
+		if (pHeader->magic != DELETION_INDEX_MAGIC ||
+			pHeader->version != DELETION_INDEX_VERSION ||
+			pHeader->maxDistance != maxDistance ||
+			pHeader->prefixLength != prefixLength ||
+			pHeader->sourceSize != sourceSize ||
+			pHeader->sourceTime != sourceTime ||
+			pHeader->bucketCount == 0 ||
+			(pHeader->bucketCount & (pHeader->bucketCount - 1)) != 0 ||
+			expectedSize != _file.Size())
+		{
+			_file.Close();
+			return false;
+		}
+
+		_pHeader = pHeader;
+		_pBuckets = (const uint32_t *)(_pHeader + 1);
+		_pEntries = (const DeletionEntryT *)(_pBuckets + _pHeader->bucketCount + 1);
+		_pWordOffsets = (const uint32_t *)(_pEntries + _pHeader->entryCount);
+		_pChars = (const KPTUniCharT *)(_pWordOffsets + _pHeader->wordCount + 1);
+		TRACE(_T("Mapped deletion index %s (%u words, %u bytes)\n"), pImagePath, _pHeader->wordCount, (unsigned)_file.Size());
+
+		return true;
+	}
+
+	// Find the words that share a deletion with the input, i.e. those that may be within the index's edit distance of it
+	// The list may include hash collisions and words that are further away, so callers should check the distance
+	void DeletionIndex::Lookup(const KPTUniCharT *word, size_t length, std::vector<uint32_t> &wordIndexes)
+	{
+		wordIndexes.clear();
+		if (_pHeader == NULL)
+		{
+			return;
+		}
+
+		KPTUniCharT folded[MAX_WORD_LEN];
+		length = (std::min)(length, (size_t)(std::min)(_pHeader->prefixLength, (uint32_t)MAX_WORD_LEN));
+		for (size_t i = 0; i < length; i++)
+		{
+			folded[i] = Lexicon::Fold(word[i]);
+		}
+
+		_hashes.clear();
+		_hashes.push_back(Hash(folded, length));
+		AddDeletions(folded, length, 0, 0, _pHeader->maxDistance, _hashes);
+		std::sort(_hashes.begin(), _hashes.end());
+		_hashes.erase(std::unique(_hashes.begin(), _hashes.end()), _hashes.end());
+
+		uint32_t mask = _pHeader->bucketCount - 1;
+		for (size_t h = 0; h < _hashes.size(); h++)
+		{
+			uint32_t hash = _hashes[h];
+			uint32_t bucket = hash & mask;
+			for (uint32_t e = _pBuckets[bucket]; e < _pBuckets[bucket + 1]; e++)
+			{
+				if (_pEntries[e].hash == hash)
+				{
+					wordIndexes.push_back(_pEntries[e].wordIndex);
+				}
+			}
+		}
+
+		std::sort(wordIndexes.begin(), wordIndexes.end());
+		wordIndexes.erase(std::unique(wordIndexes.begin(), wordIndexes.end()), wordIndexes.end());
+	}
+
+	// Get the case-folded text of a word in the index
+	const KPTUniCharT *DeletionIndex::GetText(uint32_t wordIndex, size_t &length) const
+	{
+		length = _pWordOffsets[wordIndex + 1] - _pWordOffsets[wordIndex] - 1;
+
+		return &_pChars[_pWordOffsets[wordIndex]];
+	}
+
+	// Build the index image for a dictionary's word list
+	bool DeletionIndex::Build(const KPTSysCharT *pBasePath, const KPTUniCharT *dictName, const KPTSysCharT *pImagePath,
+								uint32_t maxDistance, uint32_t prefixLength, uint64_t sourceSize, uint64_t sourceTime)
+	{
+		Lexicon lexicon;
+		if (!lexicon.Load(pBasePath, dictName))
+		{
+			return false;
+		}
+
+		// Collect the deletions of each word
+		std::vector<DeletionEntryT> entries;
+		std::vector<uint32_t> wordOffsets;
+		std::vector<KPTUniCharT> chars;
+		std::vector<uint32_t> hashes;
+		KPTUniCharT folded[MAX_WORD_LEN];
+		uint32_t wordIndex;
+		for (wordIndex = 0; wordIndex < lexicon.WordCount(); wordIndex++)
+		{
+			const KPTUniCharT *text = lexicon.GetText(wordIndex);
+			size_t length = lexicon.GetWord(wordIndex).length;
+			size_t i;
+			for (i = 0; i < length; i++)
+			{
+				folded[i] = Lexicon::Fold(text[i]);
+			}
+			wordOffsets.push_back((uint32_t)chars.size());
+			chars.insert(chars.end(), folded, folded + length);
+			chars.push_back(L'\0');
+
+			size_t keyLength = (std::min)(length, (size_t)prefixLength);
+			hashes.clear();
+			hashes.push_back(Hash(folded, keyLength));
+			AddDeletions(folded, keyLength, 0, 0, maxDistance, hashes);
+			std::sort(hashes.begin(), hashes.end());
+			hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+			for (i = 0; i < hashes.size(); i++)
+			{
+				DeletionEntryT entry = { hashes[i], wordIndex };
+				entries.push_back(entry);
+			}
+		}
+		wordOffsets.push_back((uint32_t)chars.size());
+
+		// Group the entries into buckets, aiming for two entries per bucket
+		uint32_t bucketCount = 1024;
+		while (bucketCount < entries.size() / 2)
+		{
+			bucketCount <<= 1;
+		}
+		uint32_t mask = bucketCount - 1;
+		std::sort(entries.begin(), entries.end(), [mask](const DeletionEntryT &a, const DeletionEntryT &b)
+		{
+			return (a.hash & mask) != (b.hash & mask) ? (a.hash & mask) < (b.hash & mask) : a.wordIndex < b.wordIndex;
+		});
+		std::vector<uint32_t> buckets(bucketCount + 1, 0);
+		size_t e;
+		for (e = 0; e < entries.size(); e++)
+		{
+			buckets[(entries[e].hash & mask) + 1]++;
+		}
+		for (uint32_t b = 0; b < bucketCount; b++)
+		{
+			buckets[b + 1] += buckets[b];
+		}
+
+		DeletionIndexHeaderT header = { 0 };
+		header.magic = DELETION_INDEX_MAGIC;
+		header.version = DELETION_INDEX_VERSION;
+		header.maxDistance = maxDistance;
+		header.prefixLength = prefixLength;
+		header.sourceSize = sourceSize;
+		header.sourceTime = sourceTime;
+		header.bucketCount = bucketCount;
+		header.entryCount = (uint32_t)entries.size();
+		header.wordCount = (uint32_t)lexicon.WordCount();
+		header.charCount = (uint32_t)chars.size();
+
+		// Write to a temporary file and then move it into place
+		KPTSysCharT tempPath[MAX_PATH];
+		swprintf_s(tempPath, MAX_PATH, _T("%s.tmp"), pImagePath);
+		FILE *pFile = NULL;
+		if (0 != _wfopen_s(&pFile, tempPath, _T("wb")) || pFile == NULL)
+		{
+			return false;
+		}
+		bool success = fwrite(&header, sizeof(header), 1, pFile) == 1 &&
+			fwrite(buckets.data(), sizeof(uint32_t), buckets.size(), pFile) == buckets.size() &&
+			fwrite(entries.data(), sizeof(DeletionEntryT), entries.size(), pFile) == entries.size() &&
+			fwrite(wordOffsets.data(), sizeof(uint32_t), wordOffsets.size(), pFile) == wordOffsets.size() &&
+			fwrite(chars.data(), sizeof(KPTUniCharT), chars.size(), pFile) == chars.size();
+		success = (fclose(pFile) == 0) && success;
+
+		if (!success || !MappedFile::ReplaceFile(tempPath, pImagePath))
+		{
+			DeleteFileW(tempPath);
+			return false;
+		}
+
+		return true;
+	}
+
+	// Add the hashes of the strings obtained by deleting between 1 and maxDistance characters from a word
+	// Deleting in increasing position order avoids generating most of the duplicates
+	void DeletionIndex::AddDeletions(KPTUniCharT *word, size_t length, size_t start, uint32_t distance, uint32_t maxDistance, std::vector<uint32_t> &hashes)
+	{
+		if (distance >= maxDistance || length == 0)
+		{
+			return;
+		}
+
+		for (size_t i = start; i < length; i++)
+		{
+			// Delete the character at position i, recurse, then put it back
+			KPTUniCharT deleted = word[i];
+			memmove(&word[i], &word[i + 1], (length - i - 1) * sizeof(KPTUniCharT));
+			hashes.push_back(Hash(word, length - 1));
+			AddDeletions(word, length - 1, i, distance + 1, maxDistance, hashes);
+			memmove(&word[i + 1], &word[i], (length - i - 1) * sizeof(KPTUniCharT));
+			word[i] = deleted;
+		}
+	}
+
+	// FNV-1a hash of a string
+	uint32_t DeletionIndex::Hash(const KPTUniCharT *word, size_t length)
+	{
+		uint32_t hash = 2166136261u;
+		for (size_t i = 0; i < length; i++)
+		{
+			hash = (hash ^ (uint16_t)word[i]) * 16777619u;
+		}
+
+		return hash;
+	}
@@ -0,0 +1,82 @@
+#pragma once
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+
+#include <vector>
+#include "kptapi.h"
+#include "MappedFile.h"
+
+	#define DELETION_INDEX_MAGIC 0x58494C44		// "DLIX"
+	#define DELETION_INDEX_VERSION 1
+
+	// Header of a deletion index image
+	struct DeletionIndexHeaderT
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t maxDistance;		// Maximum number of deletions indexed
+		uint32_t prefixLength;		// Number of leading characters of each word that are indexed
+		uint64_t sourceSize;		// Size of the word list the image was built from
+		uint64_t sourceTime;		// Last write time of the word list the image was built from
+		uint32_t bucketCount;		// Number of hash buckets (a power of two)
+		uint32_t entryCount;		// Number of (deletion, word) entries
+		uint32_t wordCount;			// Number of words
+		uint32_t charCount;			// Number of characters in the word pool, including NULLs
+	};
+
+	// A deletion of a word, identified by the hash of the string left after deleting characters
+	struct DeletionEntryT
+	{
+		uint32_t hash;
+		uint32_t wordIndex;
+	};
+
+	// Precomputed deletion neighbourhood of a dictionary's words (SymSpell)
+	// Every string obtained by deleting up to maxDistance characters from the first prefixLength characters of a word
+	// is hashed into a bucket, so that the words within maxDistance of an input are found by hashing the input's own
+	// deletions rather than by searching the trie. The image is built from the dictionary's word list the first time
+	// it is needed, saved alongside it in the Lexicon folder, and memory mapped thereafter.
+	// Layout: header, bucket start offsets (bucketCount + 1), entries grouped by bucket, word offsets (wordCount + 1), case-folded words.
+	class DeletionIndex
+	{
+	private:
+		MappedFile _file;
+		const DeletionIndexHeaderT *_pHeader;
+		const uint32_t *_pBuckets;
+		const DeletionEntryT *_pEntries;
+		const uint32_t *_pWordOffsets;
+		const KPTUniCharT *_pChars;
+		std::vector<uint32_t> _hashes;
+
+	public:
+		DeletionIndex(void);
+		~DeletionIndex(void);
+
+		bool Load(const KPTSysCharT *pBasePath, const KPTUniCharT *dictName, uint32_t maxDistance, uint32_t prefixLength);
+		void Close(void);
+		bool IsLoaded(void) const { return _pHeader != NULL; }
+		size_t MemoryFootprint(void) const { return _file.Size(); }
+		uint32_t PrefixLength(void) const { return _pHeader->prefixLength; }
+
+		void Lookup(const KPTUniCharT *word, size_t length, std::vector<uint32_t> &wordIndexes);
+		const KPTUniCharT *GetText(uint32_t wordIndex, size_t &length) const;
+
+		static bool Build(const KPTSysCharT *pBasePath, const KPTUniCharT *dictName, const KPTSysCharT *pImagePath,
+							uint32_t maxDistance, uint32_t prefixLength, uint64_t sourceSize, uint64_t sourceTime);
+
+	private:
+		bool Map(const KPTSysCharT *pImagePath, uint32_t maxDistance, uint32_t prefixLength, uint64_t sourceSize, uint64_t sourceTime);
+		static void AddDeletions(KPTUniCharT *word, size_t length, size_t start, uint32_t distance, uint32_t maxDistance, std::vector<uint32_t> &hashes);
+		static uint32_t Hash(const KPTUniCharT *word, size_t length);
+	};
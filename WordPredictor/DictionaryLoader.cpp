@@ -0,0 +1,265 @@
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+#include "stdafx.h"
+#include "DictionaryLoader.h"
+
+	// Constructor
+	DictionaryLoader::DictionaryLoader(void)
+	{
+		_requested = 0;
+		_finished = 0;
+		_isStopping = false;
+		_pLoaded = NULL;
+	}
+
+	// Destructor
+	DictionaryLoader::~DictionaryLoader(void)
+	{
+		Stop();
+	}
+
+	// Start building a dictionary set in the background, superseding any load that hasn't finished
+	void DictionaryLoader::Start(const DictionaryRequestT &request)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_request = request;
+		_requested++;
+		if (!_thread.joinable())
+		{
+			_isStopping = false;
+			_thread = std::thread(&DictionaryLoader::Run, this);
+		}
+		_changed.notify_all();
+	}
+
+	// Stop the background thread, abandoning the current load at its next stage, and free any sets that weren't taken
+	void DictionaryLoader::Stop(void)
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_isStopping = true;
+			_changed.notify_all();
+		}
+		if (_thread.joinable())
+		{
+			_thread.join();
+		}
+
+		delete _pLoaded.exchange(NULL);
+		for (size_t i = 0; i < _retired.size(); i++)
+		{
+			delete _retired[i];
+		}
+		_retired.clear();
+		_finished = _requested;
+	}
+
+	// Hand back a set that has been replaced, to be freed on the background thread
+	void DictionaryLoader::Retire(DictionarySetT *pSet)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_retired.push_back(pSet);
+		if (!_thread.joinable())
+		{
+			_isStopping = false;
+			_thread = std::thread(&DictionaryLoader::Run, this);
+		}
+		_changed.notify_all();
+	}
+
+	// Build the set for each new request and free retired sets until stopped
+	void DictionaryLoader::Run(void)
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		while (true)
+		{
+			_changed.wait(lock, [this] { return _isStopping || _finished != _requested || !_retired.empty(); });
+			if (_isStopping)
+			{
+				break;
+			}
+
+			std::vector<DictionarySetT *> retired;
+			retired.swap(_retired);
+			bool isLoading = _finished != _requested;
+			uint32_t number = _requested;
+			DictionaryRequestT request = _request;
+			lock.unlock();
+
+			for (size_t i = 0; i < retired.size(); i++)
+			{
+				delete retired[i];
+			}
+
+			DictionarySetT *pSuperseded = NULL;
+			if (isLoading)
+			{
+				std::unique_ptr<DictionarySetT> pSet(new DictionarySetT);
+				bool isLoaded = Load(request, number, *pSet);
+
+				// Publish the set unless another load was requested meanwhile, replacing any earlier set that wasn't taken
+				lock.lock();
+				if (isLoaded && number == _requested)
+				{
+					pSuperseded = _pLoaded.exchange(pSet.release());
+				}
+				_finished = number;
+				_changed.notify_all();
+				lock.unlock();
+			}
+			delete pSuperseded;
+
+			lock.lock();
+		}
+	}
+
+	// See whether a load should be abandoned, because the loader is stopping or a newer load has been requested
+	bool DictionaryLoader::IsCancelled(uint32_t number)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		return _isStopping || number != _requested;
+	}
+
+	// Build a dictionary set: the lexicon and the indexes over it, and the files that go with each active dictionary
+	// Returns false if the load was abandoned between stages, so that stopping doesn't wait for the whole set
+	bool DictionaryLoader::Load(const DictionaryRequestT &request, uint32_t number, DictionarySetT &set)
+	{
+		set.lexicon.Load(request.basePath.c_str(), request.dictList.c_str());
+		if (IsCancelled(number))
+		{
+			return false;
+		}
+		if (set.ambiguousIndex.SetKeyGroups(request.keyGroups))
+		{
+			set.ambiguousIndex.Build(set.lexicon);
+		}
+		if (IsCancelled(number))
+		{
+			return false;
+		}
+		LoadDeletionIndexes(request, set);
+		if (IsCancelled(number))
+		{
+			return false;
+		}
+		LoadContextModels(request, set);
+		if (IsCancelled(number))
+		{
+			return false;
+		}
+		set.phraseIndex.Load(request.basePath.c_str(), request.dictList.c_str());
+
+		return true;
+	}
+
+	// Map the deletion index of each active dictionary, in priority order
+	void DictionaryLoader::LoadDeletionIndexes(const DictionaryRequestT &request, DictionarySetT &set)
+	{
+		set.deletionIndexes.clear();
+		if (request.indexMaxDistance == 0 || request.dictList.empty())
+		{
+			return;
+		}
+
+		KPTUniCharT *nextToken;
+		KPTUniCharT dictListCopy[MAX_STR_LEN];
+		wcsncpy_s(dictListCopy, request.dictList.c_str(), MAX_STR_LEN);
+		KPTUniCharT *token = wcstok_s(dictListCopy, _T(","), &nextToken);
+		while (token != NULL)
+		{
+			std::unique_ptr<DeletionIndex> pIndex(new DeletionIndex());
+			if (pIndex->Load(request.basePath.c_str(), token, request.indexMaxDistance, request.indexPrefixLength))
+			{
+				set.deletionIndexes.push_back(std::move(pIndex));
+			}
+			token = wcstok_s(NULL, _T(","), &nextToken);
+		}
+
+		TRACE(_T("Deletion indexes use %u bytes\n"), (unsigned)GetDeletionIndexSize(set));
+	}
+
+	// Map the context model of each active dictionary that has n-gram counts, in priority order, and cache the predictions
+	// for the start of a sentence and after each of the most likely words, since they are needed most often
+	void DictionaryLoader::LoadContextModels(const DictionaryRequestT &request, DictionarySetT &set)
+	{
+		set.contextModels.clear();
+		set.nextWordCache.Clear();
+		if (request.dictList.empty())
+		{
+			return;
+		}
+
+		KPTUniCharT *nextToken;
+		KPTUniCharT dictListCopy[MAX_STR_LEN];
+		wcsncpy_s(dictListCopy, request.dictList.c_str(), MAX_STR_LEN);
+		KPTUniCharT *token = wcstok_s(dictListCopy, _T(","), &nextToken);
+		while (token != NULL)
+		{
+			std::unique_ptr<ContextModel> pModel(new ContextModel());
+			if (pModel->Load(request.basePath.c_str(), token))
+			{
+				set.contextModels.push_back(std::move(pModel));
+			}
+			token = wcstok_s(NULL, _T(","), &nextToken);
+		}
+
+		std::vector<ContextPredictionT> predictions;
+		for (size_t m = 0; m < set.contextModels.size(); m++)
+		{
+			GetNextWords(set, m, CONTEXT_NO_WORD, CONTEXT_NO_WORD, predictions);
+			for (size_t i = 0; i < CONTEXT_TOP_UNIGRAMS; i++)
+			{
+				uint32_t wordId = set.contextModels[m]->GetTopWord(i);
+				if (wordId != CONTEXT_NO_WORD)
+				{
+					GetNextWords(set, m, CONTEXT_NO_WORD, wordId, predictions);
+				}
+			}
+		}
+
+		TRACE(_T("Next word cache holds %u contexts\n"), (unsigned)set.nextWordCache.Count());
+	}
+
+	// Get the memory footprint of a set's deletion indexes in bytes
+	size_t DictionaryLoader::GetDeletionIndexSize(const DictionarySetT &set)
+	{
+		size_t size = 0;
+		for (size_t i = 0; i < set.deletionIndexes.size(); i++)
+		{
+			size += set.deletionIndexes[i]->MemoryFootprint();
+		}
+
+		return size;
+	}
+
+	// Get the predictions of a context model for a context, from the set's cache if possible
+	const NextWordEntryT *DictionaryLoader::GetNextWords(DictionarySetT &set, size_t modelIndex, uint32_t word1, uint32_t word2, std::vector<ContextPredictionT> &predictions)
+	{
+		// Contexts without trigram counts predict the same words as the previous word alone, so they share a cache entry
+		const ContextModel &model = *set.contextModels[modelIndex];
+		if (!model.HasContext(word1, word2))
+		{
+			word1 = CONTEXT_NO_WORD;
+		}
+
+		const NextWordEntryT *pEntry = set.nextWordCache.Find(modelIndex, word1, word2);
+		if (pEntry == NULL)
+		{
+			model.Predict(word1, word2, MAX_NATIVE_PREDICTIONS, predictions);
+			pEntry = set.nextWordCache.Add(modelIndex, word1, word2, predictions);
+		}
+
+		return pEntry;
+	}
@@ -0,0 +1,87 @@
+#pragma once
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include "Lexicon.h"
+#include "DeletionIndex.h"
+#include "ContextModel.h"
+#include "NextWordCache.h"
+#include "PhraseIndex.h"
+#include "AmbiguousIndex.h"
+
+	// The native structures built from the active dictionaries, which are loaded and replaced together
+	struct DictionarySetT
+	{
+		Lexicon lexicon;
+		std::vector<std::unique_ptr<DeletionIndex>> deletionIndexes;
+		std::vector<std::unique_ptr<ContextModel>> contextModels;
+		NextWordCache nextWordCache;
+		PhraseIndex phraseIndex;
+		AmbiguousIndex ambiguousIndex;
+	};
+
+	// What to build a dictionary set from
+	struct DictionaryRequestT
+	{
+		std::wstring basePath;
+		std::wstring dictList;
+		uint32_t indexMaxDistance;
+		uint32_t indexPrefixLength;
+		std::vector<std::wstring> keyGroups;
+	};
+
+	// Builds dictionary sets on a background thread, so that suggestions carry on from the live set while the dictionaries change.
+	// A finished set is published through an atomic pointer for the engine to swap in between requests. Only the latest request
+	// is published, and a set that is superseded before it is taken is discarded. The engine hands back the sets it replaces,
+	// once no request can still be using them, and they are freed on the background thread too.
+	class DictionaryLoader
+	{
+	private:
+		std::thread _thread;
+		std::mutex _mutex;
+		std::condition_variable _changed;
+		DictionaryRequestT _request;
+		uint32_t _requested;		// Number of the latest load requested
+		uint32_t _finished;			// Number of the latest load finished
+		bool _isStopping;
+		std::vector<DictionarySetT *> _retired;
+		std::atomic<DictionarySetT *> _pLoaded;
+
+	public:
+		DictionaryLoader(void);
+		~DictionaryLoader(void);
+
+		void Start(const DictionaryRequestT &request);
+		void Stop(void);
+		DictionarySetT *TakeLoaded(void) { return _pLoaded.exchange(NULL); }
+		void Retire(DictionarySetT *pSet);
+
+		static void LoadDeletionIndexes(const DictionaryRequestT &request, DictionarySetT &set);
+		static size_t GetDeletionIndexSize(const DictionarySetT &set);
+		static const NextWordEntryT *GetNextWords(DictionarySetT &set, size_t modelIndex, uint32_t word1, uint32_t word2, std::vector<ContextPredictionT> &predictions);
+
+	private:
+		void Run(void);
+		bool IsCancelled(uint32_t number);
+		bool Load(const DictionaryRequestT &request, uint32_t number, DictionarySetT &set);
+		static void LoadContextModels(const DictionaryRequestT &request, DictionarySetT &set);
+	};
@@ -0,0 +1,422 @@
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+#include "stdafx.h"
+#include <intrin.h>
+#include <immintrin.h>
+#include <algorithm>
+#include "EditDistance.h"
+
+	// Constructor
+	EditDistance::EditDistance(void)
+	{
+		_transpositions = false;
+		_otherCount = 0;
+		memset(_asciiMasks, 0, sizeof(_asciiMasks));
+		_simdLevel = DetectSimdLevel();
+	}
+
+	// Destructor
+	EditDistance::~EditDistance(void)
+	{
+	}
+
+	// Choose the batch kernel, never above the level that the processor and operating system support
+	void EditDistance::SetSimdLevel(EditSimdLevelT level)
+	{
+		EditSimdLevelT supported = DetectSimdLevel();
+		_simdLevel = (level < supported) ? level : supported;
+	}
+
+	// Set the string that candidates are compared with, optionally counting adjacent transpositions as one edit (Damerau)
+	// Returns false if the pattern is too long for the bit-parallel kernel, in which case the DP is used instead
+	bool EditDistance::SetPattern(const KPTUniCharT *pattern, size_t length, bool transpositions)
+	{
+		// Clear the masks of the previous pattern
+		size_t i;
+		for (i = 0; i < _pattern.size() && i < EDIT_MAX_PATTERN_LEN; i++)
+		{
+			if (_pattern[i] < EDIT_ASCII_SIZE)
+			{
+				_asciiMasks[_pattern[i]] = 0;
+			}
+		}
+		_otherCount = 0;
+
+		_pattern.assign(pattern, pattern + length);
+		_transpositions = transpositions;
+		if (length > EDIT_MAX_PATTERN_LEN)
+		{
+			return false;
+		}
+
+		// Set bit i of the mask for each character at position i of the pattern
+		for (i = 0; i < length; i++)
+		{
+			KPTUniCharT ch = pattern[i];
+			if (ch < EDIT_ASCII_SIZE)
+			{
+				_asciiMasks[ch] |= (uint64_t)1 << i;
+			}
+			else
+			{
+				size_t j = 0;
+				while (j < _otherCount && _otherChars[j] != ch)
+				{
+					j++;
+				}
+				if (j == _otherCount)
+				{
+					_otherChars[j] = ch;
+					_otherMasks[j] = 0;
+					_otherCount++;
+				}
+				_otherMasks[j] |= (uint64_t)1 << i;
+			}
+		}
+
+		return true;
+	}
+
+	// Get the positions in the pattern where a character occurs
+	uint64_t EditDistance::MatchMask(KPTUniCharT ch) const
+	{
+		if (ch < EDIT_ASCII_SIZE)
+		{
+			return _asciiMasks[ch];
+		}
+
+		for (size_t j = 0; j < _otherCount; j++)
+		{
+			if (_otherChars[j] == ch)
+			{
+				return _otherMasks[j];
+			}
+		}
+
+		return 0;
+	}
+
+	// Get the edit distance between the pattern and a text, and optionally the lowest distance to a prefix of the text
+	uint32_t EditDistance::Distance(const KPTUniCharT *text, size_t length, uint32_t *pPrefixDistance) const
+	{
+		size_t m = _pattern.size();
+		if (m == 0 || m > EDIT_MAX_PATTERN_LEN)
+		{
+			return DistanceDP(_pattern.data(), m, text, length, _transpositions, pPrefixDistance);
+		}
+
+		uint64_t vp = ~(uint64_t)0;
+		uint64_t vn = 0;
+		uint64_t d0Prev = 0;
+		uint64_t eqPrev = 0;
+		uint64_t lastBit = (uint64_t)1 << (m - 1);
+		uint32_t score = (uint32_t)m;
+		uint32_t best = score;
+
+		for (size_t j = 0; j < length; j++)
+		{
+			uint64_t eq = MatchMask(text[j]);
+			uint64_t x = eq | vn;
+			uint64_t d0 = (((eq & vp) + vp) ^ vp) | x;
+			if (_transpositions)
+			{
+				d0 |= ((~d0Prev & eq) << 1) & eqPrev;
+			}
+			uint64_t hn = vp & d0;
+			uint64_t hp = vn | ~(vp | d0);
+
+			if (hp & lastBit)
+			{
+				score++;
+			}
+			else if (hn & lastBit)
+			{
+				score--;
+			}
+			best = (std::min)(best, score);
+
+			x = (hp << 1) | 1;
+			vn = x & d0;
+			vp = (hn << 1) | ~(x | d0);
+			d0Prev = d0;
+			eqPrev = eq;
+		}
+
+		if (pPrefixDistance != NULL)
+		{
+			*pPrefixDistance = best;
+		}
+
+		return score;
+	}
+
+	// Get the edit distances between the pattern and a batch of texts
+	void EditDistance::DistanceBatch(const KPTUniCharT *const *texts, const size_t *lengths, size_t count, uint32_t *distances, uint32_t *prefixDistances)
+	{
+		size_t m = _pattern.size();
+		if (_simdLevel == eEditSimdNone || m == 0 || m > EDIT_MAX_PATTERN_LEN)
+		{
+			for (size_t i = 0; i < count; i++)
+			{
+				distances[i] = Distance(texts[i], lengths[i], &prefixDistances[i]);
+			}
+			return;
+		}
+
+		uint32_t batchDistances[EDIT_BATCH_SIZE];
+		uint32_t batchPrefixDistances[EDIT_BATCH_SIZE];
+		for (size_t start = 0; start < count; start += EDIT_BATCH_SIZE)
+		{
+			size_t batchCount = (std::min)((size_t)EDIT_BATCH_SIZE, count - start);
+			size_t maxLength = 0;
+			for (size_t i = 0; i < batchCount; i++)
+			{
+				maxLength = (std::max)(maxLength, lengths[start + i]);
+			}
+
+			GatherBatch(texts + start, lengths + start, batchCount, maxLength);
+			if (_simdLevel == eEditSimdAVX2)
+			{
+				DistanceBatchAVX2(maxLength, batchDistances, batchPrefixDistances);
+			}
+			else
+			{
+				DistanceBatchSSE41(maxLength, batchDistances, batchPrefixDistances);
+			}
+
+			for (size_t i = 0; i < batchCount; i++)
+			{
+				distances[start + i] = batchDistances[i];
+				prefixDistances[start + i] = batchPrefixDistances[i];
+			}
+		}
+	}
+
+	// Look up the match masks for each character of a batch of texts, interleaved by lane
+	// Lanes beyond the end of their text are marked inactive so that their scores stop changing
+	void EditDistance::GatherBatch(const KPTUniCharT *const *texts, const size_t *lengths, size_t count, size_t maxLength)
+	{
+		_eqBuffer.assign(maxLength * EDIT_BATCH_SIZE, 0);
+		_activeBuffer.assign(maxLength * EDIT_BATCH_SIZE, 0);
+
+		for (size_t lane = 0; lane < count; lane++)
+		{
+			const KPTUniCharT *text = texts[lane];
+			for (size_t j = 0; j < lengths[lane]; j++)
+			{
+				_eqBuffer[j * EDIT_BATCH_SIZE + lane] = MatchMask(text[j]);
+				_activeBuffer[j * EDIT_BATCH_SIZE + lane] = ~(uint64_t)0;
+			}
+		}
+	}
+
+	// Score a gathered batch using SSE4.1, two lanes per register
+	void EditDistance::DistanceBatchSSE41(size_t maxLength, uint32_t *distances, uint32_t *prefixDistances) const
+	{
+		const size_t numRegs = EDIT_BATCH_SIZE / 2;
+		size_t m = _pattern.size();
+		const __m128i allOnes = _mm_set1_epi64x(-1);
+		const __m128i one = _mm_set1_epi64x(1);
+		const __m128i lastShift = _mm_cvtsi32_si128((int)m - 1);
+
+		__m128i vp[numRegs], vn[numRegs], d0Prev[numRegs], eqPrev[numRegs], score[numRegs], best[numRegs];
+		size_t r;
+		for (r = 0; r < numRegs; r++)
+		{
+			vp[r] = allOnes;
+			vn[r] = _mm_setzero_si128();
+			d0Prev[r] = _mm_setzero_si128();
+			eqPrev[r] = _mm_setzero_si128();
+			score[r] = _mm_set1_epi64x((long long)m);
+			best[r] = score[r];
+		}
+
+		for (size_t j = 0; j < maxLength; j++)
+		{
+			const uint64_t *pEq = &_eqBuffer[j * EDIT_BATCH_SIZE];
+			const uint64_t *pActive = &_activeBuffer[j * EDIT_BATCH_SIZE];
+			for (r = 0; r < numRegs; r++)
+			{
+				__m128i eq = _mm_loadu_si128((const __m128i *)(pEq + 2 * r));
+				__m128i active = _mm_loadu_si128((const __m128i *)(pActive + 2 * r));
+				__m128i x = _mm_or_si128(eq, vn[r]);
+				__m128i d0 = _mm_or_si128(_mm_xor_si128(_mm_add_epi64(_mm_and_si128(eq, vp[r]), vp[r]), vp[r]), x);
+				if (_transpositions)
+				{
+					d0 = _mm_or_si128(d0, _mm_and_si128(_mm_slli_epi64(_mm_andnot_si128(d0Prev[r], eq), 1), eqPrev[r]));
+				}
+				__m128i hn = _mm_and_si128(vp[r], d0);
+				__m128i hp = _mm_or_si128(vn[r], _mm_xor_si128(_mm_or_si128(vp[r], d0), allOnes));
+
+				// Scores are small and non-negative so a 32-bit min works on the 64-bit lanes
+				__m128i inc = _mm_and_si128(_mm_and_si128(_mm_srl_epi64(hp, lastShift), one), active);
+				__m128i dec = _mm_and_si128(_mm_and_si128(_mm_srl_epi64(hn, lastShift), one), active);
+				score[r] = _mm_sub_epi64(_mm_add_epi64(score[r], inc), dec);
+				best[r] = _mm_min_epi32(best[r], score[r]);
+
+				x = _mm_or_si128(_mm_slli_epi64(hp, 1), one);
+				vn[r] = _mm_and_si128(x, d0);
+				vp[r] = _mm_or_si128(_mm_slli_epi64(hn, 1), _mm_xor_si128(_mm_or_si128(x, d0), allOnes));
+				d0Prev[r] = d0;
+				eqPrev[r] = eq;
+			}
+		}
+
+		uint64_t lanes[2];
+		for (r = 0; r < numRegs; r++)
+		{
+			_mm_storeu_si128((__m128i *)lanes, score[r]);
+			distances[2 * r] = (uint32_t)lanes[0];
+			distances[2 * r + 1] = (uint32_t)lanes[1];
+			_mm_storeu_si128((__m128i *)lanes, best[r]);
+			prefixDistances[2 * r] = (uint32_t)lanes[0];
+			prefixDistances[2 * r + 1] = (uint32_t)lanes[1];
+		}
+	}
+
+	// Score a gathered batch using AVX2, four lanes per register
+	void EditDistance::DistanceBatchAVX2(size_t maxLength, uint32_t *distances, uint32_t *prefixDistances) const
+	{
+		const size_t numRegs = EDIT_BATCH_SIZE / 4;
+		size_t m = _pattern.size();
+		const __m256i allOnes = _mm256_set1_epi64x(-1);
+		const __m256i one = _mm256_set1_epi64x(1);
+		const __m128i lastShift = _mm_cvtsi32_si128((int)m - 1);
+
+		__m256i vp[numRegs], vn[numRegs], d0Prev[numRegs], eqPrev[numRegs], score[numRegs], best[numRegs];
+		size_t r;
+		for (r = 0; r < numRegs; r++)
+		{
+			vp[r] = allOnes;
+			vn[r] = _mm256_setzero_si256();
+			d0Prev[r] = _mm256_setzero_si256();
+			eqPrev[r] = _mm256_setzero_si256();
+			score[r] = _mm256_set1_epi64x((long long)m);
+			best[r] = score[r];
+		}
+
+		for (size_t j = 0; j < maxLength; j++)
+		{
+			const uint64_t *pEq = &_eqBuffer[j * EDIT_BATCH_SIZE];
+			const uint64_t *pActive = &_activeBuffer[j * EDIT_BATCH_SIZE];
+			for (r = 0; r < numRegs; r++)
+			{
+				__m256i eq = _mm256_loadu_si256((const __m256i *)(pEq + 4 * r));
+				__m256i active = _mm256_loadu_si256((const __m256i *)(pActive + 4 * r));
+				__m256i x = _mm256_or_si256(eq, vn[r]);
+				__m256i d0 = _mm256_or_si256(_mm256_xor_si256(_mm256_add_epi64(_mm256_and_si256(eq, vp[r]), vp[r]), vp[r]), x);
+				if (_transpositions)
+				{
+					d0 = _mm256_or_si256(d0, _mm256_and_si256(_mm256_slli_epi64(_mm256_andnot_si256(d0Prev[r], eq), 1), eqPrev[r]));
+				}
+				__m256i hn = _mm256_and_si256(vp[r], d0);
+				__m256i hp = _mm256_or_si256(vn[r], _mm256_xor_si256(_mm256_or_si256(vp[r], d0), allOnes));
+
+				__m256i inc = _mm256_and_si256(_mm256_and_si256(_mm256_srl_epi64(hp, lastShift), one), active);
+				__m256i dec = _mm256_and_si256(_mm256_and_si256(_mm256_srl_epi64(hn, lastShift), one), active);
+				score[r] = _mm256_sub_epi64(_mm256_add_epi64(score[r], inc), dec);
+				best[r] = _mm256_min_epi32(best[r], score[r]);
+
+				x = _mm256_or_si256(_mm256_slli_epi64(hp, 1), one);
+				vn[r] = _mm256_and_si256(x, d0);
+				vp[r] = _mm256_or_si256(_mm256_slli_epi64(hn, 1), _mm256_xor_si256(_mm256_or_si256(x, d0), allOnes));
+				d0Prev[r] = d0;
+				eqPrev[r] = eq;
+			}
+		}
+
+		uint64_t lanes[4];
+		size_t lane;
+		for (r = 0; r < numRegs; r++)
+		{
+			_mm256_storeu_si256((__m256i *)lanes, score[r]);
+			for (lane = 0; lane < 4; lane++)
+			{
+				distances[4 * r + lane] = (uint32_t)lanes[lane];
+			}
+			_mm256_storeu_si256((__m256i *)lanes, best[r]);
+			for (lane = 0; lane < 4; lane++)
+			{
+				prefixDistances[4 * r + lane] = (uint32_t)lanes[lane];
+			}
+		}
+	}
+
+	// Reference dynamic programming edit distance (optimal string alignment when transpositions are counted)
+	uint32_t EditDistance::DistanceDP(const KPTUniCharT *pattern, size_t patternLength, const KPTUniCharT *text, size_t textLength, bool transpositions, uint32_t *pPrefixDistance)
+	{
+		// Columns for text positions j-2, j-1 and j
+		std::vector<uint32_t> prev2(patternLength + 1);
+		std::vector<uint32_t> prev(patternLength + 1);
+		std::vector<uint32_t> curr(patternLength + 1);
+		size_t i;
+		for (i = 0; i <= patternLength; i++)
+		{
+			prev[i] = (uint32_t)i;
+		}
+
+		uint32_t best = prev[patternLength];
+		for (size_t j = 1; j <= textLength; j++)
+		{
+			curr[0] = (uint32_t)j;
+			for (i = 1; i <= patternLength; i++)
+			{
+				uint32_t cost = pattern[i - 1] == text[j - 1] ? 0 : 1;
+				curr[i] = (std::min)((std::min)(prev[i] + 1, curr[i - 1] + 1), prev[i - 1] + cost);
+				if (transpositions && i > 1 && j > 1 && pattern[i - 1] == text[j - 2] && pattern[i - 2] == text[j - 1])
+				{
+					curr[i] = (std::min)(curr[i], prev2[i - 2] + 1);
+				}
+			}
+			best = (std::min)(best, curr[patternLength]);
+			prev2.swap(prev);
+			prev.swap(curr);
+		}
+
+		if (pPrefixDistance != NULL)
+		{
+			*pPrefixDistance = best;
+		}
+
+		return prev[patternLength];
+	}
+
+	// Find the best instruction set supported by the processor and operating system
+	EditSimdLevelT EditDistance::DetectSimdLevel(void)
+	{
+		int info[4];
+		__cpuid(info, 0);
+		int maxLeaf = info[0];
+		if (maxLeaf < 1)
+		{
+			return eEditSimdNone;
+		}
+
+		__cpuid(info, 1);
+		bool hasSSE41 = (info[2] & (1 << 19)) != 0;
+		bool hasOSXSave = (info[2] & (1 << 27)) != 0;
+		bool hasAVX = (info[2] & (1 << 28)) != 0;
+
+		// AVX2 needs the OS to save the YMM registers
+		if (hasOSXSave && hasAVX && (_xgetbv(0) & 6) == 6 && maxLeaf >= 7)
+		{
+			__cpuidex(info, 7, 0);
+			if ((info[1] & (1 << 5)) != 0)
+			{
+				return eEditSimdAVX2;
+			}
+		}
+
+		return hasSSE41 ? eEditSimdSSE41 : eEditSimdNone;
+	}
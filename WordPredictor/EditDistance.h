@@ -0,0 +1,68 @@
+#pragma once
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+
+#include <vector>
+#include "kptapi.h"
+
+	#define EDIT_MAX_PATTERN_LEN 64
+	#define EDIT_BATCH_SIZE 16
+	#define EDIT_ASCII_SIZE 128
+
+	// Instruction sets that the batch kernel can use
+	enum EditSimdLevelT
+	{
+		eEditSimdNone = 0,
+		eEditSimdSSE41,
+		eEditSimdAVX2
+	};
+
+	// Bit-parallel (Myers / Hyyro) edit distance between a pattern of up to 64 characters and candidate texts
+	// Each column of the DP matrix is held as bit vectors in a 64-bit word, so a text character costs a handful of
+	// word operations. Batches of candidates are scored together, one candidate per 64-bit SIMD lane.
+	// Both the distance to the whole text and the lowest distance to any prefix of the text are reported,
+	// the latter for scoring completions against a partially typed word.
+	class EditDistance
+	{
+	private:
+		std::vector<KPTUniCharT> _pattern;
+		bool _transpositions;
+		uint64_t _asciiMasks[EDIT_ASCII_SIZE];
+		KPTUniCharT _otherChars[EDIT_MAX_PATTERN_LEN];
+		uint64_t _otherMasks[EDIT_MAX_PATTERN_LEN];
+		size_t _otherCount;
+		EditSimdLevelT _simdLevel;
+		std::vector<uint64_t> _eqBuffer;
+		std::vector<uint64_t> _activeBuffer;
+
+	public:
+		EditDistance(void);
+		~EditDistance(void);
+
+		bool SetPattern(const KPTUniCharT *pattern, size_t length, bool transpositions);
+		void SetSimdLevel(EditSimdLevelT level);
+		EditSimdLevelT GetSimdLevel(void) const { return _simdLevel; }
+
+		uint32_t Distance(const KPTUniCharT *text, size_t length, uint32_t *pPrefixDistance) const;
+		void DistanceBatch(const KPTUniCharT *const *texts, const size_t *lengths, size_t count, uint32_t *distances, uint32_t *prefixDistances);
+
+		static uint32_t DistanceDP(const KPTUniCharT *pattern, size_t patternLength, const KPTUniCharT *text, size_t textLength, bool transpositions, uint32_t *pPrefixDistance);
+		static EditSimdLevelT DetectSimdLevel(void);
+
+	private:
+		uint64_t MatchMask(KPTUniCharT ch) const;
+		void GatherBatch(const KPTUniCharT *const *texts, const size_t *lengths, size_t count, size_t maxLength);
+		void DistanceBatchSSE41(size_t maxLength, uint32_t *distances, uint32_t *prefixDistances) const;
+		void DistanceBatchAVX2(size_t maxLength, uint32_t *distances, uint32_t *prefixDistances) const;
+	};
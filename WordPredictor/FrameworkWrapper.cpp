@@ -461,6 +461,44 @@
 		return result;
 	}
 
+	// Get the active dictionaries as a comma-delimited list in priority order e.g. enggb,frefr,lavlv
+	KPTResultT FrameworkWrapper::DICTIONARY_GETACTIVELIST(KPTUniCharT *dictList, size_t maxLength)
+	{
+		KPTResultT result;
+		KPTDictListAllocT dictionaryList = {0};  // Must initialise all AllocT structures. 
+
+		// Get the list of loaded dictionaries
+		result = (_callKPTFwkRunCmd)(KPTCMD_DICTIONARY_GETLIST, (intptr_t)&dictionaryList, (intptr_t)NULL);
+		if (KPTRESULT_FAILED(result))
+		{
+			return result;
+		}
+
+		// Append the active dictionaries in order of priority
+		size_t dictIndex;
+		size_t priority;
+		dictList[0] = L'\0';
+		for (priority = 0; priority < dictionaryList.count; priority++)
+		{
+			for (dictIndex = 0; dictIndex < dictionaryList.count; dictIndex++)
+			{
+				const KPTDictStateT &dictState = dictionaryList.dictState[dictIndex];
+				if (dictState.dictActive == eKPTTrue && dictState.dictPriority == priority)
+				{
+					if (dictList[0] != L'\0')
+					{
+						wcscat_s(dictList, maxLength, _T(","));
+					}
+					wcscat_s(dictList, maxLength, dictionaryList.dictInfo[dictIndex].dictFileName);
+				}
+			}
+		}
+
+		// Free memory
+		result = (_callKPTFwkReleaseAlloc)(&dictionaryList);
+		return result;
+	}
+
 	// Set the active dictionaries in the given priority order
 	// from a comma-delimited list of dictionary names e.g. enggb,frefr,lavlv
 	KPTResultT FrameworkWrapper::DICTIONARY_SETACTIVELIST(const KPTUniCharT *dictList)
@@ -558,11 +596,9 @@
 	}
 
 	// Get suggestion configuration options
-	KPTResultT FrameworkWrapper::SUGGS_GETCONFIG(void)
+	KPTResultT FrameworkWrapper::SUGGS_GETCONFIG(KPTSuggConfigT &config)
 	{
 		KPTResultT result;
-		KPTSuggConfigT config = {0};
-		KPTSuggConfigT oldConfig = {0};
 
 		// Get the current configuration 
 		config.fieldMask = eKPTSuggsConfigMaskAll;
@@ -571,6 +607,12 @@
 		return result;
 	}
 
+	// Set the suggestion configuration options listed in the field mask
+	KPTResultT FrameworkWrapper::SUGGS_SETCONFIG(const KPTSuggConfigT &config)
+	{
+		return (_callKPTFwkRunCmd)(KPTCMD_SUGGS_SETCONFIG, (intptr_t)&config, 0);
+	}
+
 	// Reset the prediction buffer
 	KPTResultT FrameworkWrapper::INPUTMGR_RESET(void)
 	{
@@ -578,22 +620,25 @@
 	}
 
 	// Insert a character into the prediction buffer
-	KPTResultT FrameworkWrapper::INPUTMGR_INSERTCHAR(KPTUniCharT ch)
+	KPTResultT FrameworkWrapper::INPUTMGR_INSERTCHAR(KPTUniCharT ch, uint32_t attributes, uint32_t id)
 	{
 		KPTInpMgrInsertCharT insertChar = { 0 };
 
 		insertChar.insertChar = ch;
+		insertChar.attributes = attributes;
+		insertChar.id = id;
 		return (_callKPTFwkRunCmd)(KPTCMD_INPUTMGR_INSERTCHAR, (intptr_t)&insertChar, 0);
 	}
 
-	// Insert a string into the prediction buffer
-	KPTResultT FrameworkWrapper::INPUTMGR_INSERTSTRING(const KPTUniCharT *str, size_t numChars)
+	// Insert a string into the prediction buffer, optionally replacing characters before the cursor
+	KPTResultT FrameworkWrapper::INPUTMGR_INSERTSTRING(const KPTUniCharT *str, size_t numChars, size_t numToReplace)
 	{
 		KPTInpMgrInsertStringT stringToInsert = {0};
 
 		// NumChars excludes NULL
 		stringToInsert.insertString = str;
 		stringToInsert.length = numChars;
+		stringToInsert.toRemove.numBeforeCursor = numToReplace;
 		stringToInsert.ids = NULL;
     
 		return (_callKPTFwkRunCmd)(KPTCMD_INPUTMGR_INSERTSTRING, (intptr_t)&stringToInsert, 0);
@@ -616,12 +661,15 @@
 	}
 
 	// Insert the suggestion with the specified index
-	KPTResultT FrameworkWrapper::INPUTMGR_INSERTSUGG(size_t suggestionIndex)
+	KPTResultT FrameworkWrapper::INPUTMGR_INSERTSUGG(size_t suggestionIndex, KPTInpMgrRemoveCharsT &removed, KPTUniCharT *inserted, size_t maxLength)
 	{
 		KPTResultT result;
 
 		KPTInpMgrInsertSuggRequestT suggRequest = {0};
         KPTInpMgrInsertSuggReplyAllocT suggReply = {0};
+		removed.numBeforeCursor = 0;
+		removed.numAfterCursor = 0;
+		inserted[0] = L'\0';
 		if (suggestionIndex < _suggestions.count)
 		{
 			suggRequest.appendSpace = eKPTFalse;
@@ -630,6 +678,16 @@
 
 			result = (_callKPTFwkRunCmd)(KPTCMD_INPUTMGR_INSERTSUGG, (intptr_t)&suggRequest, (intptr_t)&suggReply);
 
+			// Report how the buffer was changed, so that callers can keep their own copy of it in step
+			if (KPTRESULT_ISSUCCESS(result) && suggReply.insertReplyInfo != NULL)
+			{
+				removed = suggReply.insertReplyInfo->charactersRemoved;
+				if (suggReply.insertReplyInfo->modificationString != NULL)
+				{
+					wcsncpy_s(inserted, maxLength, suggReply.insertReplyInfo->modificationString, _TRUNCATE);
+				}
+			}
+
 			(_callKPTFwkReleaseAlloc)(&suggReply);
 		}
 		else
@@ -697,6 +755,47 @@
 		return (_callKPTFwkRunCmd)(KPTCMD_LEARN_SETOPTIONS, (intptr_t)options, NULL);
 	}
 
+	// Learn the words in a buffer of text, possibly as one stage of a multi-phase pass
+	KPTResultT FrameworkWrapper::LEARN_BUFFER(KPTUniCharT *buffer, size_t bufferSize, KPTLearningStageT stage)
+	{
+		KPTLearnBufferT learnBuffer = { 0 };
+		learnBuffer.buffer = buffer;
+		learnBuffer.bufferSize = bufferSize;
+		learnBuffer.stage = stage;
+
+		return (_callKPTFwkRunCmd)(KPTCMD_LEARN_BUFFER, (intptr_t)&learnBuffer, 0);
+	}
+
+	// Get the personal dictionary configuration
+	KPTResultT FrameworkWrapper::PERSONAL_GETCONFIG(KPTPDConfigT &config)
+	{
+		return (_callKPTFwkRunCmd)(KPTCMD_PERSONAL_GETCONFIG, (intptr_t)&config, 0);
+	}
+
+	// Set the personal dictionary configuration
+	KPTResultT FrameworkWrapper::PERSONAL_SETCONFIG(const KPTPDConfigT &config)
+	{
+		return (_callKPTFwkRunCmd)(KPTCMD_PERSONAL_SETCONFIG, (intptr_t)&config, 0);
+	}
+
+	// Add words to the personal dictionary
+	KPTResultT FrameworkWrapper::PERSONAL_ADDWORDS(const KPTPDAddWordsT &addWords)
+	{
+		return (_callKPTFwkRunCmd)(KPTCMD_PERSONAL_ADDWORDS, (intptr_t)&addWords, 0);
+	}
+
+	// Write the personal dictionary to a file
+	KPTResultT FrameworkWrapper::PERSONAL_EXPORTTOFILE(const KPTSysCharT *pFilePath, KPTPDFormatT format)
+	{
+		return (_callKPTFwkRunCmd)(KPTCMD_PERSONAL_EXPORTTOFILE, (intptr_t)pFilePath, (intptr_t)format);
+	}
+
+	// Add the words in a file to the personal dictionary
+	KPTResultT FrameworkWrapper::PERSONAL_IMPORTFROMFILE(const KPTSysCharT *pFilePath, KPTPDFormatT format)
+	{
+		return (_callKPTFwkRunCmd)(KPTCMD_PERSONAL_IMPORTFROMFILE, (intptr_t)pFilePath, (intptr_t)format);
+	}
+
 	// Print out a list
 	void FrameworkWrapper::ShowList(KPTDictListAllocT* aList)
 	{
@@ -23,6 +23,7 @@
 #include "kptapi_suggs.h"
 #include "kptapi_inputmgr.h"
 #include "kptapi_learn.h"
+#include "kptapi_personal.h"
 
 
 	#define OpenAdaptxtDLLName "kptframeworkv2DMD.dll"
@@ -65,18 +66,26 @@
 		KPTResultT COMPONENT_GETAVAILABLE(void);
 		KPTResultT COMPONENT_GETLOADED(void);
 		KPTResultT DICTIONARY_GETLIST(void);	
+		KPTResultT DICTIONARY_GETACTIVELIST(KPTUniCharT *dictList, size_t maxLength);
 		KPTResultT DICTIONARY_SETACTIVELIST(const KPTUniCharT *dictList);
-		KPTResultT SUGGS_GETCONFIG(void);
+		KPTResultT SUGGS_GETCONFIG(KPTSuggConfigT &config);
+		KPTResultT SUGGS_SETCONFIG(const KPTSuggConfigT &config);
 		KPTResultT INPUTMGR_RESET(void);
-		KPTResultT INPUTMGR_INSERTCHAR(KPTUniCharT ch);
-		KPTResultT INPUTMGR_INSERTSTRING(const KPTUniCharT *str, size_t numChars);
+		KPTResultT INPUTMGR_INSERTCHAR(KPTUniCharT ch, uint32_t attributes, uint32_t id);
+		KPTResultT INPUTMGR_INSERTSTRING(const KPTUniCharT *str, size_t numChars, size_t numToReplace);
 		KPTResultT INPUTMGR_MOVECURSOR(KPTInpMgrCursorMoveT moveType, int moveAmount);
 		KPTResultT INPUTMGR_REMOVE(size_t numBefore, size_t numAfter);
-		KPTResultT INPUTMGR_INSERTSUGG(size_t suggestionIndex);
+		KPTResultT INPUTMGR_INSERTSUGG(size_t suggestionIndex, KPTInpMgrRemoveCharsT &removed, KPTUniCharT *inserted, size_t maxLength);
 		KPTResultT INPUTMGR_GETCURRWORD(KPTInpMgrCurrentWordT &currentWord);
 		KPTResultT SUGGS_GETSUGGESTIONS();
 		KPTResultT LEARN_GETOPTIONS(uint32_t &options);
 		KPTResultT LEARN_SETOPTIONS(uint32_t options);
+		KPTResultT LEARN_BUFFER(KPTUniCharT *buffer, size_t bufferSize, KPTLearningStageT stage);
+		KPTResultT PERSONAL_GETCONFIG(KPTPDConfigT &config);
+		KPTResultT PERSONAL_SETCONFIG(const KPTPDConfigT &config);
+		KPTResultT PERSONAL_ADDWORDS(const KPTPDAddWordsT &addWords);
+		KPTResultT PERSONAL_EXPORTTOFILE(const KPTSysCharT *pFilePath, KPTPDFormatT format);
+		KPTResultT PERSONAL_IMPORTFROMFILE(const KPTSysCharT *pFilePath, KPTPDFormatT format);
 
 	private:
 		void ShowList(KPTDictListAllocT* aList);
@@ -0,0 +1,294 @@
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+#include "stdafx.h"
+#include <algorithm>
+#include "FuzzyMatcher.h"
+
+	// Constructor
+	FuzzyMatcher::FuzzyMatcher(void)
+	{
+		_pLexicon = NULL;
+		_isValid = false;
+		_stamp = 0;
+	}
+
+	// Destructor
+	FuzzyMatcher::~FuzzyMatcher(void)
+	{
+	}
+
+	// Set the lexicon to search
+	void FuzzyMatcher::SetLexicon(const Lexicon *pLexicon)
+	{
+		_pLexicon = pLexicon;
+		_stamp = 0;
+		_nodeStamp.assign(pLexicon != NULL ? pLexicon->NodeCount() : 0, 0);
+		_nodeSlot.assign(_nodeStamp.size(), 0);
+
+		Reset();
+	}
+
+	// Start a new word
+	void FuzzyMatcher::Reset(void)
+	{
+		_word.clear();
+		_states.clear();
+		_levelStart.clear();
+		_isValid = false;
+
+		if (_pLexicon != NULL && _pLexicon->IsLoaded())
+		{
+			// Nodes within the maximum distance of the root match the empty word by insertion
+			BeginLevel();
+			AddState(LEXICON_ROOT, 0);
+			CloseLevel();
+			_isValid = true;
+		}
+	}
+
+	// Discard the search state, e.g. when the cursor moves to another word
+	void FuzzyMatcher::Invalidate(void)
+	{
+		_isValid = false;
+	}
+
+	// Extend the search by one character of input
+	void FuzzyMatcher::AppendChar(KPTUniCharT ch)
+	{
+		if (!_isValid)
+		{
+			return;
+		}
+
+		if (_word.size() >= MAX_WORD_LEN)
+		{
+			Invalidate();
+			return;
+		}
+
+		ch = Lexicon::Fold(ch);
+		size_t prevStart = _levelStart.back();
+		size_t prevEnd = _states.size();
+
+		BeginLevel();
+		for (size_t i = prevStart; i < prevEnd; i++)
+		{
+			FuzzyStateT state = _states[i];
+
+			// Input character not in the word
+			if (state.distance < FUZZY_MAX_EDIT_DISTANCE)
+			{
+				AddState(state.nodeIndex, state.distance + 1);
+			}
+
+			// Input character matches or substitutes the next character of the word
+			const LexiconNodeT &node = _pLexicon->GetNode(state.nodeIndex);
+			for (uint32_t child = node.firstChild; child < node.firstChild + node.childCount; child++)
+			{
+				uint32_t distance = state.distance + (_pLexicon->GetNode(child).ch == ch ? 0 : 1);
+				if (distance <= FUZZY_MAX_EDIT_DISTANCE)
+				{
+					AddState(child, distance);
+				}
+			}
+		}
+
+		// Input character swapped with the one before it, which counts as one edit like the rescoring does
+		if (!_word.empty() && _word.back() != ch)
+		{
+			size_t level = _word.size() - 1;
+			for (size_t i = _levelStart[level]; i < _levelStart[level + 1]; i++)
+			{
+				if (_states[i].distance < FUZZY_MAX_EDIT_DISTANCE)
+				{
+					uint32_t swapped = _pLexicon->FindChild(_states[i].nodeIndex, ch);
+					if (swapped != LEXICON_NO_NODE)
+					{
+						swapped = _pLexicon->FindChild(swapped, _word.back());
+						if (swapped != LEXICON_NO_NODE)
+						{
+							AddState(swapped, _states[i].distance + 1);
+						}
+					}
+				}
+			}
+		}
+		CloseLevel();
+
+		_word.push_back(ch);
+	}
+
+	// Pop the search back by the specified number of characters
+	void FuzzyMatcher::RemoveChars(size_t count)
+	{
+		if (!_isValid || count > _word.size())
+		{
+			Invalidate();
+			return;
+		}
+		else if (count == 0)
+		{
+			return;
+		}
+
+		size_t length = _word.size() - count;
+		_word.resize(length);
+		_states.resize(_levelStart[length + 1]);
+		_levelStart.resize(length + 1);
+	}
+
+	// Bring the search into line with the specified word, reusing the frontiers of any common prefix
+	void FuzzyMatcher::Sync(const KPTUniCharT *word, size_t length)
+	{
+		if (!_isValid)
+		{
+			Reset();
+			if (!_isValid)
+			{
+				return;
+			}
+		}
+
+		size_t common = 0;
+		while (common < length && common < _word.size() && Lexicon::Fold(word[common]) == _word[common])
+		{
+			common++;
+		}
+
+		RemoveChars(_word.size() - common);
+		for (size_t i = common; i < length; i++)
+		{
+			AppendChar(word[i]);
+		}
+	}
+
+	// Get the best words within the specified distance of the current input,
+	// either words that match the input as a whole or completions of a prefix that does
+	void FuzzyMatcher::GetCandidates(uint32_t maxDistance, size_t maxCount, std::vector<FuzzyCandidateT> &candidates) const
+	{
+		candidates.clear();
+		if (!_isValid)
+		{
+			return;
+		}
+
+		for (size_t i = _levelStart.back(); i < _states.size(); i++)
+		{
+			const FuzzyStateT &state = _states[i];
+			if (state.distance <= maxDistance)
+			{
+				const LexiconNodeT &node = _pLexicon->GetNode(state.nodeIndex);
+				if (node.wordId != LEXICON_NO_WORD)
+				{
+					FuzzyCandidateT candidate = { node.wordId, state.distance };
+					candidates.push_back(candidate);
+				}
+				if (node.bestWordId != node.wordId)
+				{
+					FuzzyCandidateT candidate = { node.bestWordId, state.distance };
+					candidates.push_back(candidate);
+				}
+			}
+		}
+
+		// Keep the closest match for each word
+		std::sort(candidates.begin(), candidates.end(), [](const FuzzyCandidateT &a, const FuzzyCandidateT &b)
+		{
+			return a.wordId != b.wordId ? a.wordId < b.wordId : a.distance < b.distance;
+		});
+		candidates.erase(std::unique(candidates.begin(), candidates.end(), [](const FuzzyCandidateT &a, const FuzzyCandidateT &b)
+		{
+			return a.wordId == b.wordId;
+		}), candidates.end());
+
+		RankCandidates(candidates);
+
+		if (candidates.size() > maxCount)
+		{
+			candidates.resize(maxCount);
+		}
+	}
+
+	// Sort candidates by distance, then dictionary priority, then frequency
+	void FuzzyMatcher::RankCandidates(std::vector<FuzzyCandidateT> &candidates) const
+	{
+		const Lexicon *pLexicon = _pLexicon;
+		std::sort(candidates.begin(), candidates.end(), [pLexicon](const FuzzyCandidateT &a, const FuzzyCandidateT &b)
+		{
+			if (a.distance != b.distance)
+			{
+				return a.distance < b.distance;
+			}
+			const LexiconWordT &wordA = pLexicon->GetWord(a.wordId);
+			const LexiconWordT &wordB = pLexicon->GetWord(b.wordId);
+			if (wordA.priority != wordB.priority)
+			{
+				return wordA.priority < wordB.priority;
+			}
+			return wordA.frequency > wordB.frequency;
+		});
+	}
+
+	// Start the frontier for the next character
+	void FuzzyMatcher::BeginLevel(void)
+	{
+		_levelStart.push_back(_states.size());
+
+		if (++_stamp == 0)
+		{
+			std::fill(_nodeStamp.begin(), _nodeStamp.end(), 0);
+			_stamp = 1;
+		}
+	}
+
+	// Add a node to the current frontier, keeping the lowest distance if it is already present
+	void FuzzyMatcher::AddState(uint32_t nodeIndex, uint32_t distance)
+	{
+		if (_nodeStamp[nodeIndex] == _stamp)
+		{
+			FuzzyStateT &state = _states[_nodeSlot[nodeIndex]];
+			if (distance < state.distance)
+			{
+				state.distance = distance;
+			}
+		}
+		else
+		{
+			_nodeStamp[nodeIndex] = _stamp;
+			_nodeSlot[nodeIndex] = (uint32_t)_states.size();
+
+			FuzzyStateT state = { nodeIndex, distance };
+			_states.push_back(state);
+		}
+	}
+
+	// Add the nodes reachable by inserting characters that weren't typed, in order of increasing distance
+	void FuzzyMatcher::CloseLevel(void)
+	{
+		size_t levelStart = _levelStart.back();
+		for (uint32_t distance = 0; distance < FUZZY_MAX_EDIT_DISTANCE; distance++)
+		{
+			for (size_t i = levelStart; i < _states.size(); i++)
+			{
+				if (_states[i].distance == distance)
+				{
+					const LexiconNodeT &node = _pLexicon->GetNode(_states[i].nodeIndex);
+					for (uint32_t child = node.firstChild; child < node.firstChild + node.childCount; child++)
+					{
+						AddState(child, distance + 1);
+					}
+				}
+			}
+		}
+	}
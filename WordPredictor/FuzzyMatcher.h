@@ -0,0 +1,69 @@
+#pragma once
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+
+#include <vector>
+#include "Lexicon.h"
+
+	// A trie node reached by the search, with the edit distance between the input and the node's prefix
+	struct FuzzyStateT
+	{
+		uint32_t nodeIndex;
+		uint32_t distance;
+	};
+
+	// A word found by the search
+	struct FuzzyCandidateT
+	{
+		uint32_t wordId;
+		uint32_t distance;
+	};
+
+	// Incremental error-tolerant search of the lexicon trie
+	// Distances are optimal string alignment distances, so swapping two adjacent characters counts as one edit.
+	// The frontier of trie nodes within the maximum edit distance is kept for every character of the current word,
+	// so that typing a character extends the previous frontier and backspacing pops back to an earlier one
+	class FuzzyMatcher
+	{
+	private:
+		const Lexicon *_pLexicon;
+		bool _isValid;
+		std::vector<KPTUniCharT> _word;
+		std::vector<FuzzyStateT> _states;
+		std::vector<size_t> _levelStart;
+		std::vector<uint32_t> _nodeStamp;
+		std::vector<uint32_t> _nodeSlot;
+		uint32_t _stamp;
+
+	public:
+		FuzzyMatcher(void);
+		~FuzzyMatcher(void);
+
+		void SetLexicon(const Lexicon *pLexicon);
+		void Reset(void);
+		void Invalidate(void);
+		bool IsValid(void) const { return _isValid; }
+		size_t Length(void) const { return _word.size(); }
+
+		void AppendChar(KPTUniCharT ch);
+		void RemoveChars(size_t count);
+		void Sync(const KPTUniCharT *word, size_t length);
+		void GetCandidates(uint32_t maxDistance, size_t maxCount, std::vector<FuzzyCandidateT> &candidates) const;
+		void RankCandidates(std::vector<FuzzyCandidateT> &candidates) const;
+
+	private:
+		void BeginLevel(void);
+		void AddState(uint32_t nodeIndex, uint32_t distance);
+		void CloseLevel(void);
+	};
@@ -0,0 +1,190 @@
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+#include "stdafx.h"
+#include "GapBuffer.h"
+
+	// Constructor
+	GapBuffer::GapBuffer(void)
+	{
+		Clear();
+	}
+
+	// Destructor
+	GapBuffer::~GapBuffer(void)
+	{
+	}
+
+	// Remove all the text
+	void GapBuffer::Clear(void)
+	{
+		_buffer.assign(MIN_INPUT_GAP_SIZE, L'\0');
+		_gapStart = 0;
+		_gapEnd = _buffer.size();
+		_origin = 0;
+		_discardedAfter = 0;
+	}
+
+	// Get the character at a position, which must be between Start() and End()
+	KPTUniCharT GapBuffer::CharAt(size_t position) const
+	{
+		size_t index = position - _origin;
+
+		return index < _gapStart ? _buffer[index] : _buffer[index + _gapEnd - _gapStart];
+	}
+
+	// Copy part of the text, which must be between Start() and End()
+	void GapBuffer::GetText(size_t position, size_t length, std::wstring &text) const
+	{
+		text.clear();
+		size_t index = position - _origin;
+		if (index < _gapStart)
+		{
+			size_t count = (std::min)(length, _gapStart - index);
+			text.append(&_buffer[index], count);
+			index += count;
+			length -= count;
+		}
+		if (length > 0)
+		{
+			text.append(&_buffer[index + _gapEnd - _gapStart], length);
+		}
+	}
+
+	// Insert characters at the cursor, leaving the cursor after them
+	void GapBuffer::Insert(const KPTUniCharT *str, size_t numChars)
+	{
+		if (_gapEnd - _gapStart < numChars)
+		{
+			WidenGap(numChars);
+		}
+
+		memcpy(&_buffer[_gapStart], str, numChars * sizeof(KPTUniCharT));
+		_gapStart += numChars;
+		if (_gapStart > 2 * INPUT_RETENTION_WINDOW)
+		{
+			Trim();
+		}
+	}
+
+	// Remove characters before the cursor and return how many were removed
+	// Removing discarded characters just shifts the positions of the characters held
+	size_t GapBuffer::RemoveBefore(size_t numChars)
+	{
+		numChars = (std::min)(numChars, Cursor());
+		size_t heldCount = (std::min)(numChars, _gapStart);
+		_gapStart -= heldCount;
+		_origin -= numChars - heldCount;
+
+		return numChars;
+	}
+
+	// Remove characters after the cursor and return how many were removed
+	size_t GapBuffer::RemoveAfter(size_t numChars)
+	{
+		size_t heldCount = (std::min)(numChars, _buffer.size() - _gapEnd);
+		size_t discardedCount = (std::min)(numChars - heldCount, _discardedAfter);
+		_gapEnd += heldCount;
+		_discardedAfter -= discardedCount;
+
+		return heldCount + discardedCount;
+	}
+
+	// Move the cursor to a position in the text
+	// The characters between the old and new positions are moved across the gap, so a move costs its distance
+	void GapBuffer::MoveCursor(size_t position)
+	{
+		position = (std::min)(position, Length());
+		if (position < _origin || position > End())
+		{
+			size_t length = Length();
+			_gapStart = 0;
+			_gapEnd = _buffer.size();
+			_origin = position;
+			_discardedAfter = length - position;
+			return;
+		}
+
+		size_t index = position - _origin;
+		if (index < _gapStart)
+		{
+			size_t count = _gapStart - index;
+			memmove(&_buffer[_gapEnd - count], &_buffer[index], count * sizeof(KPTUniCharT));
+			_gapStart -= count;
+			_gapEnd -= count;
+		}
+		else if (index > _gapStart)
+		{
+			size_t count = index - _gapStart;
+			memmove(&_buffer[_gapStart], &_buffer[_gapEnd], count * sizeof(KPTUniCharT));
+			_gapStart += count;
+			_gapEnd += count;
+		}
+
+		if (_buffer.size() - _gapEnd > 2 * INPUT_RETENTION_WINDOW)
+		{
+			Trim();
+		}
+	}
+
+	// Make room in the gap for at least the specified number of characters
+	void GapBuffer::WidenGap(size_t numChars)
+	{
+		Resize((std::max)(2 * _buffer.size(), _buffer.size() + numChars + MIN_INPUT_GAP_SIZE));
+	}
+
+	// Reallocate the buffer with a different size of gap, which must be big enough for the characters held
+	void GapBuffer::Resize(size_t newSize)
+	{
+		size_t afterCount = _buffer.size() - _gapEnd;
+		std::vector<KPTUniCharT> buffer(newSize);
+		if (_gapStart > 0)
+		{
+			memcpy(&buffer[0], &_buffer[0], _gapStart * sizeof(KPTUniCharT));
+		}
+		if (afterCount > 0)
+		{
+			memcpy(&buffer[newSize - afterCount], &_buffer[_gapEnd], afterCount * sizeof(KPTUniCharT));
+		}
+		_buffer.swap(buffer);
+		_gapEnd = newSize - afterCount;
+	}
+
+	// Discard characters that are further than the retention window from the cursor
+	void GapBuffer::Trim(void)
+	{
+		if (_gapStart > INPUT_RETENTION_WINDOW)
+		{
+			size_t count = _gapStart - INPUT_RETENTION_WINDOW;
+			memmove(&_buffer[0], &_buffer[count], INPUT_RETENTION_WINDOW * sizeof(KPTUniCharT));
+			_gapStart -= count;
+			_origin += count;
+		}
+
+		size_t afterCount = _buffer.size() - _gapEnd;
+		if (afterCount > INPUT_RETENTION_WINDOW)
+		{
+			// Shrink the text after the gap by widening the gap
+			size_t count = afterCount - INPUT_RETENTION_WINDOW;
+			memmove(&_buffer[_gapEnd + count], &_buffer[_gapEnd], INPUT_RETENTION_WINDOW * sizeof(KPTUniCharT));
+			_gapEnd += count;
+			_discardedAfter += count;
+		}
+
+		// Release the memory of a gap that has grown much wider than the characters held, e.g. after a long paste
+		size_t maxSize = 2 * INPUT_RETENTION_WINDOW + MIN_INPUT_GAP_SIZE;
+		if (_buffer.size() > maxSize)
+		{
+			Resize(maxSize);
+		}
+	}
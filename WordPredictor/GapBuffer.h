@@ -0,0 +1,58 @@
+#pragma once
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+
+#include <string>
+#include <vector>
+#include "kptapi.h"
+
+	// UTF-16 text with a gap at the cursor, so that inserting, removing and moving by one character take constant time
+	// Only INPUT_RETENTION_WINDOW characters either side of the cursor are kept. Once more than twice that many build up
+	// on one side, the furthest are discarded and a buffer that has grown beyond what is held is shrunk, so memory stays
+	// bounded and the cost of discarding is spread over the characters typed. Positions are counted from the start of the whole text, including discarded characters, so
+	// Start() is the position of the first character that is still held and positions stay in step with the client's
+	// buffer. Moving the cursor outside the characters held discards them all, since the text there isn't known.
+	class GapBuffer
+	{
+	private:
+		std::vector<KPTUniCharT> _buffer;
+		size_t _gapStart;			// Index in the buffer of the start of the gap, which is the cursor
+		size_t _gapEnd;				// Index in the buffer of the first character after the gap
+		size_t _origin;				// Number of characters discarded from the start of the text
+		size_t _discardedAfter;		// Number of characters discarded from the end of the text
+
+	public:
+		GapBuffer(void);
+		~GapBuffer(void);
+
+		void Clear(void);
+
+		size_t Start(void) const { return _origin; }
+		size_t End(void) const { return _origin + _buffer.size() - (_gapEnd - _gapStart); }
+		size_t Cursor(void) const { return _origin + _gapStart; }
+		size_t Length(void) const { return End() + _discardedAfter; }
+		size_t MemoryFootprint(void) const { return _buffer.capacity() * sizeof(KPTUniCharT); }
+		KPTUniCharT CharAt(size_t position) const;
+		void GetText(size_t position, size_t length, std::wstring &text) const;
+
+		void Insert(const KPTUniCharT *str, size_t numChars);
+		size_t RemoveBefore(size_t numChars);
+		size_t RemoveAfter(size_t numChars);
+		void MoveCursor(size_t position);
+
+	private:
+		void WidenGap(size_t numChars);
+		void Resize(size_t newSize);
+		void Trim(void);
+	};
@@ -0,0 +1,234 @@
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+#include "stdafx.h"
+#include "Lexicon.h"
+#include "InputTokenizer.h"
+
+	// Constructor
+	InputTokenizer::InputTokenizer(void)
+	{
+		Reset();
+	}
+
+	// Destructor
+	InputTokenizer::~InputTokenizer(void)
+	{
+	}
+
+	// Clear the buffer
+	void InputTokenizer::Reset(void)
+	{
+		_text.Clear();
+		_isValid = true;
+		_prefixStart = 0;
+		_contextCount = 0;
+		_isSentenceStart = true;
+	}
+
+	// Insert a string at the cursor
+	void InputTokenizer::InsertString(const KPTUniCharT *str, size_t numChars)
+	{
+		size_t cursor = _text.Cursor();
+		_text.Insert(str, numChars);
+
+		// The text before the cursor only grows, so the token state can be carried forward a character at a time
+		for (size_t i = 0; i < numChars && _isValid; i++)
+		{
+			size_t position = cursor + i;
+			if (Lexicon::IsWordChar(str[i]))
+			{
+				continue;
+			}
+
+			if (IsSentenceEnd(str[i]))
+			{
+				_contextCount = 0;
+				_isSentenceStart = true;
+			}
+			else if (position > _prefixStart)
+			{
+				AddContextWord(_prefixStart, position - _prefixStart);
+			}
+			_prefixStart = position + 1;
+		}
+	}
+
+	// Remove characters before and/or after the cursor
+	void InputTokenizer::RemoveChars(size_t numBefore, size_t numAfter)
+	{
+		// Backspacing within the current word keeps the state, anything further changes the context
+		size_t cursor = _text.Cursor();
+		numBefore = _text.RemoveBefore(numBefore);
+		_text.RemoveAfter(numAfter);
+		if (cursor < _prefixStart || numBefore > cursor - _prefixStart)
+		{
+			_isValid = false;
+		}
+	}
+
+	// Move the cursor by a number of characters (negative to move left)
+	void InputTokenizer::MoveCursor(int offset)
+	{
+		size_t cursor = _text.Cursor();
+		if (offset < 0 && (size_t)-offset > cursor)
+		{
+			SetCursor(0);
+		}
+		else
+		{
+			SetCursor(cursor + offset);
+		}
+	}
+
+	// Move the cursor to a position in the buffer
+	void InputTokenizer::SetCursor(size_t position)
+	{
+		// Moving left within the current word keeps the state, anything else means rescanning
+		size_t cursor = _text.Cursor();
+		_text.MoveCursor(position);
+		position = _text.Cursor();
+		if (position < _prefixStart || position > cursor)
+		{
+			_isValid = false;
+		}
+	}
+
+	// Get the number of word characters before the cursor in the current word
+	size_t InputTokenizer::GetPrefixLength(void)
+	{
+		Update();
+
+		return _text.Cursor() - _prefixStart;
+	}
+
+	// Get the part of the current word before the cursor
+	void InputTokenizer::GetPrefix(std::wstring &prefix)
+	{
+		Update();
+		_text.GetText(_prefixStart, _text.Cursor() - _prefixStart, prefix);
+	}
+
+	// Get the number of words before the current one in the same sentence (up to CONTEXT_MAX_WORDS)
+	size_t InputTokenizer::GetContextCount(void)
+	{
+		Update();
+
+		return _contextCount;
+	}
+
+	// Get one of the words before the current one, oldest first
+	void InputTokenizer::GetContextWord(size_t index, std::wstring &word)
+	{
+		Update();
+		_text.GetText(_contextWords[index].start, _contextWords[index].length, word);
+	}
+
+	// See whether the current word is the first in its sentence
+	bool InputTokenizer::IsSentenceStart(void)
+	{
+		Update();
+
+		return _isSentenceStart;
+	}
+
+	// Decide whether a character ends a sentence
+	bool InputTokenizer::IsSentenceEnd(KPTUniCharT ch)
+	{
+		return ch == L'.' || ch == L'!' || ch == L'?' || ch == L'\r' || ch == L'\n';
+	}
+
+	// Bring the token state up to date if it has been invalidated or refers to text that has been discarded
+	void InputTokenizer::Update(void)
+	{
+		if (!_isValid || _prefixStart < _text.Start() || (_contextCount != 0 && _contextWords[0].start < _text.Start()))
+		{
+			Rescan();
+		}
+	}
+
+	// Work out the token state by scanning back from the cursor
+	void InputTokenizer::Rescan(void)
+	{
+		size_t cursor = _text.Cursor();
+		size_t limit = (std::max)(_text.Start(), cursor > CONTEXT_SCAN_LIMIT ? cursor - CONTEXT_SCAN_LIMIT : 0);
+		size_t position = cursor;
+		while (position > limit && Lexicon::IsWordChar(_text.CharAt(position - 1)))
+		{
+			position--;
+		}
+		_prefixStart = position;
+
+		// Collect the preceding words, most recent first, stopping at the start of the sentence
+		TokenSpanT spans[CONTEXT_MAX_WORDS];
+		size_t count = 0;
+		bool isSentenceStart = false;
+		while (count < CONTEXT_MAX_WORDS)
+		{
+			while (position > limit && !Lexicon::IsWordChar(_text.CharAt(position - 1)) && !IsSentenceEnd(_text.CharAt(position - 1)))
+			{
+				position--;
+			}
+			// Characters before the scan limit aren't looked at, and those before Start() have been discarded,
+			// so the context there isn't known
+			if (position == 0 || (position > limit && IsSentenceEnd(_text.CharAt(position - 1))))
+			{
+				isSentenceStart = count == 0;
+				break;
+			}
+			else if (position == limit)
+			{
+				break;
+			}
+
+			// A word that reaches the limit may have been cut short, so it isn't used
+			size_t end = position;
+			while (position > limit && Lexicon::IsWordChar(_text.CharAt(position - 1)))
+			{
+				position--;
+			}
+			if (position == limit && position > 0)
+			{
+				break;
+			}
+			spans[count].start = position;
+			spans[count].length = end - position;
+			count++;
+		}
+
+		_contextCount = 0;
+		while (count > 0)
+		{
+			_contextWords[_contextCount++] = spans[--count];
+		}
+		_isSentenceStart = isSentenceStart;
+		_isValid = true;
+	}
+
+	// Add a completed word to the context, forgetting the oldest if the context is full
+	void InputTokenizer::AddContextWord(size_t start, size_t length)
+	{
+		if (_contextCount == CONTEXT_MAX_WORDS)
+		{
+			for (size_t i = 1; i < CONTEXT_MAX_WORDS; i++)
+			{
+				_contextWords[i - 1] = _contextWords[i];
+			}
+			_contextCount--;
+		}
+
+		_contextWords[_contextCount].start = start;
+		_contextWords[_contextCount].length = length;
+		_contextCount++;
+		_isSentenceStart = false;
+	}
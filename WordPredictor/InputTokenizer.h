@@ -0,0 +1,64 @@
+#pragma once
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+
+#include <string>
+#include "kptapi.h"
+#include "GapBuffer.h"
+
+	// A word in the input buffer
+	struct TokenSpanT
+	{
+		size_t start;
+		size_t length;
+	};
+
+	// Copy of the input buffer that keeps track of the word at the cursor and the words before it in the same sentence
+	// Typing and backspacing within a word update the token state directly. Edits that the state can't follow, such as
+	// moving the cursor to another word, mark it out of date, and it is worked out again on the next query by scanning
+	// back from the cursor over at most CONTEXT_SCAN_LIMIT characters, so neither costs more in a longer document.
+	class InputTokenizer
+	{
+	private:
+		GapBuffer _text;
+		bool _isValid;									// Whether the token state is up to date with the cursor position
+		size_t _prefixStart;							// Start of the word that the cursor is in or at the end of
+		TokenSpanT _contextWords[CONTEXT_MAX_WORDS];	// Preceding words in the same sentence, oldest first
+		size_t _contextCount;
+		bool _isSentenceStart;							// Whether no words precede the current one in its sentence
+
+	public:
+		InputTokenizer(void);
+		~InputTokenizer(void);
+
+		void Reset(void);
+		void InsertString(const KPTUniCharT *str, size_t numChars);
+		void RemoveChars(size_t numBefore, size_t numAfter);
+		void MoveCursor(int offset);
+		void SetCursor(size_t position);
+
+		size_t Cursor(void) const { return _text.Cursor(); }
+		size_t GetPrefixLength(void);
+		void GetPrefix(std::wstring &prefix);
+		size_t GetContextCount(void);
+		void GetContextWord(size_t index, std::wstring &word);
+		bool IsSentenceStart(void);
+
+		static bool IsSentenceEnd(KPTUniCharT ch);
+
+	private:
+		void Update(void);
+		void Rescan(void);
+		void AddContextWord(size_t start, size_t length);
+	};
@@ -0,0 +1,441 @@
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+#include "stdafx.h"
+#include "MappedFile.h"
+#include "LearningLog.h"
+#include "PersonalImage.h"
+
+	// Table for the reflected CRC-32 polynomial
+	struct ChecksumTableT
+	{
+		uint32_t entries[256];
+
+		ChecksumTableT(void)
+		{
+			for (uint32_t i = 0; i < 256; i++)
+			{
+				uint32_t crc = i;
+				for (int bit = 0; bit < 8; bit++)
+				{
+					crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+				}
+				entries[i] = crc;
+			}
+		}
+	};
+
+	// Write a block of data to a file
+	static bool WriteBlock(HANDLE hFile, const void *pData, size_t numBytes)
+	{
+		DWORD written = 0;
+		return WriteFile(hFile, pData, (DWORD)numBytes, &written, NULL) && written == numBytes;
+	}
+
+	// Constructor
+	LearningLog::LearningLog(void)
+	{
+		_hLog = INVALID_HANDLE_VALUE;
+		_generation = 0;
+		_logSize = 0;
+		_pendingCount = 0;
+		_isCompacting = false;
+		_compactFailed = false;
+	}
+
+	// Destructor
+	LearningLog::~LearningLog(void)
+	{
+		Close();
+	}
+
+	// Load the saved personal dictionary, replay the logs written since it was saved, and open the log for appending
+	bool LearningLog::Open(const KPTSysCharT *pBasePath, PersonalDictionary &dictionary)
+	{
+		Close();
+		_basePath = pBasePath;
+		dictionary.Clear();
+
+		KPTSysCharT imagePath[MAX_PATH];
+		KPTSysCharT logPath[MAX_PATH];
+		KPTSysCharT oldLogPath[MAX_PATH];
+		GetFilePath(PD_IMAGE_FILE, imagePath);
+		GetFilePath(PD_LOG_FILE, logPath);
+		GetFilePath(PD_OLD_LOG_FILE, oldLogPath);
+
+		// An old log is only left behind if the last compaction didn't finish, in which case it precedes the current log
+		uint32_t imageGeneration = 0;
+		uint32_t generation = 0;
+		uint64_t validSize = 0;
+		LoadImage(imagePath, dictionary, imageGeneration);
+		bool oldReplayed = ReplayLog(oldLogPath, dictionary, imageGeneration, generation, validSize);
+		uint32_t latestGeneration = oldReplayed ? generation : imageGeneration;
+		bool logReplayed = ReplayLog(logPath, dictionary, latestGeneration, generation, validSize);
+		if (logReplayed)
+		{
+			latestGeneration = generation;
+		}
+
+		bool success;
+		if (oldReplayed)
+		{
+			// Save everything now, because the next compaction would overwrite the old log
+			dictionary.Snapshot(_snapshot);
+			KPTSysCharT tempPath[MAX_PATH];
+			swprintf_s(tempPath, MAX_PATH, _T("%s.tmp"), imagePath);
+			if (PersonalImage::Write(tempPath, _snapshot, latestGeneration) && MappedFile::ReplaceFile(tempPath, imagePath))
+			{
+				DeleteFileW(oldLogPath);
+				success = CreateLog(logPath, latestGeneration + 1);
+			}
+			else
+			{
+				DeleteFileW(tempPath);
+				_compactFailed = true;
+				success = logReplayed ? OpenLog(logPath, latestGeneration, validSize) : CreateLog(logPath, latestGeneration + 1);
+			}
+			_snapshot.words.Clear();
+		}
+		else
+		{
+			DeleteFileW(oldLogPath);
+			success = logReplayed ? OpenLog(logPath, latestGeneration, validSize) : CreateLog(logPath, latestGeneration + 1);
+		}
+
+		TRACE(_T("Loaded %u learned words, log generation %u\n"), (unsigned)dictionary.Count(), _generation);
+
+		return success;
+	}
+
+	// Wait for any compaction to finish and write any pending records
+	void LearningLog::Close(void)
+	{
+		if (_compactThread.joinable())
+		{
+			_compactThread.join();
+		}
+
+		Flush();
+		if (_hLog != INVALID_HANDLE_VALUE)
+		{
+			CloseHandle(_hLog);
+			_hLog = INVALID_HANDLE_VALUE;
+		}
+		_logSize = 0;
+		_compactFailed = false;
+	}
+
+	// Add a learning event to the log, writing the batch out once it is full
+	void LearningLog::Append(const KPTUniCharT *word, size_t length, float delta, uint32_t timestamp)
+	{
+		if (!IsOpen() || length == 0 || length > MAX_WORD_LEN)
+		{
+			return;
+		}
+
+		LearningRecordT record;
+		record.timestamp = timestamp;
+		record.delta = delta;
+		record.length = (uint16_t)length;
+		record.reserved = 0;
+		size_t textBytes = length * sizeof(KPTUniCharT);
+		record.checksum = Checksum(word, textBytes, Checksum((const uint8_t *)&record + sizeof(uint32_t), sizeof(record) - sizeof(uint32_t)));
+
+		const uint8_t *pRecord = (const uint8_t *)&record;
+		const uint8_t *pText = (const uint8_t *)word;
+		_pending.insert(_pending.end(), pRecord, pRecord + sizeof(record));
+		_pending.insert(_pending.end(), pText, pText + textBytes);
+		if (++_pendingCount >= PD_LOG_BATCH)
+		{
+			Flush();
+		}
+	}
+
+	// Write the pending records to the log and flush them to disk
+	void LearningLog::Flush(void)
+	{
+		if (_pending.empty() || !IsOpen())
+		{
+			return;
+		}
+
+		if (WriteBlock(_hLog, _pending.data(), _pending.size()) && FlushFileBuffers(_hLog))
+		{
+			_logSize += _pending.size();
+		}
+		else
+		{
+			TRACE(_T("Couldn't write %u learning records\n"), (unsigned)_pendingCount);
+		}
+		_pending.clear();
+		_pendingCount = 0;
+	}
+
+	// Set the current log aside, start a new one, and save a snapshot of the dictionary as the new image in the background
+	void LearningLog::Compact(PersonalDictionary &dictionary)
+	{
+		if (!IsOpen() || _isCompacting || _compactFailed)
+		{
+			return;
+		}
+		if (_compactThread.joinable())
+		{
+			_compactThread.join();
+		}
+
+		Flush();
+		dictionary.Snapshot(_snapshot);
+
+		KPTSysCharT logPath[MAX_PATH];
+		KPTSysCharT oldLogPath[MAX_PATH];
+		GetFilePath(PD_LOG_FILE, logPath);
+		GetFilePath(PD_OLD_LOG_FILE, oldLogPath);
+		CloseHandle(_hLog);
+		_hLog = INVALID_HANDLE_VALUE;
+
+		uint32_t generation = _generation;
+		if (!MoveFileExW(logPath, oldLogPath, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+		{
+			TRACE(_T("Couldn't set aside learning log %s\n"), logPath);
+			_snapshot.words.Clear();
+			_compactFailed = true;
+			OpenLog(logPath, generation, _logSize);
+			return;
+		}
+		CreateLog(logPath, generation + 1);
+
+		_isCompacting = true;
+		_compactThread = std::thread(&LearningLog::WriteSnapshot, this, generation);
+	}
+
+	// Calculate the CRC-32 of a block of data, continuing from the CRC of any preceding data
+	uint32_t LearningLog::Checksum(const void *pData, size_t numBytes, uint32_t crc)
+	{
+		static const ChecksumTableT table;
+
+		const uint8_t *pBytes = (const uint8_t *)pData;
+		crc = ~crc;
+		for (size_t i = 0; i < numBytes; i++)
+		{
+			crc = table.entries[(crc ^ pBytes[i]) & 0xFF] ^ (crc >> 8);
+		}
+
+		return ~crc;
+	}
+
+	// Get the path of a file in the base path
+	void LearningLog::GetFilePath(const KPTSysCharT *pFileName, KPTSysCharT *pFilePath) const
+	{
+		swprintf_s(pFilePath, MAX_PATH, _T("%s\\%s"), _basePath.c_str(), pFileName);
+	}
+
+	// Load a saved personal dictionary and get the generation of the last log included in it
+	bool LearningLog::LoadImage(const KPTSysCharT *pFilePath, PersonalDictionary &dictionary, uint32_t &generation)
+	{
+		MappedFile file;
+		if (!file.Open(pFilePath) || file.Size() < sizeof(PersonalImageHeaderT))
+		{
+			return false;
+		}
+
+		PersonalImageHeaderT header;
+		memcpy(&header, file.Data(), sizeof(header));
+		if (header.magic == PD_IMAGE_MAGIC && header.version == PD_BLOCKED_IMAGE_VERSION)
+		{
+			file.Close();
+			return LoadBlockedImage(pFilePath, dictionary, generation);
+		}
+
+		// Images saved before the words were stored in blocks
+		const uint8_t *pData = file.Data() + sizeof(header);
+		size_t size = file.Size() - sizeof(header);
+		if (header.magic != PD_IMAGE_MAGIC || header.version != PD_FILE_VERSION || Checksum(pData, size) != header.checksum)
+		{
+			TRACE(_T("Ignoring invalid personal dictionary %s\n"), pFilePath);
+			return false;
+		}
+
+		dictionary.SetClock(header.epoch, header.epochWords);
+		size_t offset = 0;
+		KPTUniCharT word[MAX_WORD_LEN];
+		for (uint32_t i = 0; i < header.wordCount && offset + sizeof(PersonalImageWordT) <= size; i++)
+		{
+			PersonalImageWordT imageWord;
+			memcpy(&imageWord, pData + offset, sizeof(imageWord));
+			offset += sizeof(imageWord);
+			size_t textBytes = imageWord.length * sizeof(KPTUniCharT);
+			if (imageWord.length > MAX_WORD_LEN || offset + textBytes > size)
+			{
+				break;
+			}
+			memcpy(word, pData + offset, textBytes);
+			offset += textBytes;
+
+			dictionary.LoadWord(word, imageWord.length, imageWord.count, imageWord.firstLearned);
+		}
+		generation = header.generation;
+
+		return true;
+	}
+
+	// Load a saved personal dictionary in blocks, skipping any damaged blocks
+	bool LearningLog::LoadBlockedImage(const KPTSysCharT *pFilePath, PersonalDictionary &dictionary, uint32_t &generation)
+	{
+		PersonalImage image;
+		if (!image.Open(pFilePath))
+		{
+			return false;
+		}
+
+		dictionary.SetClock(image.Header().epoch, image.Header().epochWords);
+		std::vector<PersonalImageEntryT> entries;
+		for (size_t block = 0; block < image.BlockCount(); block++)
+		{
+			image.ReadBlock(block, entries);
+			for (size_t i = 0; i < entries.size(); i++)
+			{
+				dictionary.LoadWord(entries[i].text, entries[i].length, entries[i].count, entries[i].firstLearned);
+			}
+		}
+		generation = image.Header().generation;
+
+		return true;
+	}
+
+	// Apply the records of a log that is later than a generation, and get the log's generation and the size of its valid records
+	bool LearningLog::ReplayLog(const KPTSysCharT *pFilePath, PersonalDictionary &dictionary, uint32_t minGeneration, uint32_t &generation, uint64_t &validSize)
+	{
+		MappedFile file;
+		if (!file.Open(pFilePath) || file.Size() < sizeof(LearningLogHeaderT))
+		{
+			return false;
+		}
+
+		LearningLogHeaderT header;
+		memcpy(&header, file.Data(), sizeof(header));
+		if (header.magic != PD_LOG_MAGIC || header.version != PD_FILE_VERSION || header.generation <= minGeneration)
+		{
+			return false;
+		}
+
+		// Stop at the first record that was only partly written
+		const uint8_t *pData = file.Data();
+		size_t size = file.Size();
+		size_t offset = sizeof(header);
+		size_t recordCount = 0;
+		KPTUniCharT word[MAX_WORD_LEN];
+		while (offset + sizeof(LearningRecordT) <= size)
+		{
+			LearningRecordT record;
+			memcpy(&record, pData + offset, sizeof(record));
+			size_t textBytes = record.length * sizeof(KPTUniCharT);
+			if (record.length == 0 || record.length > MAX_WORD_LEN || offset + sizeof(record) + textBytes > size)
+			{
+				break;
+			}
+
+			const uint8_t *pText = pData + offset + sizeof(record);
+			uint32_t checksum = Checksum(pText, textBytes, Checksum((const uint8_t *)&record + sizeof(uint32_t), sizeof(record) - sizeof(uint32_t)));
+			if (checksum != record.checksum)
+			{
+				break;
+			}
+
+			memcpy(word, pText, textBytes);
+			dictionary.AddWord(word, record.length, record.delta, record.timestamp);
+			offset += sizeof(record) + textBytes;
+			recordCount++;
+		}
+
+		if (offset < size)
+		{
+			TRACE(_T("Learning log %s has %u damaged bytes at the end\n"), pFilePath, (unsigned)(size - offset));
+		}
+		TRACE(_T("Replayed %u learning records from %s\n"), (unsigned)recordCount, pFilePath);
+		generation = header.generation;
+		validSize = offset;
+
+		return true;
+	}
+
+	// Open an existing log for appending after its last valid record
+	bool LearningLog::OpenLog(const KPTSysCharT *pFilePath, uint32_t generation, uint64_t validSize)
+	{
+		_hLog = CreateFileW(pFilePath, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (_hLog == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+
+		LARGE_INTEGER position;
+		position.QuadPart = (LONGLONG)validSize;
+		if (!SetFilePointerEx(_hLog, position, NULL, FILE_BEGIN) || !SetEndOfFile(_hLog))
+		{
+			CloseHandle(_hLog);
+			_hLog = INVALID_HANDLE_VALUE;
+			return false;
+		}
+		_generation = generation;
+		_logSize = validSize;
+
+		return true;
+	}
+
+	// Start a new, empty log
+	bool LearningLog::CreateLog(const KPTSysCharT *pFilePath, uint32_t generation)
+	{
+		_hLog = CreateFileW(pFilePath, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (_hLog == INVALID_HANDLE_VALUE)
+		{
+			TRACE(_T("Couldn't create learning log %s\n"), pFilePath);
+			return false;
+		}
+
+		LearningLogHeaderT header = { PD_LOG_MAGIC, PD_FILE_VERSION, generation, 0 };
+		if (!WriteBlock(_hLog, &header, sizeof(header)) || !FlushFileBuffers(_hLog))
+		{
+			CloseHandle(_hLog);
+			_hLog = INVALID_HANDLE_VALUE;
+			return false;
+		}
+		_generation = generation;
+		_logSize = sizeof(header);
+
+		return true;
+	}
+
+	// Compaction thread that writes the snapshot of the dictionary as the new image and then deletes the log it replaces
+	void LearningLog::WriteSnapshot(uint32_t generation)
+	{
+		KPTSysCharT imagePath[MAX_PATH];
+		KPTSysCharT tempPath[MAX_PATH];
+		KPTSysCharT oldLogPath[MAX_PATH];
+		GetFilePath(PD_IMAGE_FILE, imagePath);
+		GetFilePath(PD_OLD_LOG_FILE, oldLogPath);
+		swprintf_s(tempPath, MAX_PATH, _T("%s.tmp"), imagePath);
+
+		// If the image can't be replaced, the old log is kept and replayed at the next startup
+		if (PersonalImage::Write(tempPath, _snapshot, generation) && MappedFile::ReplaceFile(tempPath, imagePath))
+		{
+			DeleteFileW(oldLogPath);
+		}
+		else
+		{
+			TRACE(_T("Couldn't save personal dictionary %s\n"), imagePath);
+			DeleteFileW(tempPath);
+			_compactFailed = true;
+		}
+		_snapshot.words.Clear();
+
+		_isCompacting = false;
+	}
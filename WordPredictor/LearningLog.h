@@ -0,0 +1,110 @@
+#pragma once
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include "PersonalDictionary.h"
+
+	#define PD_LOG_MAGIC 0x474C4450		// "PDLG"
+	#define PD_IMAGE_MAGIC 0x4D494450	// "PDIM"
+	#define PD_FILE_VERSION 1
+
+	// Header at the start of a learning log
+	struct LearningLogHeaderT
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t generation;	// Logs are numbered in the order they were started
+		uint32_t reserved;
+	};
+
+	// A learning event in the log, followed by the word's characters
+	struct LearningRecordT
+	{
+		uint32_t checksum;		// CRC-32 of the rest of the record and the word's characters
+		uint32_t timestamp;		// Time when the word was learned
+		float delta;			// Amount added to the word's count
+		uint16_t length;		// Number of characters in the word
+		uint16_t reserved;
+	};
+
+	// Header at the start of a saved personal dictionary
+	struct PersonalImageHeaderT
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t generation;	// Logs up to and including this generation are included in the image
+		uint32_t checksum;		// CRC-32 of the words that follow the header, or of the block table in a blocked image
+		uint32_t wordCount;
+		uint32_t epochWords;
+		uint16_t epoch;
+		uint16_t reserved;
+	};
+
+	// A word saved in a version 1 image, followed by its characters
+	struct PersonalImageWordT
+	{
+		float count;			// Count as of the saved epoch
+		uint32_t firstLearned;
+		uint16_t length;
+		uint16_t reserved;
+	};
+
+	// Write-ahead log that makes the personal dictionary persistent without rewriting it after each change.
+	// Each learned word is appended to the log as a checksummed record, and records are written and flushed to disk in
+	// batches. At startup the saved image is loaded and the logs written since it was saved are replayed, stopping at
+	// the first damaged record. When the log grows large it is set aside and a new one started, while a background
+	// thread writes a snapshot of the dictionary as the new image and then deletes the old log. Taking the snapshot
+	// doesn't copy the words, so nothing is written to disk on the thread that is handling keystrokes.
+	class LearningLog
+	{
+	private:
+		std::wstring _basePath;
+		HANDLE _hLog;
+		uint32_t _generation;					// Generation of the open log
+		uint64_t _logSize;
+		std::vector<uint8_t> _pending;			// Records not yet written to the log
+		size_t _pendingCount;
+		std::thread _compactThread;
+		std::atomic<bool> _isCompacting;
+		std::atomic<bool> _compactFailed;		// Whether an old log was left behind, so that compaction must wait for a restart
+		PersonalSnapshotT _snapshot;			// Snapshot of the dictionary being written by the compaction thread
+
+	public:
+		LearningLog(void);
+		~LearningLog(void);
+
+		bool Open(const KPTSysCharT *pBasePath, PersonalDictionary &dictionary);
+		void Close(void);
+		bool IsOpen(void) const { return _hLog != INVALID_HANDLE_VALUE; }
+
+		void Append(const KPTUniCharT *word, size_t length, float delta, uint32_t timestamp);
+		void Flush(void);
+		bool NeedsCompaction(void) const { return _logSize >= PD_LOG_COMPACT_SIZE && !_isCompacting && !_compactFailed; }
+		void Compact(PersonalDictionary &dictionary);
+
+		static uint32_t Checksum(const void *pData, size_t numBytes, uint32_t crc = 0);
+
+	private:
+		void GetFilePath(const KPTSysCharT *pFileName, KPTSysCharT *pFilePath) const;
+		bool LoadImage(const KPTSysCharT *pFilePath, PersonalDictionary &dictionary, uint32_t &generation);
+		bool LoadBlockedImage(const KPTSysCharT *pFilePath, PersonalDictionary &dictionary, uint32_t &generation);
+		bool ReplayLog(const KPTSysCharT *pFilePath, PersonalDictionary &dictionary, uint32_t minGeneration, uint32_t &generation, uint64_t &validSize);
+		bool OpenLog(const KPTSysCharT *pFilePath, uint32_t generation, uint64_t validSize);
+		bool CreateLog(const KPTSysCharT *pFilePath, uint32_t generation);
+		void WriteSnapshot(uint32_t generation);
+	};
@@ -0,0 +1,336 @@
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+#include "stdafx.h"
+#include <algorithm>
+#include <wctype.h>
+#include "Lexicon.h"
+
+	// Get the case-folded character at a depth of a word, for building the trie
+	static uint32_t GetWordSymbol(uint32_t wordId, size_t depth, intptr_t context)
+	{
+		const Lexicon *pLexicon = (const Lexicon *)context;
+
+		return depth < pLexicon->GetWord(wordId).length ? Lexicon::Fold(pLexicon->GetText(wordId)[depth]) : SORTED_TRIE_END;
+	}
+
+	// Constructor
+	Lexicon::Lexicon(void)
+	{
+	}
+
+	// Destructor
+	Lexicon::~Lexicon(void)
+	{
+	}
+
+	// Load the word lists for a comma-delimited list of dictionaries in priority order e.g. enggb,frefr
+	bool Lexicon::Load(const KPTSysCharT *pBasePath, const KPTUniCharT *dictList)
+	{
+		Clear();
+
+		// Copy token list string into modifiable string
+		KPTUniCharT *nextToken;
+		KPTUniCharT dictListCopy[MAX_STR_LEN];
+		wcsncpy_s(dictListCopy, dictList, MAX_STR_LEN);
+
+		// Load the word list of each dictionary
+		uint16_t priority = 0;
+		KPTSysCharT filePath[MAX_PATH];
+		KPTUniCharT *token = wcstok_s(dictListCopy, _T(","), &nextToken);
+		while (token != NULL)
+		{
+			swprintf_s(filePath, MAX_PATH, _T("%s\\%s\\%s%s"), pBasePath, LEXICON_FOLDER, token, LEXICON_FILE_EXT);
+			if (LoadWordList(filePath, priority))
+			{
+				TRACE(_T("Loaded word list %s\n"), filePath);
+			}
+			priority++;
+
+			token = wcstok_s(NULL, _T(","), &nextToken);
+		}
+
+		if (_words.empty())
+		{
+			return false;
+		}
+
+		BuildTrie();
+		BuildWordHash();
+		TRACE(_T("Lexicon has %u words and %u nodes\n"), (unsigned)_words.size(), (unsigned)_nodes.size());
+
+		return true;
+	}
+
+	// Release the words and trie
+	void Lexicon::Clear(void)
+	{
+		std::vector<KPTUniCharT>().swap(_chars);
+		std::vector<LexiconWordT>().swap(_words);
+		std::vector<LexiconNodeT>().swap(_nodes);
+		_wordHash.Detach();
+		std::vector<uint64_t>().swap(_wordHashImage);
+		std::vector<uint32_t>().swap(_hashedWordIds);
+		std::vector<uint32_t>().swap(_wordFingerprints);
+	}
+
+	// Find the child of a node for the specified character
+	uint32_t Lexicon::FindChild(uint32_t nodeIndex, KPTUniCharT ch) const
+	{
+		return SortedTrie::FindChild(_nodes, nodeIndex, &LexiconNodeT::ch, Fold(ch));
+	}
+
+	// Find the node reached by a prefix
+	uint32_t Lexicon::FindPrefix(const KPTUniCharT *prefix, size_t length) const
+	{
+		if (_nodes.empty())
+		{
+			return LEXICON_NO_NODE;
+		}
+
+		uint32_t nodeIndex = LEXICON_ROOT;
+		for (size_t i = 0; i < length && nodeIndex != LEXICON_NO_NODE; i++)
+		{
+			nodeIndex = FindChild(nodeIndex, prefix[i]);
+		}
+
+		return nodeIndex;
+	}
+
+	// Get the probability of each character that can follow a prefix node, most likely first
+	// Each subtree's total frequency is stored in its node, so only the node's children are visited
+	void Lexicon::GetNextLetters(uint32_t nodeIndex, std::vector<NextLetterT> &letters) const
+	{
+		letters.clear();
+		if (nodeIndex == LEXICON_NO_NODE || _nodes[nodeIndex].totalFrequency <= 0.0f)
+		{
+			return;
+		}
+
+		const LexiconNodeT &node = _nodes[nodeIndex];
+		float scale = 1.0f / node.totalFrequency;
+		if (node.wordId != LEXICON_NO_WORD && nodeIndex != LEXICON_ROOT)
+		{
+			NextLetterT letter = { L' ', scale * _words[node.wordId].frequency };
+			letters.push_back(letter);
+		}
+		for (uint32_t child = node.firstChild; child < node.firstChild + node.childCount; child++)
+		{
+			NextLetterT letter = { _nodes[child].ch, scale * _nodes[child].totalFrequency };
+			letters.push_back(letter);
+		}
+
+		std::sort(letters.begin(), letters.end(), [](const NextLetterT &a, const NextLetterT &b)
+		{
+			return a.prob > b.prob;
+		});
+	}
+
+	// Find the id of a word (ignoring case)
+	uint32_t Lexicon::FindWord(const KPTUniCharT *word, size_t length) const
+	{
+		// Walk the trie if the perfect hash couldn't be built
+		if (!_wordHash.IsAttached())
+		{
+			uint32_t nodeIndex = FindPrefix(word, length);
+
+			return nodeIndex != LEXICON_NO_NODE ? _nodes[nodeIndex].wordId : LEXICON_NO_WORD;
+		}
+
+		uint64_t hash = HashWord(word, length);
+		uint32_t index = _wordHash.Lookup(hash);
+		if (index == PERFECT_HASH_NOT_FOUND || _wordFingerprints[index] != PerfectHash::Fingerprint(hash))
+		{
+			return LEXICON_NO_WORD;
+		}
+
+		return _hashedWordIds[index];
+	}
+
+	// Hash a word's case-folded text (FNV-1a, mixed so that the perfect hash can use any of the bits)
+	uint64_t Lexicon::HashWord(const KPTUniCharT *word, size_t length)
+	{
+		uint64_t hash = 14695981039346656037ull;
+		for (size_t i = 0; i < length; i++)
+		{
+			hash = (hash ^ (uint16_t)Fold(word[i])) * 1099511628211ull;
+		}
+
+		return PerfectHash::Mix(hash ^ length);
+	}
+
+	// Fold a character for case-insensitive matching
+	KPTUniCharT Lexicon::Fold(KPTUniCharT ch)
+	{
+		return (KPTUniCharT)towlower(ch);
+	}
+
+	// Decide whether a character can form part of a word
+	bool Lexicon::IsWordChar(KPTUniCharT ch)
+	{
+		return iswalnum(ch) || ch == L'\'';
+	}
+
+	// Read a word list file
+	bool Lexicon::LoadWordList(const KPTSysCharT *pFilePath, uint16_t priority)
+	{
+		FILE *pFile = NULL;
+		if (0 != _wfopen_s(&pFile, pFilePath, _T("rt, ccs=UTF-8")) || pFile == NULL)
+		{
+			return false;
+		}
+
+		KPTUniCharT line[MAX_STR_LEN];
+		while (fgetws(line, MAX_STR_LEN, pFile) != NULL)
+		{
+			// Split into word and optional frequency
+			uint32_t frequency = 1;
+			size_t length = wcscspn(line, _T("\t\r\n"));
+			if (line[length] == L'\t')
+			{
+				frequency = wcstoul(&line[length + 1], NULL, 10);
+			}
+
+			if (length > 0 && length <= MAX_WORD_LEN)
+			{
+				AddWord(line, length, priority, frequency);
+			}
+		}
+
+		fclose(pFile);
+
+		return true;
+	}
+
+	// Add a word to the character pool
+	void Lexicon::AddWord(const KPTUniCharT *word, size_t length, uint16_t priority, uint32_t frequency)
+	{
+		LexiconWordT entry;
+		entry.textOffset = (uint32_t)_chars.size();
+		entry.length = (uint16_t)length;
+		entry.priority = priority;
+		entry.frequency = frequency;
+		_words.push_back(entry);
+
+		_chars.insert(_chars.end(), word, word + length);
+		_chars.push_back(L'\0');
+	}
+
+	// Sort the words, merge duplicates and build the trie
+	void Lexicon::BuildTrie(void)
+	{
+		// Sort the words by their folded text, best entry first where the same word is listed more than once
+		std::vector<uint32_t> order(_words.size());
+		for (uint32_t i = 0; i < order.size(); i++)
+		{
+			order[i] = i;
+		}
+		std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b)
+		{
+			const KPTUniCharT *pA = GetText(a);
+			const KPTUniCharT *pB = GetText(b);
+			while (*pA != L'\0' && Fold(*pA) == Fold(*pB))
+			{
+				pA++;
+				pB++;
+			}
+			if (Fold(*pA) != Fold(*pB))
+			{
+				return Fold(*pA) < Fold(*pB);
+			}
+			if (_words[a].priority != _words[b].priority)
+			{
+				return _words[a].priority < _words[b].priority;
+			}
+			return _words[a].frequency > _words[b].frequency;
+		});
+
+		// Rebuild the pool with one entry per word so that word ids are dense and in sorted order
+		std::vector<KPTUniCharT> chars;
+		std::vector<LexiconWordT> words;
+		for (size_t i = 0; i < order.size(); i++)
+		{
+			const LexiconWordT &entry = _words[order[i]];
+			const KPTUniCharT *pText = GetText(order[i]);
+			if (!words.empty() && words.back().length == entry.length &&
+				std::equal(pText, pText + entry.length, &chars[words.back().textOffset],
+					[](KPTUniCharT a, KPTUniCharT b) { return Fold(a) == Fold(b); }))
+			{
+				continue;
+			}
+
+			LexiconWordT newEntry = entry;
+			newEntry.textOffset = (uint32_t)chars.size();
+			words.push_back(newEntry);
+			chars.insert(chars.end(), pText, pText + entry.length + 1);
+		}
+		_chars.swap(chars);
+		_words.swap(words);
+
+		// Build the trie, with at most one word ending at each node now that the words are distinct
+		std::vector<SortedTrieNodeT> trie;
+		SortedTrie::Build((uint32_t)_words.size(), GetWordSymbol, (intptr_t)this, trie);
+		_nodes.resize(trie.size());
+		for (size_t i = 0; i < trie.size(); i++)
+		{
+			LexiconNodeT node = { (KPTUniCharT)trie[i].symbol, (uint16_t)trie[i].childCount, trie[i].firstChild,
+				trie[i].endCount != 0 ? trie[i].first : LEXICON_NO_WORD, LEXICON_NO_WORD, 0.0f };
+			_nodes[i] = node;
+		}
+
+		// Record the most frequent word and the total frequency of each subtree, working upwards from the leaves
+		for (size_t i = _nodes.size(); i-- > 0; )
+		{
+			LexiconNodeT &node = _nodes[i];
+			uint32_t bestWordId = node.wordId;
+			float totalFrequency = node.wordId != LEXICON_NO_WORD ? (float)_words[node.wordId].frequency : 0.0f;
+			for (uint32_t child = node.firstChild; child < node.firstChild + node.childCount; child++)
+			{
+				uint32_t childBest = _nodes[child].bestWordId;
+				if (bestWordId == LEXICON_NO_WORD || _words[childBest].frequency > _words[bestWordId].frequency)
+				{
+					bestWordId = childBest;
+				}
+				totalFrequency += _nodes[child].totalFrequency;
+			}
+			node.bestWordId = bestWordId;
+			node.totalFrequency = totalFrequency;
+		}
+	}
+
+	// Build the perfect hash from each word to its id
+	void Lexicon::BuildWordHash(void)
+	{
+		std::vector<uint64_t> hashes(_words.size());
+		uint32_t wordId;
+		for (wordId = 0; wordId < _words.size(); wordId++)
+		{
+			hashes[wordId] = HashWord(GetText(wordId), _words[wordId].length);
+		}
+
+		if (!PerfectHash::Build(hashes, _wordHashImage) || !_wordHash.Attach(_wordHashImage.data(), _wordHashImage.size()))
+		{
+			TRACE(_T("Couldn't build perfect hash of lexicon words\n"));
+			std::vector<uint64_t>().swap(_wordHashImage);
+			return;
+		}
+
+		_hashedWordIds.resize(_words.size());
+		_wordFingerprints.resize(_words.size());
+		for (wordId = 0; wordId < _words.size(); wordId++)
+		{
+			uint32_t index = _wordHash.Lookup(hashes[wordId]);
+			_hashedWordIds[index] = wordId;
+			_wordFingerprints[index] = PerfectHash::Fingerprint(hashes[wordId]);
+		}
+	}
@@ -0,0 +1,96 @@
+#pragma once
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+
+#include <vector>
+#include "kptapi.h"
+#include "PerfectHash.h"
+#include "SortedTrie.h"
+
+	#define LEXICON_NO_WORD 0xFFFFFFFF
+	#define LEXICON_NO_NODE SORTED_TRIE_NO_NODE
+	#define LEXICON_ROOT SORTED_TRIE_ROOT
+
+	// A word in the lexicon
+	struct LexiconWordT
+	{
+		uint32_t textOffset;	// Offset of the word in the character pool
+		uint16_t length;		// Number of characters, excluding NULL
+		uint16_t priority;		// Priority of the highest priority dictionary containing the word (0 = highest)
+		uint32_t frequency;		// Unigram frequency count
+	};
+
+	// A node in the lexicon trie
+	// Trie characters are lower case and the children of a node are contiguous and sorted by character
+	struct LexiconNodeT
+	{
+		KPTUniCharT ch;			// Character on the edge into this node
+		uint16_t childCount;	// Number of children
+		uint32_t firstChild;	// Index of the first child
+		uint32_t wordId;		// Word ending at this node, or LEXICON_NO_WORD
+		uint32_t bestWordId;	// Most frequent word in this node's subtree, or LEXICON_NO_WORD
+		float totalFrequency;	// Sum of the frequencies of the words in this node's subtree
+	};
+
+	// Probability of a character following a prefix (a space for the end of the word)
+	struct NextLetterT
+	{
+		KPTUniCharT ch;
+		float prob;
+	};
+
+	// Native word list for the active dictionaries, with a trie for prefix and error-tolerant searches
+	// and a minimal perfect hash from each word to its id for exact lookups.
+	// Word lists are UTF-8 text files in the Lexicon folder of the base path, with one entry per line
+	// in the form word[<tab>frequency], named after the dictionary they accompany e.g. enggb.txt
+	class Lexicon
+	{
+	private:
+		std::vector<KPTUniCharT> _chars;
+		std::vector<LexiconWordT> _words;
+		std::vector<LexiconNodeT> _nodes;
+		std::vector<uint64_t> _wordHashImage;
+		PerfectHash _wordHash;
+		std::vector<uint32_t> _hashedWordIds;		// Word id at each perfect hash index
+		std::vector<uint32_t> _wordFingerprints;	// Fingerprint of the word at each perfect hash index
+
+	public:
+		Lexicon(void);
+		~Lexicon(void);
+
+		bool Load(const KPTSysCharT *pBasePath, const KPTUniCharT *dictList);
+		void Clear(void);
+		bool IsLoaded(void) const { return !_nodes.empty(); }
+
+		size_t WordCount(void) const { return _words.size(); }
+		size_t NodeCount(void) const { return _nodes.size(); }
+		const LexiconWordT &GetWord(uint32_t wordId) const { return _words[wordId]; }
+		const KPTUniCharT *GetText(uint32_t wordId) const { return &_chars[_words[wordId].textOffset]; }
+		const LexiconNodeT &GetNode(uint32_t nodeIndex) const { return _nodes[nodeIndex]; }
+
+		uint32_t FindChild(uint32_t nodeIndex, KPTUniCharT ch) const;
+		uint32_t FindPrefix(const KPTUniCharT *prefix, size_t length) const;
+		uint32_t FindWord(const KPTUniCharT *word, size_t length) const;
+		void GetNextLetters(uint32_t nodeIndex, std::vector<NextLetterT> &letters) const;
+
+		static KPTUniCharT Fold(KPTUniCharT ch);
+		static bool IsWordChar(KPTUniCharT ch);
+		static uint64_t HashWord(const KPTUniCharT *word, size_t length);
+
+	private:
+		bool LoadWordList(const KPTSysCharT *pFilePath, uint16_t priority);
+		void AddWord(const KPTUniCharT *word, size_t length, uint16_t priority, uint32_t frequency);
+		void BuildTrie(void);
+		void BuildWordHash(void);
+	};
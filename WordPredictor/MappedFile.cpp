@@ -0,0 +1,126 @@
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+#include "stdafx.h"
+#include "MappedFile.h"
+
+	// Constructor
+	MappedFile::MappedFile(void)
+	{
+		_hFile = INVALID_HANDLE_VALUE;
+		_hMapping = NULL;
+		_pData = NULL;
+		_size = 0;
+	}
+
+	// Destructor
+	MappedFile::~MappedFile(void)
+	{
+		Close();
+	}
+
+	// Map a file into memory
+	bool MappedFile::Open(const KPTSysCharT *pFilePath)
+	{
+		Close();
+
+		// Deletes are shared so that a newer image can be moved into place while this one is still mapped
+		_hFile = CreateFileW(pFilePath, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (_hFile == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(_hFile, &fileSize) || fileSize.QuadPart == 0 || (ULONGLONG)fileSize.QuadPart > (size_t)-1)
+		{
+			Close();
+			return false;
+		}
+
+		_hMapping = CreateFileMappingW(_hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (_hMapping == NULL)
+		{
+			Close();
+			return false;
+		}
+
+		_pData = (const uint8_t *)MapViewOfFile(_hMapping, FILE_MAP_READ, 0, 0, 0);
+		if (_pData == NULL)
+		{
+			Close();
+			return false;
+		}
+		_size = (size_t)fileSize.QuadPart;
+
+		return true;
+	}
+
+	// Unmap the file
+	void MappedFile::Close(void)
+	{
+		if (_pData != NULL)
+		{
+			UnmapViewOfFile(_pData);
+			_pData = NULL;
+		}
+		if (_hMapping != NULL)
+		{
+			CloseHandle(_hMapping);
+			_hMapping = NULL;
+		}
+		if (_hFile != INVALID_HANDLE_VALUE)
+		{
+			CloseHandle(_hFile);
+			_hFile = INVALID_HANDLE_VALUE;
+		}
+		_size = 0;
+	}
+
+	// Get the size and last write time of a file, so that images built from it can be checked for staleness
+	bool MappedFile::GetFileStamp(const KPTSysCharT *pFilePath, uint64_t &size, uint64_t &lastWriteTime)
+	{
+		WIN32_FILE_ATTRIBUTE_DATA attributes;
+		if (!GetFileAttributesExW(pFilePath, GetFileExInfoStandard, &attributes))
+		{
+			return false;
+		}
+
+		size = ((uint64_t)attributes.nFileSizeHigh << 32) | attributes.nFileSizeLow;
+		lastWriteTime = ((uint64_t)attributes.ftLastWriteTime.dwHighDateTime << 32) | attributes.ftLastWriteTime.dwLowDateTime;
+
+		return true;
+	}
+
+	// Move a newly written file into place, so that readers never see a partly written image
+	bool MappedFile::ReplaceFile(const KPTSysCharT *pTempPath, const KPTSysCharT *pFilePath)
+	{
+		if (MoveFileExW(pTempPath, pFilePath, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+		{
+			return true;
+		}
+
+		// If the existing file is still mapped, rename it out of the way and delete it, which takes effect once it is unmapped
+		KPTSysCharT oldPath[MAX_PATH];
+		for (uint32_t i = 0; i < MAX_REPLACED_FILES; i++)
+		{
+			swprintf_s(oldPath, MAX_PATH, _T("%s.%u.old"), pFilePath, i);
+			if (MoveFileExW(pFilePath, oldPath, 0))
+			{
+				DeleteFileW(oldPath);
+				return MoveFileExW(pTempPath, pFilePath, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != FALSE;
+			}
+		}
+
+		return false;
+	}
@@ -0,0 +1,43 @@
+#pragma once
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+
+#include "kptapi.h"
+
+	// Read-only memory mapping of a whole file
+	class MappedFile
+	{
+	private:
+		HANDLE _hFile;
+		HANDLE _hMapping;
+		const uint8_t *_pData;
+		size_t _size;
+
+	public:
+		MappedFile(void);
+		~MappedFile(void);
+
+		bool Open(const KPTSysCharT *pFilePath);
+		void Close(void);
+		bool IsOpen(void) const { return _pData != NULL; }
+		const uint8_t *Data(void) const { return _pData; }
+		size_t Size(void) const { return _size; }
+
+		static bool GetFileStamp(const KPTSysCharT *pFilePath, uint64_t &size, uint64_t &lastWriteTime);
+		static bool ReplaceFile(const KPTSysCharT *pTempPath, const KPTSysCharT *pFilePath);
+
+	private:
+		MappedFile(const MappedFile &);
+		MappedFile &operator=(const MappedFile &);
+	};
@@ -0,0 +1,99 @@
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+#include "stdafx.h"
+#include "NextWordCache.h"
+
+	// Constructor
+	NextWordCache::NextWordCache(void)
+	{
+		_capacity = NEXT_WORD_CACHE_SIZE;
+	}
+
+	// Destructor
+	NextWordCache::~NextWordCache(void)
+	{
+	}
+
+	// Set the maximum number of contexts to hold
+	void NextWordCache::SetCapacity(size_t capacity)
+	{
+		_capacity = (std::max)(capacity, (size_t)1);
+		while (_entries.size() > _capacity)
+		{
+			_index.erase(_entries.back().key);
+			_entries.pop_back();
+		}
+	}
+
+	// Remove all the entries
+	void NextWordCache::Clear(void)
+	{
+		_entries.clear();
+		_index.clear();
+	}
+
+	// Find the predictions for a context, marking them as recently used, or return NULL if they aren't cached
+	const NextWordEntryT *NextWordCache::Find(size_t modelIndex, uint32_t word1, uint32_t word2)
+	{
+		std::unordered_map<uint64_t, std::list<NextWordEntryT>::iterator>::iterator it = _index.find(MakeKey(modelIndex, word1, word2));
+		if (it == _index.end())
+		{
+			return NULL;
+		}
+
+		_entries.splice(_entries.begin(), _entries, it->second);
+
+		return &_entries.front();
+	}
+
+	// Cache the predictions for a context, replacing the least recently used context if the cache is full
+	const NextWordEntryT *NextWordCache::Add(size_t modelIndex, uint32_t word1, uint32_t word2, const std::vector<ContextPredictionT> &predictions)
+	{
+		uint64_t key = MakeKey(modelIndex, word1, word2);
+		std::unordered_map<uint64_t, std::list<NextWordEntryT>::iterator>::iterator it = _index.find(key);
+		if (it != _index.end())
+		{
+			_entries.splice(_entries.begin(), _entries, it->second);
+		}
+		else if (_entries.size() < _capacity)
+		{
+			_entries.push_front(NextWordEntryT());
+			_index[key] = _entries.begin();
+		}
+		else
+		{
+			// Reuse the least recently used entry
+			_index.erase(_entries.back().key);
+			_entries.splice(_entries.begin(), _entries, --_entries.end());
+			_index[key] = _entries.begin();
+		}
+
+		NextWordEntryT &entry = _entries.front();
+		entry.key = key;
+		entry.count = (std::min)(predictions.size(), (size_t)MAX_NATIVE_PREDICTIONS);
+		for (size_t i = 0; i < entry.count; i++)
+		{
+			entry.predictions[i] = predictions[i];
+		}
+
+		return &entry;
+	}
+
+	// Combine a model index and two word ids, each of which fits in CONTEXT_WORD_BITS, into a key
+	uint64_t NextWordCache::MakeKey(size_t modelIndex, uint32_t word1, uint32_t word2)
+	{
+		const uint64_t wordMask = ((uint64_t)1 << CONTEXT_WORD_BITS) - 1;
+
+		return ((uint64_t)modelIndex << (2 * CONTEXT_WORD_BITS)) | ((word1 & wordMask) << CONTEXT_WORD_BITS) | (word2 & wordMask);
+	}
@@ -0,0 +1,52 @@
+#pragma once
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+
+#include <list>
+#include <unordered_map>
+#include <vector>
+#include "ContextModel.h"
+
+	// Cached predictions for a context
+	struct NextWordEntryT
+	{
+		uint64_t key;
+		size_t count;
+		ContextPredictionT predictions[MAX_NATIVE_PREDICTIONS];
+	};
+
+	// Bounded least recently used cache of the top next-word predictions for each context
+	// A context is identified by the context model and the ids of the previous two words, either of which may be
+	// CONTEXT_NO_WORD at the start of a sentence, so that repeated empty-prefix queries are a single hash lookup.
+	class NextWordCache
+	{
+	private:
+		size_t _capacity;
+		std::list<NextWordEntryT> _entries;		// Most recently used first
+		std::unordered_map<uint64_t, std::list<NextWordEntryT>::iterator> _index;
+
+	public:
+		NextWordCache(void);
+		~NextWordCache(void);
+
+		void SetCapacity(size_t capacity);
+		void Clear(void);
+		size_t Count(void) const { return _entries.size(); }
+
+		const NextWordEntryT *Find(size_t modelIndex, uint32_t word1, uint32_t word2);
+		const NextWordEntryT *Add(size_t modelIndex, uint32_t word1, uint32_t word2, const std::vector<ContextPredictionT> &predictions);
+
+	private:
+		static uint64_t MakeKey(size_t modelIndex, uint32_t word1, uint32_t word2);
+	};
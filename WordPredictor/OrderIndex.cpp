@@ -0,0 +1,195 @@
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+#include "stdafx.h"
+#include "PersonalDictionary.h"
+#include "OrderIndex.h"
+
+	// Constructor
+	OrderIndex::OrderIndex(void)
+	{
+		_pDictionary = NULL;
+		_order = ePersonalOrderAlpha;
+		_root = ORDER_NO_NODE;
+		_seed = 0x9E3779B9;
+	}
+
+	// Destructor
+	OrderIndex::~OrderIndex(void)
+	{
+	}
+
+	// Set the dictionary whose words are indexed and the order to keep them in
+	void OrderIndex::SetOrder(const PersonalDictionary *pDictionary, PersonalOrderT order)
+	{
+		_pDictionary = pDictionary;
+		_order = order;
+		Clear();
+	}
+
+	// Remove all the words
+	void OrderIndex::Clear(void)
+	{
+		std::vector<OrderNodeT>().swap(_nodes);
+		_root = ORDER_NO_NODE;
+	}
+
+	// Add a word to the tree
+	void OrderIndex::Insert(uint32_t entry)
+	{
+		if (entry >= _nodes.size())
+		{
+			_nodes.resize(entry + 1);
+		}
+
+		// Random priorities from a xorshift generator
+		_seed ^= _seed << 13;
+		_seed ^= _seed >> 17;
+		_seed ^= _seed << 5;
+		OrderNodeT &node = _nodes[entry];
+		node.left = ORDER_NO_NODE;
+		node.right = ORDER_NO_NODE;
+		node.size = 1;
+		node.priority = _seed;
+
+		uint32_t left;
+		uint32_t right;
+		Split(_root, entry, left, right);
+		_root = Merge(Merge(left, entry), right);
+	}
+
+	// Remove a word from the tree, which must still have the sort key it was inserted with
+	void OrderIndex::Erase(uint32_t entry)
+	{
+		_root = Erase(_root, entry);
+	}
+
+	// List the words at a range of positions in the order, or in the reverse order
+	void OrderIndex::GetRange(size_t first, size_t count, bool isReversed, std::vector<uint32_t> &entries) const
+	{
+		entries.clear();
+
+		// Descend to the first word, stacking the nodes that come after it on the way
+		std::vector<uint32_t> stack;
+		uint32_t node = _root;
+		while (node != ORDER_NO_NODE)
+		{
+			uint32_t nearChild = isReversed ? _nodes[node].right : _nodes[node].left;
+			size_t nearSize = Size(nearChild);
+			if (first < nearSize)
+			{
+				stack.push_back(node);
+				node = nearChild;
+			}
+			else if (first == nearSize)
+			{
+				stack.push_back(node);
+				break;
+			}
+			else
+			{
+				first -= nearSize + 1;
+				node = isReversed ? _nodes[node].left : _nodes[node].right;
+			}
+		}
+
+		// Walk on in order from there
+		while (!stack.empty() && entries.size() < count)
+		{
+			node = stack.back();
+			stack.pop_back();
+			entries.push_back(node);
+			for (uint32_t next = isReversed ? _nodes[node].left : _nodes[node].right; next != ORDER_NO_NODE; next = isReversed ? _nodes[next].right : _nodes[next].left)
+			{
+				stack.push_back(next);
+			}
+		}
+	}
+
+	// Split a subtree into the words that come before a word and the rest
+	void OrderIndex::Split(uint32_t node, uint32_t entry, uint32_t &left, uint32_t &right)
+	{
+		if (node == ORDER_NO_NODE)
+		{
+			left = ORDER_NO_NODE;
+			right = ORDER_NO_NODE;
+		}
+		else if (_pDictionary->IsBefore(_order, node, entry))
+		{
+			Split(_nodes[node].right, entry, _nodes[node].right, right);
+			left = node;
+			UpdateSize(node);
+		}
+		else
+		{
+			Split(_nodes[node].left, entry, left, _nodes[node].left);
+			right = node;
+			UpdateSize(node);
+		}
+	}
+
+	// Join two subtrees where every word in the left one comes before every word in the right one
+	uint32_t OrderIndex::Merge(uint32_t left, uint32_t right)
+	{
+		if (left == ORDER_NO_NODE)
+		{
+			return right;
+		}
+		if (right == ORDER_NO_NODE)
+		{
+			return left;
+		}
+
+		if (_nodes[left].priority > _nodes[right].priority)
+		{
+			_nodes[left].right = Merge(_nodes[left].right, right);
+			UpdateSize(left);
+			return left;
+		}
+
+		_nodes[right].left = Merge(left, _nodes[right].left);
+		UpdateSize(right);
+
+		return right;
+	}
+
+	// Remove a word from a subtree and return the new root of the subtree
+	uint32_t OrderIndex::Erase(uint32_t node, uint32_t entry)
+	{
+		if (node == ORDER_NO_NODE)
+		{
+			return ORDER_NO_NODE;
+		}
+		if (node == entry)
+		{
+			return Merge(_nodes[node].left, _nodes[node].right);
+		}
+
+		if (_pDictionary->IsBefore(_order, entry, node))
+		{
+			_nodes[node].left = Erase(_nodes[node].left, entry);
+		}
+		else
+		{
+			_nodes[node].right = Erase(_nodes[node].right, entry);
+		}
+		UpdateSize(node);
+
+		return node;
+	}
+
+	// Recalculate the size of a subtree from its children
+	void OrderIndex::UpdateSize(uint32_t node)
+	{
+		_nodes[node].size = 1 + Size(_nodes[node].left) + Size(_nodes[node].right);
+	}
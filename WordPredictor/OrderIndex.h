@@ -0,0 +1,71 @@
+#pragma once
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+
+#include <vector>
+#include "kptapi.h"
+
+	#define ORDER_NO_NODE 0xFFFFFFFF
+
+	class PersonalDictionary;
+
+	// Orders that the learned words can be listed in
+	enum PersonalOrderT
+	{
+		ePersonalOrderAlpha = 0,		// Alphabetical ignoring case
+		ePersonalOrderFrequency = 1,	// Least frequent first
+		ePersonalOrderTime = 2			// Oldest first
+	};
+
+	// A node of the tree, stored at the index of the word it holds
+	struct OrderNodeT
+	{
+		uint32_t left;
+		uint32_t right;
+		uint32_t size;			// Number of nodes in the subtree
+		uint32_t priority;		// Random heap priority that keeps the tree balanced
+	};
+
+	// Order-statistic tree of the words in a personal dictionary, so that a page of words at any position in a sorted
+	// view can be listed in O(log n + page size) as words are learned, rather than sorting the whole dictionary. It is
+	// a treap with subtree sizes, and the words are compared by the dictionary, so a word must be erased before its
+	// sort key changes and inserted again afterwards. Reading the tree backwards gives the reverse order.
+	class OrderIndex
+	{
+	private:
+		const PersonalDictionary *_pDictionary;
+		PersonalOrderT _order;
+		std::vector<OrderNodeT> _nodes;
+		uint32_t _root;
+		uint32_t _seed;
+
+	public:
+		OrderIndex(void);
+		~OrderIndex(void);
+
+		void SetOrder(const PersonalDictionary *pDictionary, PersonalOrderT order);
+		void Clear(void);
+		size_t Count(void) const { return Size(_root); }
+
+		void Insert(uint32_t entry);
+		void Erase(uint32_t entry);
+		void GetRange(size_t first, size_t count, bool isReversed, std::vector<uint32_t> &entries) const;
+
+	private:
+		void Split(uint32_t node, uint32_t entry, uint32_t &left, uint32_t &right);
+		uint32_t Merge(uint32_t left, uint32_t right);
+		uint32_t Erase(uint32_t node, uint32_t entry);
+		uint32_t Size(uint32_t node) const { return node != ORDER_NO_NODE ? _nodes[node].size : 0; }
+		void UpdateSize(uint32_t node);
+	};
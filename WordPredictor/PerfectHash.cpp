@@ -0,0 +1,218 @@
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+#include "stdafx.h"
+#include "PerfectHash.h"
+
+	// Constructor
+	PerfectHash::PerfectHash(void)
+	{
+		_pHeader = NULL;
+		_pBits = NULL;
+		_pRanks = NULL;
+	}
+
+	// Destructor
+	PerfectHash::~PerfectHash(void)
+	{
+	}
+
+	// Use an image that was created by Build, checking that it is consistent with its size in 64-bit words
+	bool PerfectHash::Attach(const uint64_t *pImage, size_t wordCount)
+	{
+		Detach();
+
+		const size_t headerWords = sizeof(PerfectHashHeaderT) / sizeof(uint64_t);
+		if (pImage == NULL || wordCount < headerWords)
+		{
+			return false;
+		}
+
+		const PerfectHashHeaderT *pHeader = (const PerfectHashHeaderT *)pImage;
+		size_t expectedWords = headerWords + (size_t)pHeader->bitWordCount + ((size_t)pHeader->rankCount + 1) / 2;
+		if (pHeader->levelCount > PERFECT_HASH_MAX_LEVELS ||
+			pHeader->rankCount != pHeader->bitWordCount / PERFECT_HASH_RANK_BLOCK + 1 ||
+			expectedWords != wordCount)
+		{
+			return false;
+		}
+
+		_pHeader = pHeader;
+		_pBits = pImage + headerWords;
+		_pRanks = (const uint32_t *)(_pBits + _pHeader->bitWordCount);
+
+		return true;
+	}
+
+	// Stop using the image
+	void PerfectHash::Detach(void)
+	{
+		_pHeader = NULL;
+		_pBits = NULL;
+		_pRanks = NULL;
+	}
+
+	// Get the index of a key, or PERFECT_HASH_NOT_FOUND if it certainly isn't in the set
+	uint32_t PerfectHash::Lookup(uint64_t keyHash) const
+	{
+		if (_pHeader == NULL)
+		{
+			return PERFECT_HASH_NOT_FOUND;
+		}
+
+		for (uint32_t level = 0; level < _pHeader->levelCount; level++)
+		{
+			size_t start = _pHeader->levelStarts[level];
+			size_t end = level + 1 < _pHeader->levelCount ? _pHeader->levelStarts[level + 1] : _pHeader->bitWordCount;
+			size_t bitIndex = start * 64 + LevelBit(keyHash, level, (end - start) * 64);
+			if ((_pBits[bitIndex / 64] >> (bitIndex % 64)) & 1)
+			{
+				return Rank(bitIndex);
+			}
+		}
+
+		return PERFECT_HASH_NOT_FOUND;
+	}
+
+	// Build an image for a set of distinct key hashes
+	// Fails if two keys have the same hash or keys are still colliding after the last level
+	bool PerfectHash::Build(const std::vector<uint64_t> &keyHashes, std::vector<uint64_t> &image)
+	{
+		image.clear();
+
+		PerfectHashHeaderT header = { 0 };
+		header.keyCount = (uint32_t)keyHashes.size();
+		std::vector<uint64_t> bits;
+		std::vector<uint64_t> remaining(keyHashes);
+		std::vector<uint64_t> next;
+		std::vector<uint64_t> seen;
+		std::vector<uint64_t> collisions;
+		size_t i;
+		while (!remaining.empty())
+		{
+			if (header.levelCount == PERFECT_HASH_MAX_LEVELS)
+			{
+				return false;
+			}
+
+			// Mark the bits that more than one remaining key hashes to
+			size_t levelWords = (remaining.size() * PERFECT_HASH_GAMMA + 63) / 64;
+			size_t bitCount = levelWords * 64;
+			seen.assign(levelWords, 0);
+			collisions.assign(levelWords, 0);
+			for (i = 0; i < remaining.size(); i++)
+			{
+				size_t bit = LevelBit(remaining[i], header.levelCount, bitCount);
+				uint64_t mask = (uint64_t)1 << (bit % 64);
+				collisions[bit / 64] |= seen[bit / 64] & mask;
+				seen[bit / 64] |= mask;
+			}
+
+			// Place the keys that have a bit to themselves and carry the rest to the next level
+			next.clear();
+			for (i = 0; i < remaining.size(); i++)
+			{
+				size_t bit = LevelBit(remaining[i], header.levelCount, bitCount);
+				if ((collisions[bit / 64] >> (bit % 64)) & 1)
+				{
+					next.push_back(remaining[i]);
+				}
+			}
+			for (i = 0; i < levelWords; i++)
+			{
+				seen[i] &= ~collisions[i];
+			}
+
+			header.levelStarts[header.levelCount++] = (uint32_t)bits.size();
+			bits.insert(bits.end(), seen.begin(), seen.end());
+			remaining.swap(next);
+		}
+
+		// Sample the number of set bits before each block
+		std::vector<uint32_t> ranks;
+		uint32_t rank = 0;
+		for (i = 0; i < bits.size(); i++)
+		{
+			if (i % PERFECT_HASH_RANK_BLOCK == 0)
+			{
+				ranks.push_back(rank);
+			}
+			rank += PopCount(bits[i]);
+		}
+		if (bits.size() % PERFECT_HASH_RANK_BLOCK == 0)
+		{
+			ranks.push_back(rank);
+		}
+		if (ranks.size() % 2 != 0)
+		{
+			ranks.push_back(0);
+		}
+		header.bitWordCount = (uint32_t)bits.size();
+		header.rankCount = (uint32_t)(bits.size() / PERFECT_HASH_RANK_BLOCK + 1);
+
+		image.resize(sizeof(PerfectHashHeaderT) / sizeof(uint64_t) + bits.size() + ranks.size() / 2);
+		uint64_t *pImage = image.data();
+		memcpy(pImage, &header, sizeof(header));
+		pImage += sizeof(PerfectHashHeaderT) / sizeof(uint64_t);
+		if (!bits.empty())
+		{
+			memcpy(pImage, bits.data(), bits.size() * sizeof(uint64_t));
+		}
+		pImage += bits.size();
+		memcpy(pImage, ranks.data(), ranks.size() * sizeof(uint32_t));
+
+		return true;
+	}
+
+	// Scramble a hash so that all of its bits depend on all of the input bits (MurmurHash3 finalizer)
+	uint64_t PerfectHash::Mix(uint64_t hash)
+	{
+		hash ^= hash >> 33;
+		hash *= 0xFF51AFD7ED558CCDull;
+		hash ^= hash >> 33;
+		hash *= 0xC4CEB9FE1A85EC53ull;
+		hash ^= hash >> 33;
+
+		return hash;
+	}
+
+	// Count the set bits that precede a bit
+	uint32_t PerfectHash::Rank(size_t bitIndex) const
+	{
+		size_t word = bitIndex / 64;
+		uint32_t rank = _pRanks[word / PERFECT_HASH_RANK_BLOCK];
+		for (size_t i = word - word % PERFECT_HASH_RANK_BLOCK; i < word; i++)
+		{
+			rank += PopCount(_pBits[i]);
+		}
+
+		return rank + PopCount(_pBits[word] & (((uint64_t)1 << (bitIndex % 64)) - 1));
+	}
+
+	// Choose a key's bit within a level
+	size_t PerfectHash::LevelBit(uint64_t keyHash, uint32_t level, size_t bitCount)
+	{
+		uint32_t hash = (uint32_t)Mix(keyHash + 0x9E3779B97F4A7C15ull * (level + 1));
+
+		return (size_t)(((uint64_t)hash * bitCount) >> 32);
+	}
+
+	// Count the set bits in a word
+	uint32_t PerfectHash::PopCount(uint64_t bits)
+	{
+		bits = bits - ((bits >> 1) & 0x5555555555555555ull);
+		bits = (bits & 0x3333333333333333ull) + ((bits >> 2) & 0x3333333333333333ull);
+		bits = (bits + (bits >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+
+		return (uint32_t)((bits * 0x0101010101010101ull) >> 56);
+	}
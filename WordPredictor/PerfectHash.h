@@ -0,0 +1,67 @@
+#pragma once
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+
+#include <vector>
+#include "kptapi.h"
+
+	#define PERFECT_HASH_NOT_FOUND 0xFFFFFFFF
+	#define PERFECT_HASH_MAX_LEVELS 32
+	#define PERFECT_HASH_GAMMA 2			// Bits per remaining key at each level
+	#define PERFECT_HASH_RANK_BLOCK 8		// 64-bit words per rank sample
+
+	// Header of a perfect hash image
+	struct PerfectHashHeaderT
+	{
+		uint32_t keyCount;
+		uint32_t levelCount;
+		uint32_t bitWordCount;			// Number of 64-bit words of level bits
+		uint32_t rankCount;				// Number of rank samples
+		uint32_t levelStarts[PERFECT_HASH_MAX_LEVELS];	// First 64-bit word of each level
+	};
+
+	// Minimal perfect hash from a set of 64-bit key hashes to the integers 0 to keyCount - 1 (BBHash)
+	// Each level is a bit array with PERFECT_HASH_GAMMA bits per key still to be placed. A key is placed at the first
+	// level where no other remaining key hashes to the same bit, and its index is the number of placed keys before it,
+	// found from rank samples taken every PERFECT_HASH_RANK_BLOCK words. This costs about 3.5 bits per key.
+	// A key that wasn't in the set may still be given an index, so callers keep a fingerprint of each key to reject it.
+	// Only fixed vocabularies use it: the lexicon and the context model. The personal dictionary, session cache and
+	// admission sketch key on Lexicon::HashWord directly, because most of the words they hold aren't in the lexicon.
+	// Layout: header, level bits (bitWordCount), rank samples (rankCount, padded to a whole number of 64-bit words).
+	class PerfectHash
+	{
+	private:
+		const PerfectHashHeaderT *_pHeader;
+		const uint64_t *_pBits;
+		const uint32_t *_pRanks;
+
+	public:
+		PerfectHash(void);
+		~PerfectHash(void);
+
+		bool Attach(const uint64_t *pImage, size_t wordCount);
+		void Detach(void);
+		bool IsAttached(void) const { return _pHeader != NULL; }
+
+		uint32_t Lookup(uint64_t keyHash) const;
+
+		static bool Build(const std::vector<uint64_t> &keyHashes, std::vector<uint64_t> &image);
+		static uint64_t Mix(uint64_t hash);
+		static uint32_t Fingerprint(uint64_t keyHash) { return (uint32_t)(keyHash >> 32); }
+
+	private:
+		uint32_t Rank(size_t bitIndex) const;
+		static size_t LevelBit(uint64_t keyHash, uint32_t level, size_t bitCount);
+		static uint32_t PopCount(uint64_t bits);
+	};
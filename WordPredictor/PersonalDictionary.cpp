@@ -0,0 +1,480 @@
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+#include "stdafx.h"
+#include <math.h>
+#include <float.h>
+#include <algorithm>
+#include "Lexicon.h"
+#include "PersonalDictionary.h"
+#include "TopEntries.h"
+
+	// Constructor
+	PersonalDictionary::PersonalDictionary(void)
+	{
+		_capacity = 0;
+		_alphaIndex.SetOrder(this, ePersonalOrderAlpha);
+		_frequencyIndex.SetOrder(this, ePersonalOrderFrequency);
+		_timeIndex.SetOrder(this, ePersonalOrderTime);
+		Clear();
+		SetCapacity(PD_DEFAULT_CAPACITY);
+	}
+
+	// Destructor
+	PersonalDictionary::~PersonalDictionary(void)
+	{
+	}
+
+	// Forget all the learned words
+	void PersonalDictionary::Clear(void)
+	{
+		_words.Clear();
+		_slots.Release();
+		_epoch = 0;
+		_epochWords = 0;
+		_isRebasing = false;
+		_rebaseShift = 0;
+		_rebaseEnd = 0;
+		_clockHand = 0;
+		_sketch.Clear();
+		_epochOrigin = 0;
+		std::vector<double>().swap(_frequencyKeys);
+		_alphaIndex.Clear();
+		_frequencyIndex.Clear();
+		_timeIndex.Clear();
+	}
+
+	// Set the maximum number of words, forgetting the least used words if there are more
+	void PersonalDictionary::SetCapacity(size_t capacity)
+	{
+		if (capacity == 0 || capacity == _capacity)
+		{
+			return;
+		}
+		_capacity = capacity;
+		_sketch.SetSize(capacity, (uint32_t)(PD_SKETCH_RESET_FACTOR * capacity));
+
+		if (_words.Count() > capacity)
+		{
+			// Finish any rebasing first, because removing words moves others
+			if (_isRebasing)
+			{
+				RebaseWords(_words.Count());
+			}
+			while (_words.Count() > capacity)
+			{
+				RemoveWord(GetVictim());
+			}
+			TRACE(_T("Reduced personal dictionary to %u words\n"), (unsigned)capacity);
+		}
+	}
+
+	// Set the learning clock, e.g. when loading a saved dictionary
+	void PersonalDictionary::SetClock(uint16_t epoch, uint32_t epochWords)
+	{
+		_epoch = epoch;
+		_epochWords = epochWords;
+	}
+
+	// Learn an occurrence of a word, or add a weighted count for it
+	void PersonalDictionary::AddWord(const KPTUniCharT *word, size_t length, float delta, uint32_t timestamp)
+	{
+		if (length == 0 || length > MAX_WORD_LEN)
+		{
+			return;
+		}
+
+		uint64_t hash = Lexicon::HashWord(word, length);
+		_sketch.Add(hash);
+		uint32_t entry = FindOrAdd(hash, word, length, timestamp, false);
+		if (entry == PD_NO_ENTRY)
+		{
+			AdvanceClock();
+			return;
+		}
+
+		// Bring the count up to date before adding to it
+		_frequencyIndex.Erase(entry);
+		PersonalWordT &personalWord = _words.Edit(entry);
+		personalWord.count = GetEntryCount(entry) + delta;
+		personalWord.lastEpoch = GetEntryEpoch(entry);
+		SetFrequencyKey(entry);
+		_frequencyIndex.Insert(entry);
+
+		AdvanceClock();
+	}
+
+	// Add a saved word with its count as of the current epoch
+	void PersonalDictionary::LoadWord(const KPTUniCharT *word, size_t length, float count, uint32_t firstLearned)
+	{
+		if (length == 0 || length > MAX_WORD_LEN)
+		{
+			return;
+		}
+
+		uint32_t entry = FindOrAdd(Lexicon::HashWord(word, length), word, length, firstLearned, true);
+		if (entry != PD_NO_ENTRY)
+		{
+			_frequencyIndex.Erase(entry);
+			PersonalWordT &personalWord = _words.Edit(entry);
+			personalWord.count = count;
+			personalWord.lastEpoch = GetEntryEpoch(entry);
+			SetFrequencyKey(entry);
+			_frequencyIndex.Insert(entry);
+		}
+	}
+
+	// Take a snapshot of the words and the learning clock in O(1), for saving
+	void PersonalDictionary::Snapshot(PersonalSnapshotT &snapshot)
+	{
+		_words.Snapshot(snapshot.words);
+		snapshot.epoch = _epoch;
+		snapshot.epochWords = _epochWords;
+		snapshot.isRebasing = _isRebasing;
+		snapshot.rebaseShift = _rebaseShift;
+		snapshot.rebaseEnd = _rebaseEnd;
+	}
+
+	// Get the count of a word in a snapshot, decayed to the snapshot's epoch
+	float PersonalDictionary::GetSnapshotCount(const PersonalSnapshotT &snapshot, uint32_t entry)
+	{
+		const PersonalWordT &personalWord = snapshot.words.Get(entry);
+		uint16_t entryEpoch = (snapshot.isRebasing && entry < snapshot.rebaseEnd) ? (uint16_t)(snapshot.epoch - snapshot.rebaseShift) : snapshot.epoch;
+
+		return personalWord.count * Decay((uint16_t)(entryEpoch - personalWord.lastEpoch));
+	}
+
+	// Find a learned word, or return PD_NO_ENTRY
+	uint32_t PersonalDictionary::Find(const KPTUniCharT *word, size_t length) const
+	{
+		if (_words.Count() == 0 || length == 0 || length > MAX_WORD_LEN)
+		{
+			return PD_NO_ENTRY;
+		}
+
+		return Find(Lexicon::HashWord(word, length), word, length);
+	}
+
+	// Get the decayed count of a word, or zero if it hasn't been learned
+	float PersonalDictionary::GetCount(const KPTUniCharT *word, size_t length) const
+	{
+		uint32_t entry = Find(word, length);
+
+		return entry != PD_NO_ENTRY ? GetEntryCount(entry) : 0.0f;
+	}
+
+	// Get the count of a learned word, decayed to the current epoch
+	float PersonalDictionary::GetEntryCount(uint32_t entry) const
+	{
+		const PersonalWordT &personalWord = _words.Get(entry);
+
+		return personalWord.count * Decay((uint16_t)(GetEntryEpoch(entry) - personalWord.lastEpoch));
+	}
+
+	// Find the learned words that are longer than a prefix and start with it ignoring case, highest count first
+	void PersonalDictionary::FindCompletions(const KPTUniCharT *prefix, size_t length, size_t maxCount, std::vector<uint32_t> &entries) const
+	{
+		TopEntries best(entries, maxCount);
+		if (_words.Count() == 0 || length == 0 || maxCount == 0)
+		{
+			return;
+		}
+
+		// Decay is the same for words last updated in the same epoch, so compare counts in the current epoch
+		KPTUniCharT first = Lexicon::Fold(prefix[0]);
+		for (uint32_t entry = 0; entry < _words.Count(); entry++)
+		{
+			const PersonalWordT &personalWord = _words.Get(entry);
+			if (personalWord.length <= length || Lexicon::Fold(personalWord.text[0]) != first || !WordTable::IsMatch(personalWord.text, prefix, length))
+			{
+				continue;
+			}
+
+			best.Add(entry, GetEntryCount(entry));
+		}
+	}
+
+	// List a page of the learned words in one of the view orders, or return false if the order isn't recognised
+	bool PersonalDictionary::GetPage(KPTPDViewOptionT view, size_t first, size_t count, std::vector<uint32_t> &entries) const
+	{
+		switch (view)
+		{
+			case eKPTPDViewAlphaAscending:
+				_alphaIndex.GetRange(first, count, false, entries); break;
+			case eKPTPDViewAlphaDescending:
+				_alphaIndex.GetRange(first, count, true, entries); break;
+			case eKPTPDViewMostFrequentFirst:
+				_frequencyIndex.GetRange(first, count, true, entries); break;
+			case eKPTPDViewLeastFrequentFirst:
+				_frequencyIndex.GetRange(first, count, false, entries); break;
+			case eKPTPDViewNewestFirst:
+				_timeIndex.GetRange(first, count, true, entries); break;
+			case eKPTPDViewOldestFirst:
+				_timeIndex.GetRange(first, count, false, entries); break;
+			default:
+				entries.clear();
+				return false;
+		}
+
+		return true;
+	}
+
+	// Decide whether one word comes before another in an order, using the index to break ties
+	bool PersonalDictionary::IsBefore(PersonalOrderT order, uint32_t entryA, uint32_t entryB) const
+	{
+		const PersonalWordT &a = _words.Get(entryA);
+		const PersonalWordT &b = _words.Get(entryB);
+		switch (order)
+		{
+			case ePersonalOrderAlpha:
+				for (size_t i = 0; i < a.length && i < b.length; i++)
+				{
+					KPTUniCharT chA = Lexicon::Fold(a.text[i]);
+					KPTUniCharT chB = Lexicon::Fold(b.text[i]);
+					if (chA != chB)
+					{
+						return chA < chB;
+					}
+				}
+				if (a.length != b.length)
+				{
+					return a.length < b.length;
+				}
+				break;
+			case ePersonalOrderFrequency:
+				if (_frequencyKeys[entryA] != _frequencyKeys[entryB])
+				{
+					return _frequencyKeys[entryA] < _frequencyKeys[entryB];
+				}
+				break;
+			case ePersonalOrderTime:
+				if (a.firstLearned != b.firstLearned)
+				{
+					return a.firstLearned < b.firstLearned;
+				}
+				break;
+		}
+
+		return entryA < entryB;
+	}
+
+	// Look up a word, returning its index or PD_NO_ENTRY
+	uint32_t PersonalDictionary::Find(uint64_t hash, const KPTUniCharT *word, size_t length) const
+	{
+		for (size_t slot = _slots.GetHome(hash); _slots.GetEntry(slot) != PD_NO_ENTRY; slot = _slots.GetNext(slot))
+		{
+			uint32_t entry = _slots.GetEntry(slot);
+			const PersonalWordT &personalWord = _words.Get(entry);
+			if (_slots.IsHashMatch(slot, hash) && personalWord.hash == hash && personalWord.length == length && WordTable::IsMatch(personalWord.text, word, length))
+			{
+				return entry;
+			}
+		}
+
+		return PD_NO_ENTRY;
+	}
+
+	// Find a word or add it with a zero count, storing it as it was typed, and return its index or PD_NO_ENTRY
+	// When the dictionary is full, a new word replaces the clock's victim if it has been seen more often, or if forced
+	uint32_t PersonalDictionary::FindOrAdd(uint64_t hash, const KPTUniCharT *word, size_t length, uint32_t timestamp, bool isForced)
+	{
+		if (_words.Count() < _capacity && _slots.SlotCount() < 2 * (_words.Count() + 1))
+		{
+			Rehash((std::max)(_slots.SlotCount() * 2, (size_t)PD_MIN_SLOTS));
+		}
+
+		uint32_t entry = Find(hash, word, length);
+		bool isNew = entry == PD_NO_ENTRY;
+		if (!isNew)
+		{
+			_words.Edit(entry).isReferenced = true;
+		}
+		else
+		{
+			if (_words.Count() < _capacity)
+			{
+				entry = _words.Add();
+				_frequencyKeys.push_back(0.0);
+			}
+			else
+			{
+				entry = GetVictim();
+				if (!isForced && _sketch.Estimate(hash) <= _sketch.Estimate(_words.Get(entry).hash))
+				{
+					return PD_NO_ENTRY;
+				}
+
+				// Take over the victim's place, moving the clock hand on past it
+				_slots.Remove(entry, _words.Get(entry).hash);
+				UnindexWord(entry);
+				_clockHand = (_clockHand + 1) % _words.Count();
+			}
+			_slots.Insert(entry, hash);
+
+			PersonalWordT &newWord = _words.Edit(entry);
+			newWord.hash = hash;
+			newWord.count = 0.0f;
+			newWord.firstLearned = timestamp;
+			newWord.lastEpoch = GetEntryEpoch(entry);
+			newWord.isReferenced = false;
+		}
+
+		// Spelling changes only by case, which doesn't move the word in the alphabetical view
+		PersonalWordT &personalWord = _words.Edit(entry);
+		personalWord.length = (uint16_t)length;
+		wmemcpy(personalWord.text, word, length);
+		personalWord.text[length] = L'\0';
+		if (isNew)
+		{
+			SetFrequencyKey(entry);
+			IndexWord(entry);
+		}
+
+		return entry;
+	}
+
+	// Advance the clock hand to the first word not used since the hand last passed it, clearing the used flags on the way
+	uint32_t PersonalDictionary::GetVictim(void)
+	{
+		while (_words.Get((uint32_t)_clockHand).isReferenced)
+		{
+			_words.Edit((uint32_t)_clockHand).isReferenced = false;
+			_clockHand = (_clockHand + 1) % _words.Count();
+		}
+
+		return (uint32_t)_clockHand;
+	}
+
+	// Remove a word, moving the last word into its place
+	void PersonalDictionary::RemoveWord(uint32_t entry)
+	{
+		_slots.Remove(entry, _words.Get(entry).hash);
+		UnindexWord(entry);
+		uint32_t last = (uint32_t)_words.Count() - 1;
+		if (entry != last)
+		{
+			_slots.Renumber(last, entry, _words.Get(last).hash);
+
+			// The moved word is indexed by its position, so index it again
+			UnindexWord(last);
+			PersonalWordT lastWord = _words.Get(last);
+			_words.Edit(entry) = lastWord;
+			_frequencyKeys[entry] = _frequencyKeys[last];
+			IndexWord(entry);
+		}
+		_words.RemoveLast();
+		_frequencyKeys.pop_back();
+
+		if (_clockHand >= _words.Count())
+		{
+			_clockHand = 0;
+		}
+	}
+
+	// Add a word to the sorted views
+	void PersonalDictionary::IndexWord(uint32_t entry)
+	{
+		_alphaIndex.Insert(entry);
+		_frequencyIndex.Insert(entry);
+		_timeIndex.Insert(entry);
+	}
+
+	// Remove a word from the sorted views while it still has the keys it was indexed with
+	void PersonalDictionary::UnindexWord(uint32_t entry)
+	{
+		_alphaIndex.Erase(entry);
+		_frequencyIndex.Erase(entry);
+		_timeIndex.Erase(entry);
+	}
+
+	// Work out the key that ranks a word by frequency, i.e. its log count decayed back to absolute epoch zero
+	// Decay takes the same amount off every log count per epoch, so the keys of words keep their order as time passes
+	void PersonalDictionary::SetFrequencyKey(uint32_t entry)
+	{
+		double count = (std::max)((double)GetEntryCount(entry), (double)FLT_MIN);
+		_frequencyKeys[entry] = log(count) - (double)(_epochOrigin + _epoch) * log((double)PD_EPOCH_DECAY);
+	}
+
+	// Get the current epoch in the origin that a word's epoch is stored relative to
+	uint16_t PersonalDictionary::GetEntryEpoch(uint32_t entry) const
+	{
+		if (_isRebasing && entry < _rebaseEnd)
+		{
+			return (uint16_t)(_epoch - _rebaseShift);
+		}
+
+		return _epoch;
+	}
+
+	// Count a learned word, starting a new epoch every PD_EPOCH_WORDS words
+	void PersonalDictionary::AdvanceClock(void)
+	{
+		if (_isRebasing)
+		{
+			RebaseWords(PD_REBASE_BATCH);
+		}
+
+		if (++_epochWords < PD_EPOCH_WORDS)
+		{
+			return;
+		}
+		_epochWords = 0;
+		_epoch++;
+
+		// Start moving the words to an epoch origin of zero while there are still plenty of epochs left before overflow
+		if (!_isRebasing && _epoch >= PD_REBASE_EPOCH)
+		{
+			TRACE(_T("Rebasing %u learned words from epoch %u\n"), (unsigned)_words.Count(), (unsigned)_epoch);
+			_isRebasing = true;
+			_rebaseShift = _epoch;
+			_rebaseEnd = 0;
+		}
+	}
+
+	// Decay the counts of the next batch of words up to the current epoch and store them relative to the new origin
+	void PersonalDictionary::RebaseWords(size_t maxCount)
+	{
+		size_t end = (std::min)(_rebaseEnd + maxCount, _words.Count());
+		for (size_t entry = _rebaseEnd; entry < end; entry++)
+		{
+			PersonalWordT &personalWord = _words.Edit((uint32_t)entry);
+			personalWord.count *= Decay((uint16_t)(_epoch - personalWord.lastEpoch));
+			personalWord.lastEpoch = (uint16_t)(_epoch - _rebaseShift);
+		}
+		_rebaseEnd = end;
+
+		if (_rebaseEnd == _words.Count())
+		{
+			_epoch -= _rebaseShift;
+			_epochOrigin += _rebaseShift;
+			_isRebasing = false;
+			_rebaseShift = 0;
+			_rebaseEnd = 0;
+		}
+	}
+
+	// Rebuild the hash table with a power of two number of slots
+	void PersonalDictionary::Rehash(size_t slotCount)
+	{
+		_slots.Reset(slotCount);
+		for (uint32_t entry = 0; entry < _words.Count(); entry++)
+		{
+			_slots.Insert(entry, _words.Get(entry).hash);
+		}
+	}
+
+	// Get the factor that a count decays by over a number of epochs
+	float PersonalDictionary::Decay(uint32_t epochs)
+	{
+		return epochs == 0 ? 1.0f : powf(PD_EPOCH_DECAY, (float)epochs);
+	}
@@ -0,0 +1,106 @@
+#pragma once
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+
+#include <vector>
+#include "kptapi.h"
+#include "kptapi_personal.h"
+#include "CountMinSketch.h"
+#include "PersonalWordStore.h"
+#include "OrderIndex.h"
+#include "WordTable.h"
+
+	#define PD_NO_ENTRY WORD_TABLE_NO_ENTRY
+
+	// State of a personal dictionary at a moment, which shares the words with the dictionary
+	struct PersonalSnapshotT
+	{
+		PersonalWordStore words;
+		uint16_t epoch;
+		uint32_t epochWords;
+		bool isRebasing;
+		uint16_t rebaseShift;
+		size_t rebaseEnd;
+	};
+
+	// Counts of the words the user has typed while learning is on, decaying by a factor each epoch of PD_EPOCH_WORDS
+	// learned words so that the dictionary follows changes in the user's vocabulary. Rather than ageing every count
+	// each epoch, a word keeps the epoch when its count was last updated and the decay since then is applied when the
+	// count is read or updated. Epochs are stored in 16 bits to keep words small, so when the clock nears the top of
+	// its range the counts are rebased to a new epoch origin a batch at a time, with no pause while typing.
+	// The number of words is bounded by a capacity. When it is full, a CLOCK sweep over the words picks the next one
+	// not used since the hand last passed it, and a new word only replaces it if a frequency sketch of recent learning
+	// shows the new word has been seen more often (TinyLFU admission), so one-off words don't flush useful ones.
+	// The words are kept in a copy-on-write store, so that a snapshot can be taken for saving without copying them.
+	// The words are also kept in order-statistic trees by spelling, frequency and time first learned, so that any page
+	// of a sorted view of the dictionary can be listed straight away. Counts that decay at the same rate keep their order,
+	// so a word's frequency is ranked by its log count as at a fixed absolute epoch, which only changes when it's learned.
+	class PersonalDictionary
+	{
+	private:
+		PersonalWordStore _words;
+		WordTable _slots;						// Index of each word, at most half full
+		uint16_t _epoch;						// Current learning epoch
+		uint32_t _epochWords;					// Number of words learned in the current epoch
+		bool _isRebasing;
+		uint16_t _rebaseShift;					// Amount being subtracted from the epochs while rebasing
+		size_t _rebaseEnd;						// Words before this index have been rebased
+		size_t _capacity;
+		size_t _clockHand;
+		CountMinSketch _sketch;					// Recent learning frequency of words, whether or not they were admitted
+		uint64_t _epochOrigin;					// Epochs removed by rebasing, so that _epochOrigin + _epoch is the absolute epoch
+		std::vector<double> _frequencyKeys;		// Log count of each word decayed to absolute epoch zero
+		OrderIndex _alphaIndex;
+		OrderIndex _frequencyIndex;
+		OrderIndex _timeIndex;
+
+	public:
+		PersonalDictionary(void);
+		~PersonalDictionary(void);
+
+		void Clear(void);
+		void SetCapacity(size_t capacity);
+		size_t Capacity(void) const { return _capacity; }
+		size_t Count(void) const { return _words.Count(); }
+		uint16_t Epoch(void) const { return _epoch; }
+		uint32_t EpochWords(void) const { return _epochWords; }
+		void SetClock(uint16_t epoch, uint32_t epochWords);
+
+		void AddWord(const KPTUniCharT *word, size_t length, float delta, uint32_t timestamp);
+		void LoadWord(const KPTUniCharT *word, size_t length, float count, uint32_t firstLearned);
+		void Snapshot(PersonalSnapshotT &snapshot);
+		static float GetSnapshotCount(const PersonalSnapshotT &snapshot, uint32_t entry);
+		uint32_t Find(const KPTUniCharT *word, size_t length) const;
+		float GetCount(const KPTUniCharT *word, size_t length) const;
+		float GetEntryCount(uint32_t entry) const;
+		const KPTUniCharT *GetText(uint32_t entry) const { return _words.Get(entry).text; }
+		size_t GetLength(uint32_t entry) const { return _words.Get(entry).length; }
+		void FindCompletions(const KPTUniCharT *prefix, size_t length, size_t maxCount, std::vector<uint32_t> &entries) const;
+		bool GetPage(KPTPDViewOptionT view, size_t first, size_t count, std::vector<uint32_t> &entries) const;
+		bool IsBefore(PersonalOrderT order, uint32_t entryA, uint32_t entryB) const;
+
+	private:
+		uint32_t Find(uint64_t hash, const KPTUniCharT *word, size_t length) const;
+		uint32_t FindOrAdd(uint64_t hash, const KPTUniCharT *word, size_t length, uint32_t timestamp, bool isForced);
+		uint32_t GetVictim(void);
+		void RemoveWord(uint32_t entry);
+		void IndexWord(uint32_t entry);
+		void UnindexWord(uint32_t entry);
+		void SetFrequencyKey(uint32_t entry);
+		uint16_t GetEntryEpoch(uint32_t entry) const;
+		void AdvanceClock(void);
+		void RebaseWords(size_t maxCount);
+		void Rehash(size_t slotCount);
+		static float Decay(uint32_t epochs);
+	};
@@ -0,0 +1,338 @@
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+#include "stdafx.h"
+#include <algorithm>
+#include "Lexicon.h"
+#include "PersonalImage.h"
+
+	// Constructor
+	PersonalImage::PersonalImage(void)
+	{
+		Close();
+	}
+
+	// Destructor
+	PersonalImage::~PersonalImage(void)
+	{
+	}
+
+	// Map a saved personal dictionary and check its header and block table
+	bool PersonalImage::Open(const KPTSysCharT *pFilePath)
+	{
+		Close();
+		if (!_file.Open(pFilePath) || _file.Size() < sizeof(PersonalImageHeaderT))
+		{
+			Close();
+			return false;
+		}
+
+		memcpy(&_header, _file.Data(), sizeof(_header));
+		size_t blockCount = (_header.wordCount + PD_IMAGE_BLOCK_WORDS - 1) / PD_IMAGE_BLOCK_WORDS;
+		size_t tableSize = (blockCount + 1) * sizeof(uint32_t);
+		_pOffsets = _file.Data() + sizeof(_header);
+		if (_header.magic != PD_IMAGE_MAGIC || _header.version != PD_BLOCKED_IMAGE_VERSION ||
+			_file.Size() - sizeof(_header) < tableSize ||
+			LearningLog::Checksum(_pOffsets, tableSize) != _header.checksum)
+		{
+			TRACE(_T("Ignoring invalid personal dictionary %s\n"), pFilePath);
+			Close();
+			return false;
+		}
+
+		uint32_t blocksSize;
+		memcpy(&blocksSize, _pOffsets + blockCount * sizeof(uint32_t), sizeof(blocksSize));
+		if (blocksSize > _file.Size() - sizeof(_header) - tableSize)
+		{
+			Close();
+			return false;
+		}
+		_pBlocks = _pOffsets + tableSize;
+		_blockCount = blockCount;
+
+		return true;
+	}
+
+	// Unmap the file
+	void PersonalImage::Close(void)
+	{
+		_file.Close();
+		memset(&_header, 0, sizeof(_header));
+		_pOffsets = NULL;
+		_pBlocks = NULL;
+		_blockCount = 0;
+	}
+
+	// Decode the words of a block, or return false if it is damaged
+	bool PersonalImage::ReadBlock(size_t block, std::vector<PersonalImageEntryT> &entries) const
+	{
+		entries.clear();
+		const uint8_t *pData;
+		const uint8_t *pEnd;
+		if (!GetBlock(block, pData, pEnd))
+		{
+			return false;
+		}
+
+		// The checksum covers the rest of the block
+		uint32_t checksum;
+		memcpy(&checksum, pData, sizeof(checksum));
+		pData += sizeof(checksum);
+		if (LearningLog::Checksum(pData, pEnd - pData) != checksum)
+		{
+			TRACE(_T("Damaged block %u in personal dictionary\n"), (unsigned)block);
+			return false;
+		}
+
+		uint32_t wordCount = *pData++;
+		PersonalImageEntryT entry;
+		if (wordCount == 0 || wordCount > PD_IMAGE_BLOCK_WORDS || !ReadFirstWord(pData, pEnd, entry) ||
+			pEnd - pData < (ptrdiff_t)(wordCount * sizeof(float)))
+		{
+			return false;
+		}
+		entries.assign(wordCount, entry);
+
+		for (uint32_t i = 0; i < wordCount; i++)
+		{
+			memcpy(&entries[i].count, pData, sizeof(float));
+			pData += sizeof(float);
+		}
+
+		// Times first learned are zigzag-encoded differences from the previous word's
+		uint32_t time;
+		if (!GetVarint(pData, pEnd, time))
+		{
+			return false;
+		}
+		entries[0].firstLearned = time;
+		for (uint32_t i = 1; i < wordCount; i++)
+		{
+			uint32_t delta;
+			if (!GetVarint(pData, pEnd, delta))
+			{
+				return false;
+			}
+			time += (delta >> 1) ^ (0 - (delta & 1));
+			entries[i].firstLearned = time;
+		}
+
+		// Each later word keeps a prefix of the word before and adds a suffix
+		for (uint32_t i = 1; i < wordCount; i++)
+		{
+			uint32_t prefixLength;
+			uint32_t suffixLength;
+			if (!GetVarint(pData, pEnd, prefixLength) || !GetVarint(pData, pEnd, suffixLength) ||
+				prefixLength > entries[i - 1].length || prefixLength + suffixLength > MAX_WORD_LEN)
+			{
+				return false;
+			}
+			PersonalImageEntryT &current = entries[i];
+			wmemcpy(current.text, entries[i - 1].text, prefixLength);
+			for (uint32_t j = 0; j < suffixLength; j++)
+			{
+				uint32_t ch;
+				if (!GetVarint(pData, pEnd, ch))
+				{
+					return false;
+				}
+				current.text[prefixLength + j] = (KPTUniCharT)ch;
+			}
+			current.length = (uint16_t)(prefixLength + suffixLength);
+			current.text[current.length] = L'\0';
+		}
+
+		return true;
+	}
+
+	// Write a snapshot of a personal dictionary, with the counts decayed to the snapshot's epoch, and flush it to disk
+	bool PersonalImage::Write(const KPTSysCharT *pFilePath, const PersonalSnapshotT &snapshot, uint32_t generation)
+	{
+		// Sort the words ignoring case
+		std::vector<uint32_t> order(snapshot.words.Count());
+		for (uint32_t entry = 0; entry < order.size(); entry++)
+		{
+			order[entry] = entry;
+		}
+		std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b)
+		{
+			const PersonalWordT &wordA = snapshot.words.Get(a);
+			const PersonalWordT &wordB = snapshot.words.Get(b);
+			return Compare(wordA.text, wordA.length, wordB.text, wordB.length) < 0;
+		});
+
+		std::vector<uint32_t> offsets;
+		std::vector<uint8_t> blocks;
+		std::vector<uint8_t> block;
+		for (size_t first = 0; first < order.size(); first += PD_IMAGE_BLOCK_WORDS)
+		{
+			size_t end = (std::min)(first + PD_IMAGE_BLOCK_WORDS, order.size());
+			block.clear();
+			block.push_back((uint8_t)(end - first));
+
+			const PersonalWordT &firstWord = snapshot.words.Get(order[first]);
+			PutVarint(block, firstWord.length);
+			for (size_t j = 0; j < firstWord.length; j++)
+			{
+				PutVarint(block, firstWord.text[j]);
+			}
+
+			for (size_t i = first; i < end; i++)
+			{
+				float count = PersonalDictionary::GetSnapshotCount(snapshot, order[i]);
+				const uint8_t *pCount = (const uint8_t *)&count;
+				block.insert(block.end(), pCount, pCount + sizeof(count));
+			}
+
+			PutVarint(block, firstWord.firstLearned);
+			for (size_t i = first + 1; i < end; i++)
+			{
+				int32_t delta = (int32_t)(snapshot.words.Get(order[i]).firstLearned - snapshot.words.Get(order[i - 1]).firstLearned);
+				PutVarint(block, ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31));
+			}
+
+			for (size_t i = first + 1; i < end; i++)
+			{
+				const PersonalWordT &previous = snapshot.words.Get(order[i - 1]);
+				const PersonalWordT &current = snapshot.words.Get(order[i]);
+				size_t prefixLength = 0;
+				while (prefixLength < previous.length && prefixLength < current.length && previous.text[prefixLength] == current.text[prefixLength])
+				{
+					prefixLength++;
+				}
+				PutVarint(block, (uint32_t)prefixLength);
+				PutVarint(block, (uint32_t)(current.length - prefixLength));
+				for (size_t j = prefixLength; j < current.length; j++)
+				{
+					PutVarint(block, current.text[j]);
+				}
+			}
+
+			offsets.push_back((uint32_t)blocks.size());
+			uint32_t checksum = LearningLog::Checksum(block.data(), block.size());
+			const uint8_t *pChecksum = (const uint8_t *)&checksum;
+			blocks.insert(blocks.end(), pChecksum, pChecksum + sizeof(checksum));
+			blocks.insert(blocks.end(), block.begin(), block.end());
+		}
+		offsets.push_back((uint32_t)blocks.size());
+
+		PersonalImageHeaderT header = { PD_IMAGE_MAGIC, PD_BLOCKED_IMAGE_VERSION, generation,
+			LearningLog::Checksum(offsets.data(), offsets.size() * sizeof(uint32_t)),
+			(uint32_t)order.size(), snapshot.epochWords, snapshot.epoch, 0 };
+		HANDLE hFile = CreateFileW(pFilePath, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (hFile == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+		DWORD written = 0;
+		bool success = WriteFile(hFile, &header, sizeof(header), &written, NULL) && written == sizeof(header) &&
+			WriteFile(hFile, offsets.data(), (DWORD)(offsets.size() * sizeof(uint32_t)), &written, NULL) && written == offsets.size() * sizeof(uint32_t) &&
+			WriteFile(hFile, blocks.data(), (DWORD)blocks.size(), &written, NULL) && written == blocks.size() &&
+			FlushFileBuffers(hFile);
+		CloseHandle(hFile);
+
+		return success;
+	}
+
+	// Get the bytes of a block
+	bool PersonalImage::GetBlock(size_t block, const uint8_t *&pData, const uint8_t *&pEnd) const
+	{
+		if (block >= _blockCount)
+		{
+			return false;
+		}
+
+		uint32_t start;
+		uint32_t end;
+		memcpy(&start, _pOffsets + block * sizeof(uint32_t), sizeof(start));
+		memcpy(&end, _pOffsets + (block + 1) * sizeof(uint32_t), sizeof(end));
+		uint32_t blocksSize;
+		memcpy(&blocksSize, _pOffsets + _blockCount * sizeof(uint32_t), sizeof(blocksSize));
+		if (start > end || end > blocksSize || end - start < sizeof(uint32_t))
+		{
+			return false;
+		}
+		pData = _pBlocks + start;
+		pEnd = _pBlocks + end;
+
+		return true;
+	}
+
+	// Decode the first word of a block, which is stored in full
+	bool PersonalImage::ReadFirstWord(const uint8_t *&pData, const uint8_t *pEnd, PersonalImageEntryT &entry)
+	{
+		uint32_t length;
+		if (!GetVarint(pData, pEnd, length) || length == 0 || length > MAX_WORD_LEN)
+		{
+			return false;
+		}
+		for (uint32_t j = 0; j < length; j++)
+		{
+			uint32_t ch;
+			if (!GetVarint(pData, pEnd, ch))
+			{
+				return false;
+			}
+			entry.text[j] = (KPTUniCharT)ch;
+		}
+		entry.length = (uint16_t)length;
+		entry.text[length] = L'\0';
+		entry.count = 0.0f;
+		entry.firstLearned = 0;
+
+		return true;
+	}
+
+	// Compare two words ignoring case
+	int PersonalImage::Compare(const KPTUniCharT *wordA, size_t lengthA, const KPTUniCharT *wordB, size_t lengthB)
+	{
+		for (size_t i = 0; i < lengthA && i < lengthB; i++)
+		{
+			KPTUniCharT chA = Lexicon::Fold(wordA[i]);
+			KPTUniCharT chB = Lexicon::Fold(wordB[i]);
+			if (chA != chB)
+			{
+				return chA < chB ? -1 : 1;
+			}
+		}
+
+		return lengthA == lengthB ? 0 : (lengthA < lengthB ? -1 : 1);
+	}
+
+	// Append a number in 7-bit groups, least significant first, with the top bit set on all but the last
+	void PersonalImage::PutVarint(std::vector<uint8_t> &data, uint32_t value)
+	{
+		while (value >= 0x80)
+		{
+			data.push_back((uint8_t)(value | 0x80));
+			value >>= 7;
+		}
+		data.push_back((uint8_t)value);
+	}
+
+	// Read a number written by PutVarint, or return false if it runs past the end
+	bool PersonalImage::GetVarint(const uint8_t *&pData, const uint8_t *pEnd, uint32_t &value)
+	{
+		value = 0;
+		for (int shift = 0; shift < 35 && pData < pEnd; shift += 7)
+		{
+			uint8_t byte = *pData++;
+			value |= (uint32_t)(byte & 0x7F) << shift;
+			if ((byte & 0x80) == 0)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
@@ -0,0 +1,64 @@
+#pragma once
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+
+#include <vector>
+#include "kptapi.h"
+#include "MappedFile.h"
+#include "LearningLog.h"
+
+	#define PD_BLOCKED_IMAGE_VERSION 2
+
+	// A word decoded from a saved personal dictionary
+	struct PersonalImageEntryT
+	{
+		float count;			// Count as of the saved epoch
+		uint32_t firstLearned;
+		uint16_t length;
+		KPTUniCharT text[MAX_WORD_LEN + 1];
+	};
+
+	// Compact saved personal dictionary, memory-mapped and decoded a block at a time when it is loaded.
+	// The words are sorted ignoring case and stored in blocks of PD_IMAGE_BLOCK_WORDS. Each block starts with its
+	// checksum, its first word in full, the counts of its words and their times first learned as a base and varint
+	// deltas, followed by the rest of its words front-coded against the word before, with characters as varints.
+	// A table of block offsets after the file header locates each block.
+	class PersonalImage
+	{
+	private:
+		MappedFile _file;
+		PersonalImageHeaderT _header;
+		const uint8_t *_pOffsets;				// Offset of each block from the start of the blocks, and the end of the last block
+		const uint8_t *_pBlocks;
+		size_t _blockCount;
+
+	public:
+		PersonalImage(void);
+		~PersonalImage(void);
+
+		bool Open(const KPTSysCharT *pFilePath);
+		void Close(void);
+		const PersonalImageHeaderT &Header(void) const { return _header; }
+		size_t BlockCount(void) const { return _blockCount; }
+		bool ReadBlock(size_t block, std::vector<PersonalImageEntryT> &entries) const;
+
+		static bool Write(const KPTSysCharT *pFilePath, const PersonalSnapshotT &snapshot, uint32_t generation);
+
+	private:
+		bool GetBlock(size_t block, const uint8_t *&pData, const uint8_t *&pEnd) const;
+		static bool ReadFirstWord(const uint8_t *&pData, const uint8_t *pEnd, PersonalImageEntryT &entry);
+		static int Compare(const KPTUniCharT *wordA, size_t lengthA, const KPTUniCharT *wordB, size_t lengthB);
+		static void PutVarint(std::vector<uint8_t> &data, uint32_t value);
+		static bool GetVarint(const uint8_t *&pData, const uint8_t *pEnd, uint32_t &value);
+	};
@@ -0,0 +1,99 @@
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+#include "stdafx.h"
+#include "PersonalWordStore.h"
+
+	// Constructor
+	PersonalWordStore::PersonalWordStore(void)
+	{
+		_generation = 0;
+		Clear();
+	}
+
+	// Destructor
+	PersonalWordStore::~PersonalWordStore(void)
+	{
+	}
+
+	// Remove all the words, leaving any snapshots as they are
+	void PersonalWordStore::Clear(void)
+	{
+		_pages = std::make_shared<PersonalPageListT>();
+		_directoryGeneration = _generation;
+		_count = 0;
+	}
+
+	// Share the words with a snapshot, so that they are copied before they are next changed
+	void PersonalWordStore::Snapshot(PersonalWordStore &snapshot)
+	{
+		snapshot._pages = _pages;
+		snapshot._count = _count;
+		snapshot._generation = _generation;
+		snapshot._directoryGeneration = _directoryGeneration;
+		_generation++;
+	}
+
+	// Get a word to change, first copying its page if it may be in a snapshot
+	PersonalWordT &PersonalWordStore::Edit(uint32_t entry)
+	{
+		OwnDirectory();
+		std::shared_ptr<PersonalPageT> &page = (*_pages)[entry / PD_PAGE_WORDS];
+		if (page->generation != _generation)
+		{
+			page = std::make_shared<PersonalPageT>(*page);
+			page->generation = _generation;
+		}
+
+		return page->words[entry % PD_PAGE_WORDS];
+	}
+
+	// Add a word at the end, starting a new page if need be, and return its index
+	uint32_t PersonalWordStore::Add(void)
+	{
+		OwnDirectory();
+		if (_count % PD_PAGE_WORDS == 0)
+		{
+			_pages->push_back(std::make_shared<PersonalPageT>());
+			_pages->back()->generation = _generation;
+		}
+		uint32_t entry = (uint32_t)_count++;
+		Edit(entry) = PersonalWordT();
+
+		return entry;
+	}
+
+	// Remove the last word, releasing its page if it was the only word on it
+	void PersonalWordStore::RemoveLast(void)
+	{
+		if (_count == 0)
+		{
+			return;
+		}
+
+		if (--_count % PD_PAGE_WORDS == 0)
+		{
+			OwnDirectory();
+			_pages->pop_back();
+		}
+	}
+
+	// Copy the directory if it may be in a snapshot, which leaves the pages shared
+	void PersonalWordStore::OwnDirectory(void)
+	{
+		if (_directoryGeneration != _generation)
+		{
+			_pages = std::make_shared<PersonalPageListT>(*_pages);
+			_directoryGeneration = _generation;
+		}
+	}
@@ -0,0 +1,70 @@
+#pragma once
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+
+#include <vector>
+#include <memory>
+#include "kptapi.h"
+
+	// A word learned from the user's typing
+	struct PersonalWordT
+	{
+		uint64_t hash;			// Hash of the case-folded word
+		float count;			// Count of the word as of lastEpoch
+		uint32_t firstLearned;	// Time when the word was first learned
+		uint16_t lastEpoch;		// Learning epoch when the count was last brought up to date
+		uint16_t length;		// Number of characters, excluding NULL
+		bool isReferenced;		// Whether the word has been used since the clock hand last passed it
+		KPTUniCharT text[MAX_WORD_LEN + 1];	// Word as it was last typed
+	};
+
+	// A fixed-size page of learned words
+	struct PersonalPageT
+	{
+		uint32_t generation;	// Snapshot generation of the store when the page was created or copied
+		PersonalWordT words[PD_PAGE_WORDS];
+	};
+
+	typedef std::vector<std::shared_ptr<PersonalPageT> > PersonalPageListT;
+
+	// Array of learned words that can take a consistent snapshot in O(1), e.g. for a background thread to save while the
+	// user carries on typing. The words are kept in pages listed in a directory, and a snapshot shares the directory and
+	// the pages. Each snapshot starts a new generation, and a page or directory from an earlier generation is copied
+	// before it is changed, so a snapshot never changes and only the pages written to afterwards are duplicated.
+	// Only the thread that owns the store may change it or take snapshots, though snapshots may be read and released on any thread.
+	class PersonalWordStore
+	{
+	private:
+		std::shared_ptr<PersonalPageListT> _pages;
+		size_t _count;
+		uint32_t _generation;
+		uint32_t _directoryGeneration;
+
+	public:
+		PersonalWordStore(void);
+		~PersonalWordStore(void);
+
+		void Clear(void);
+		void Snapshot(PersonalWordStore &snapshot);
+		size_t Count(void) const { return _count; }
+		const PersonalWordT &Get(uint32_t entry) const { return (*_pages)[entry / PD_PAGE_WORDS]->words[entry % PD_PAGE_WORDS]; }
+		PersonalWordT &Edit(uint32_t entry);
+		uint32_t Add(void);
+		void RemoveLast(void);
+
+	private:
+		PersonalWordStore(const PersonalWordStore &);
+		PersonalWordStore &operator=(const PersonalWordStore &);
+		void OwnDirectory(void);
+	};
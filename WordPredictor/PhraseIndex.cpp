@@ -0,0 +1,273 @@
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+#include "stdafx.h"
+#include <algorithm>
+#include "Lexicon.h"
+#include "PhraseIndex.h"
+
+	// Get the case-folded character at a depth of a phrase, for building the trie
+	static uint32_t GetPhraseSymbol(uint32_t phraseId, size_t depth, intptr_t context)
+	{
+		const PhraseIndex *pIndex = (const PhraseIndex *)context;
+
+		return depth < pIndex->GetPhrase(phraseId).length ? Lexicon::Fold(pIndex->GetText(phraseId)[depth]) : SORTED_TRIE_END;
+	}
+
+	// Constructor
+	PhraseIndex::PhraseIndex(void)
+	{
+	}
+
+	// Destructor
+	PhraseIndex::~PhraseIndex(void)
+	{
+	}
+
+	// Load the phrase lists for a comma-delimited list of dictionaries in priority order e.g. enggb,frefr
+	bool PhraseIndex::Load(const KPTSysCharT *pBasePath, const KPTUniCharT *dictList)
+	{
+		Clear();
+
+		// Copy token list string into modifiable string
+		KPTUniCharT *nextToken;
+		KPTUniCharT dictListCopy[MAX_STR_LEN];
+		wcsncpy_s(dictListCopy, dictList, MAX_STR_LEN);
+
+		// Load the phrase list of each dictionary
+		uint16_t priority = 0;
+		KPTSysCharT filePath[MAX_PATH];
+		KPTUniCharT *token = wcstok_s(dictListCopy, _T(","), &nextToken);
+		while (token != NULL)
+		{
+			swprintf_s(filePath, MAX_PATH, _T("%s\\%s\\%s%s"), pBasePath, LEXICON_FOLDER, token, PHRASE_FILE_SUFFIX);
+			if (LoadPhraseList(filePath, priority))
+			{
+				TRACE(_T("Loaded phrase list %s\n"), filePath);
+			}
+			priority++;
+
+			token = wcstok_s(NULL, _T(","), &nextToken);
+		}
+
+		if (_phrases.empty())
+		{
+			return false;
+		}
+
+		BuildTrie();
+		TRACE(_T("Phrase index has %u phrases and %u nodes\n"), (unsigned)_phrases.size(), (unsigned)_nodes.size());
+
+		return true;
+	}
+
+	// Release the phrases and trie
+	void PhraseIndex::Clear(void)
+	{
+		std::vector<KPTUniCharT>().swap(_chars);
+		std::vector<PhraseT>().swap(_phrases);
+		std::vector<PhraseNodeT>().swap(_nodes);
+	}
+
+	// Find the node reached by some text, ignoring case
+	uint32_t PhraseIndex::FindPrefix(const KPTUniCharT *text, size_t length) const
+	{
+		if (_nodes.empty())
+		{
+			return PHRASE_NO_NODE;
+		}
+
+		uint32_t nodeIndex = PHRASE_ROOT;
+		for (size_t i = 0; i < length && nodeIndex != PHRASE_NO_NODE; i++)
+		{
+			nodeIndex = FindChild(nodeIndex, text[i]);
+		}
+
+		return nodeIndex;
+	}
+
+	// Find the child of a node for the specified character
+	uint32_t PhraseIndex::FindChild(uint32_t nodeIndex, KPTUniCharT ch) const
+	{
+		return SortedTrie::FindChild(_nodes, nodeIndex, &PhraseNodeT::ch, Lexicon::Fold(ch));
+	}
+
+	// Read a phrase list file
+	bool PhraseIndex::LoadPhraseList(const KPTSysCharT *pFilePath, uint16_t priority)
+	{
+		FILE *pFile = NULL;
+		if (0 != _wfopen_s(&pFile, pFilePath, _T("rt, ccs=UTF-8")) || pFile == NULL)
+		{
+			return false;
+		}
+
+		KPTUniCharT line[MAX_STR_LEN];
+		while (fgetws(line, MAX_STR_LEN, pFile) != NULL)
+		{
+			// Split into phrase and optional frequency
+			uint32_t frequency = 1;
+			size_t length = wcscspn(line, _T("\t\r\n"));
+			if (line[length] == L'\t')
+			{
+				frequency = wcstoul(&line[length + 1], NULL, 10);
+			}
+
+			AddPhrase(line, length, priority, frequency);
+		}
+
+		fclose(pFile);
+
+		return true;
+	}
+
+	// Add a phrase to the character pool, with its words separated by single spaces
+	void PhraseIndex::AddPhrase(const KPTUniCharT *text, size_t length, uint16_t priority, uint32_t frequency)
+	{
+		PhraseT entry;
+		entry.textOffset = (uint32_t)_chars.size();
+		entry.priority = priority;
+		entry.frequency = frequency;
+
+		size_t wordCount = 0;
+		bool isSpace = true;
+		for (size_t i = 0; i < length; i++)
+		{
+			if (text[i] != L' ')
+			{
+				if (isSpace && wordCount++ != 0)
+				{
+					_chars.push_back(L' ');
+				}
+				_chars.push_back(text[i]);
+			}
+			isSpace = text[i] == L' ';
+		}
+
+		// Single words are completed by the lexicon
+		entry.length = (uint16_t)(_chars.size() - entry.textOffset);
+		if (wordCount < 2 || entry.length > MAX_PHRASE_LEN)
+		{
+			_chars.resize(entry.textOffset);
+			return;
+		}
+
+		_chars.push_back(L'\0');
+		_phrases.push_back(entry);
+	}
+
+	// Decide whether one phrase should be suggested before another
+	bool PhraseIndex::IsBetter(uint32_t phraseA, uint32_t phraseB) const
+	{
+		if (_phrases[phraseA].priority != _phrases[phraseB].priority)
+		{
+			return _phrases[phraseA].priority < _phrases[phraseB].priority;
+		}
+
+		return _phrases[phraseA].frequency > _phrases[phraseB].frequency;
+	}
+
+	// Build the trie from the phrase list
+	void PhraseIndex::BuildTrie(void)
+	{
+		// Sort the phrases by their folded text, best entry first where the same phrase is listed more than once
+		std::vector<uint32_t> order(_phrases.size());
+		for (uint32_t i = 0; i < order.size(); i++)
+		{
+			order[i] = i;
+		}
+		std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b)
+		{
+			const KPTUniCharT *pA = GetText(a);
+			const KPTUniCharT *pB = GetText(b);
+			while (*pA != L'\0' && Lexicon::Fold(*pA) == Lexicon::Fold(*pB))
+			{
+				pA++;
+				pB++;
+			}
+			if (Lexicon::Fold(*pA) != Lexicon::Fold(*pB))
+			{
+				return Lexicon::Fold(*pA) < Lexicon::Fold(*pB);
+			}
+			return IsBetter(a, b);
+		});
+
+		// Rebuild the pool with one entry per phrase so that phrase ids are dense and in sorted order
+		std::vector<KPTUniCharT> chars;
+		std::vector<PhraseT> phrases;
+		for (size_t i = 0; i < order.size(); i++)
+		{
+			const PhraseT &entry = _phrases[order[i]];
+			const KPTUniCharT *pText = GetText(order[i]);
+			if (!phrases.empty() && phrases.back().length == entry.length &&
+				std::equal(pText, pText + entry.length, &chars[phrases.back().textOffset],
+					[](KPTUniCharT a, KPTUniCharT b) { return Lexicon::Fold(a) == Lexicon::Fold(b); }))
+			{
+				continue;
+			}
+
+			PhraseT newEntry = entry;
+			newEntry.textOffset = (uint32_t)chars.size();
+			phrases.push_back(newEntry);
+			chars.insert(chars.end(), pText, pText + entry.length + 1);
+		}
+		_chars.swap(chars);
+		_phrases.swap(phrases);
+
+		// Build the trie, with at most one phrase ending at each node now that the phrases are distinct
+		std::vector<SortedTrieNodeT> trie;
+		SortedTrie::Build((uint32_t)_phrases.size(), GetPhraseSymbol, (intptr_t)this, trie);
+		_nodes.resize(trie.size());
+		for (size_t i = 0; i < trie.size(); i++)
+		{
+			PhraseNodeT &node = _nodes[i];
+			node.ch = (KPTUniCharT)trie[i].symbol;
+			node.childCount = (uint16_t)trie[i].childCount;
+			node.firstChild = trie[i].firstChild;
+			std::fill(node.best, node.best + MAX_PHRASE_COMPLETIONS, PHRASE_NO_PHRASE);
+		}
+
+		// Record the best phrases in each subtree by merging the lists of its children, working upwards from the leaves
+		for (size_t i = _nodes.size(); i-- > 0; )
+		{
+			PhraseNodeT &node = _nodes[i];
+			if (trie[i].endCount != 0)
+			{
+				AddBest(node, trie[i].first);
+			}
+			for (uint32_t child = node.firstChild; child < node.firstChild + node.childCount; child++)
+			{
+				for (size_t j = 0; j < MAX_PHRASE_COMPLETIONS && _nodes[child].best[j] != PHRASE_NO_PHRASE; j++)
+				{
+					AddBest(node, _nodes[child].best[j]);
+				}
+			}
+		}
+	}
+
+	// Insert a phrase into a node's list of best phrases if it is good enough
+	void PhraseIndex::AddBest(PhraseNodeT &node, uint32_t phraseId) const
+	{
+		size_t j = MAX_PHRASE_COMPLETIONS;
+		while (j > 0 && (node.best[j - 1] == PHRASE_NO_PHRASE || IsBetter(phraseId, node.best[j - 1])))
+		{
+			if (j < MAX_PHRASE_COMPLETIONS)
+			{
+				node.best[j] = node.best[j - 1];
+			}
+			j--;
+		}
+		if (j < MAX_PHRASE_COMPLETIONS)
+		{
+			node.best[j] = phraseId;
+		}
+	}
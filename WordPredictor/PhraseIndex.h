@@ -0,0 +1,77 @@
+#pragma once
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+
+#include <vector>
+#include "kptapi.h"
+#include "SortedTrie.h"
+
+	#define PHRASE_NO_NODE SORTED_TRIE_NO_NODE
+	#define PHRASE_NO_PHRASE 0xFFFFFFFF
+	#define PHRASE_ROOT SORTED_TRIE_ROOT
+
+	// A multi-word phrase
+	struct PhraseT
+	{
+		uint32_t textOffset;	// Offset of the phrase in the character pool
+		uint16_t length;		// Number of characters, excluding NULL
+		uint16_t priority;		// Priority of the highest priority dictionary containing the phrase (0 = highest)
+		uint32_t frequency;		// Frequency count
+	};
+
+	// A node in the phrase trie
+	// Trie characters are lower case and the children of a node are contiguous and sorted by character
+	struct PhraseNodeT
+	{
+		KPTUniCharT ch;			// Character on the edge into this node
+		uint16_t childCount;	// Number of children
+		uint32_t firstChild;	// Index of the first child
+		uint32_t best[MAX_PHRASE_COMPLETIONS];	// Best phrases in this node's subtree, best first, padded with PHRASE_NO_PHRASE
+	};
+
+	// Index of frequent word sequences for completing several words in one selection
+	// Each node of the character trie keeps its subtree's best phrases, so the completions of any typed text are
+	// found by walking the text and reading one node, without visiting the subtree.
+	// Phrase lists are UTF-8 text files in the Lexicon folder named after the dictionary e.g. enggb_phrases.txt,
+	// with one phrase per line in the form word1 word2[ ...][<tab>frequency].
+	class PhraseIndex
+	{
+	private:
+		std::vector<KPTUniCharT> _chars;
+		std::vector<PhraseT> _phrases;
+		std::vector<PhraseNodeT> _nodes;
+
+	public:
+		PhraseIndex(void);
+		~PhraseIndex(void);
+
+		bool Load(const KPTSysCharT *pBasePath, const KPTUniCharT *dictList);
+		void Clear(void);
+		bool IsLoaded(void) const { return !_nodes.empty(); }
+
+		size_t PhraseCount(void) const { return _phrases.size(); }
+		const PhraseT &GetPhrase(uint32_t phraseId) const { return _phrases[phraseId]; }
+		const KPTUniCharT *GetText(uint32_t phraseId) const { return &_chars[_phrases[phraseId].textOffset]; }
+
+		uint32_t FindPrefix(const KPTUniCharT *text, size_t length) const;
+		const uint32_t *GetBest(uint32_t nodeIndex) const { return _nodes[nodeIndex].best; }
+
+	private:
+		bool LoadPhraseList(const KPTSysCharT *pFilePath, uint16_t priority);
+		void AddPhrase(const KPTUniCharT *text, size_t length, uint16_t priority, uint32_t frequency);
+		uint32_t FindChild(uint32_t nodeIndex, KPTUniCharT ch) const;
+		bool IsBetter(uint32_t phraseA, uint32_t phraseB) const;
+		void AddBest(PhraseNodeT &node, uint32_t phraseId) const;
+		void BuildTrie(void);
+	};
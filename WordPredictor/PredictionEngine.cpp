@@ -0,0 +1,914 @@
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+#include "stdafx.h"
+#include <wctype.h>
+#include <time.h>
+#include <algorithm>
+#include "kptapi_suggtypes.h"
+#include "PredictionEngine.h"
+
+	// Constructor
+	PredictionEngine::PredictionEngine(void)
+	{
+		_errorCorrectionOn = false;
+		_learningOn = false;
+		_keyEnd = 0;
+		_phraseCompletions = 0;
+		_indexMaxDistance = 0;
+		_indexPrefixLength = DEFAULT_DELETION_INDEX_PREFIX_LEN;
+		_sessionCache.SetCapacity(SESSION_CACHE_SIZE);
+		_candidateSketch.SetSize(PD_CANDIDATE_SKETCH_WIDTH, PD_CANDIDATE_RESET_INTERVAL);
+		_personalCapacity = PD_DEFAULT_CAPACITY;
+		_pPartition = OpenPartition(_T(""));
+		_pDictionaries.reset(new DictionarySetT);
+		_fuzzyMatcher.SetLexicon(&_pDictionaries->lexicon);
+		_segmenter.SetLexicon(&_pDictionaries->lexicon);
+	}
+
+	// Destructor
+	PredictionEngine::~PredictionEngine(void)
+	{
+	}
+
+	// Set the base path that native data files are loaded from
+	void PredictionEngine::Create(const KPTSysCharT *pBasePath)
+	{
+		_basePath = pBasePath;
+		_abbreviations.Load(pBasePath);
+		_partitions.clear();
+		_partitionName.clear();
+		_pPartition = OpenPartition(_T(""));
+	}
+
+	// Release the native structures
+	void PredictionEngine::Destroy(void)
+	{
+		_loader.Stop();
+		_pDictionaries.reset(new DictionarySetT);
+		_tokenizer.Reset();
+		_fuzzyMatcher.SetLexicon(&_pDictionaries->lexicon);
+		_segmenter.SetLexicon(&_pDictionaries->lexicon);
+		_keyNodes.clear();
+		_abbreviations.Clear();
+		_sessionCache.Clear();
+		_partitions.clear();
+		_partitionName.clear();
+		_basePath.clear();
+		_pPartition = OpenPartition(_T(""));
+		_candidateSketch.Clear();
+	}
+
+	// Start loading the word lists for a comma-delimited list of dictionaries in priority order
+	// They are loaded in the background and swapped in when ready, so suggestions carry on from the current dictionaries meanwhile
+	void PredictionEngine::LoadDictionaries(const KPTUniCharT *dictList)
+	{
+		_dictList = dictList;
+
+		DictionaryRequestT request;
+		GetDictionaryRequest(request);
+		_loader.Start(request);
+	}
+
+	// Reload the active dictionaries e.g. after packages are installed or uninstalled
+	void PredictionEngine::ReloadDictionaries(void)
+	{
+		DictionaryRequestT request;
+		GetDictionaryRequest(request);
+		_loader.Start(request);
+	}
+
+	// Start using the dictionaries loaded in the background, if a new set is ready
+	// This is only done between requests, so no query can still be using the old set, which is freed in the background
+	void PredictionEngine::SwapDictionaries(void)
+	{
+		DictionarySetT *pLoaded = _loader.TakeLoaded();
+		if (pLoaded == NULL)
+		{
+			return;
+		}
+
+		_loader.Retire(_pDictionaries.release());
+		_pDictionaries.reset(pLoaded);
+		_fuzzyMatcher.SetLexicon(&_pDictionaries->lexicon);
+		_segmenter.SetLexicon(&_pDictionaries->lexicon);
+		_keyNodes.clear();
+	}
+
+	// Describe the dictionary set to load for the active dictionaries and current settings
+	void PredictionEngine::GetDictionaryRequest(DictionaryRequestT &request) const
+	{
+		request.basePath = _basePath;
+		request.dictList = _dictList;
+		request.indexMaxDistance = _indexMaxDistance;
+		request.indexPrefixLength = _indexPrefixLength;
+		request.keyGroups = _keyGroups;
+	}
+
+	// Choose how much memory to use for correction speed: a maximum distance of zero disables the deletion index,
+	// otherwise deletions of up to maxDistance characters from the first prefixLength characters of each word are indexed
+	// Inputs shorter than prefixLength are still corrected using the trie, so that completions of them are found
+	bool PredictionEngine::ConfigureDeletionIndex(uint32_t maxDistance, uint32_t prefixLength)
+	{
+		if (maxDistance > FUZZY_MAX_EDIT_DISTANCE || (maxDistance != 0 && (prefixLength <= maxDistance || prefixLength > MAX_WORD_LEN)))
+		{
+			return false;
+		}
+
+		// The indexes are rebuilt along with the rest of the dictionary set in the background
+		if (maxDistance != _indexMaxDistance || prefixLength != _indexPrefixLength)
+		{
+			_indexMaxDistance = maxDistance;
+			_indexPrefixLength = prefixLength;
+			ReloadDictionaries();
+		}
+
+		return true;
+	}
+
+	// Set the characters on each key of a grouped-letter keyboard, and index the words by the keys that type them
+	// The index is rebuilt in the background, and key sequences aren't matched until it is swapped in
+	bool PredictionEngine::SetKeyGroups(const std::vector<std::wstring> &keyGroups)
+	{
+		bool isValid = AmbiguousIndex::IsValidKeyGroups(keyGroups);
+		_keyNodes.clear();
+		if (isValid)
+		{
+			_keyGroups = keyGroups;
+		}
+		else
+		{
+			_keyGroups.clear();
+		}
+		ReloadDictionaries();
+
+		return isValid;
+	}
+
+	// Get the memory footprint of the deletion indexes in bytes
+	size_t PredictionEngine::GetDeletionIndexSize(void) const
+	{
+		return DictionaryLoader::GetDeletionIndexSize(*_pDictionaries);
+	}
+
+	// Get the predictions of a context model for a context, from the cache if possible
+	const NextWordEntryT *PredictionEngine::GetNextWords(size_t modelIndex, uint32_t word1, uint32_t word2)
+	{
+		return DictionaryLoader::GetNextWords(*_pDictionaries, modelIndex, word1, word2, _predictions);
+	}
+
+	// The prediction buffer was reset
+	void PredictionEngine::ResetInput(void)
+	{
+		_fuzzyMatcher.Reset();
+		_tokenizer.Reset();
+		_keyNodes.clear();
+	}
+
+	// A string was inserted at the cursor
+	void PredictionEngine::InsertString(const KPTUniCharT *str, size_t numChars)
+	{
+		_keyNodes.clear();
+		InsertChars(str, numChars);
+	}
+
+	// A grouped-letter key was pressed, inserting the first character of its group
+	void PredictionEngine::InsertAmbiguousKey(uint8_t key)
+	{
+		// Carry on the current key sequence unless the cursor has moved, otherwise start one if this key begins a word
+		uint32_t nodeIndex = AMBIGUOUS_NO_NODE;
+		if (!_keyNodes.empty() && _tokenizer.Cursor() == _keyEnd)
+		{
+			nodeIndex = _keyNodes.back();
+		}
+		else
+		{
+			_keyNodes.clear();
+			if (_pDictionaries->ambiguousIndex.IsLoaded() && _pDictionaries->ambiguousIndex.GetKeyGroups() == _keyGroups &&
+				_tokenizer.GetPrefixLength() == 0)
+			{
+				nodeIndex = AMBIGUOUS_ROOT;
+			}
+		}
+		if (nodeIndex != AMBIGUOUS_NO_NODE)
+		{
+			nodeIndex = _pDictionaries->ambiguousIndex.FindChild(nodeIndex, key);
+		}
+		_keyNodes.push_back(nodeIndex);
+
+		KPTUniCharT ch = GetKeyChar(key);
+		InsertChars(&ch, 1);
+		_keyEnd = _tokenizer.Cursor();
+	}
+
+	// Update the search state and tokenizer for characters inserted at the cursor
+	// The tokenizer is given the characters up to each word break first, so that the word being ended can be committed
+	void PredictionEngine::InsertChars(const KPTUniCharT *str, size_t numChars)
+	{
+		size_t start = 0;
+		for (size_t i = 0; i < numChars; i++)
+		{
+			if (Lexicon::IsWordChar(str[i]))
+			{
+				// The search is only extended while error correction is on, and catches up in Sync when it is turned on
+				if (_errorCorrectionOn)
+				{
+					_fuzzyMatcher.AppendChar(str[i]);
+				}
+			}
+			else
+			{
+				_fuzzyMatcher.Reset();
+				_tokenizer.InsertString(&str[start], i - start);
+				CommitWord();
+				start = i;
+			}
+		}
+		_tokenizer.InsertString(&str[start], numChars - start);
+	}
+
+	// Add the word before the cursor to the session cache and learn it, because a character that ends it is about to be inserted
+	void PredictionEngine::CommitWord(void)
+	{
+		if (_tokenizer.GetPrefixLength() != 0)
+		{
+			_tokenizer.GetPrefix(_prefix);
+			_sessionCache.AddWord(_prefix.c_str(), _prefix.length());
+			if (_learningOn)
+			{
+				LearnTypedWord(_prefix.c_str(), _prefix.length());
+			}
+		}
+	}
+
+	// The cursor was moved by a number of characters
+	void PredictionEngine::MoveCursor(int offset)
+	{
+		_fuzzyMatcher.Invalidate();
+		_keyNodes.clear();
+		_tokenizer.MoveCursor(offset);
+	}
+
+	// The cursor was moved to a position in the buffer
+	void PredictionEngine::SetCursor(size_t position)
+	{
+		_fuzzyMatcher.Invalidate();
+		_keyNodes.clear();
+		_tokenizer.SetCursor(position);
+	}
+
+	// Characters were removed before and/or after the cursor
+	void PredictionEngine::RemoveChars(size_t numBefore, size_t numAfter)
+	{
+		// Backspacing within the current word pops the search, anything else invalidates it
+		if (numAfter == 0 && numBefore <= _fuzzyMatcher.Length())
+		{
+			_fuzzyMatcher.RemoveChars(numBefore);
+		}
+		else
+		{
+			_fuzzyMatcher.Invalidate();
+		}
+
+		// Likewise for the ambiguous key sequence
+		if (numAfter == 0 && numBefore <= _keyNodes.size() && _tokenizer.Cursor() == _keyEnd)
+		{
+			_keyNodes.resize(_keyNodes.size() - numBefore);
+			_keyEnd -= numBefore;
+		}
+		else
+		{
+			_keyNodes.clear();
+		}
+		_tokenizer.RemoveChars(numBefore, numAfter);
+	}
+
+	// A suggestion was inserted after removing characters around the cursor
+	void PredictionEngine::InsertSuggestion(size_t numBefore, size_t numAfter, const KPTUniCharT *text, size_t length)
+	{
+		_fuzzyMatcher.Invalidate();
+		_keyNodes.clear();
+		_tokenizer.RemoveChars(numBefore, numAfter);
+		InsertChars(text, length);
+	}
+
+	// Learn a word that was typed, holding back words that aren't in the lexicon until they have been typed several times,
+	// so that typos and one-off strings never reach the personal dictionary
+	void PredictionEngine::LearnTypedWord(const KPTUniCharT *word, size_t length)
+	{
+		float delta = 1.0f;
+		if (_pPartition->dictionary.Find(word, length) == PD_NO_ENTRY && _pDictionaries->lexicon.FindWord(word, length) == LEXICON_NO_WORD)
+		{
+			uint32_t sightings = _candidateSketch.Add(Lexicon::HashWord(word, length));
+			if (sightings < PD_ADMISSION_SIGHTINGS)
+			{
+				return;
+			}
+			delta = (float)sightings;
+		}
+
+		LearnWord(word, length, delta);
+	}
+
+	// Learn the words counted in a body of text as one batch, applying the same admission rule as typed words, so that
+	// words which aren't in the lexicon are only learned if they occur several times. The words held back are removed from the list.
+	void PredictionEngine::LearnCounts(std::vector<WordCountT> &counts)
+	{
+		size_t numAdmitted = 0;
+		for (size_t i = 0; i < counts.size(); i++)
+		{
+			const KPTUniCharT *word = counts[i].word.c_str();
+			size_t length = counts[i].word.length();
+			uint32_t count = counts[i].count;
+			if (count < PD_ADMISSION_SIGHTINGS && _pPartition->dictionary.Find(word, length) == PD_NO_ENTRY && _pDictionaries->lexicon.FindWord(word, length) == LEXICON_NO_WORD)
+			{
+				// Rare words count as sightings, as if they had been typed
+				uint32_t sightings = 0;
+				uint64_t hash = Lexicon::HashWord(word, length);
+				for (uint32_t j = 0; j < count; j++)
+				{
+					sightings = _candidateSketch.Add(hash);
+				}
+				if (sightings < PD_ADMISSION_SIGHTINGS)
+				{
+					continue;
+				}
+				count = sightings;
+			}
+
+			LearnWord(word, length, (float)count);
+			if (numAdmitted != i)
+			{
+				counts[numAdmitted].word.swap(counts[i].word);
+				counts[numAdmitted].count = counts[i].count;
+			}
+			numAdmitted++;
+		}
+		counts.resize(numAdmitted);
+		_pPartition->log.Flush();
+
+		TRACE(_T("Learned %u words\n"), (unsigned)numAdmitted);
+	}
+
+	// List a page of the learned words and their counts in one of the personal dictionary view orders
+	bool PredictionEngine::GetPersonalPage(KPTPDViewOptionT view, size_t first, size_t count, std::vector<WordCountT> &words) const
+	{
+		words.clear();
+		std::vector<uint32_t> entries;
+		if (!_pPartition->dictionary.GetPage(view, first, count, entries))
+		{
+			return false;
+		}
+
+		const PersonalDictionary &dictionary = _pPartition->dictionary;
+		for (size_t i = 0; i < entries.size(); i++)
+		{
+			WordCountT word = { std::wstring(dictionary.GetText(entries[i]), dictionary.GetLength(entries[i])),
+				(uint32_t)(dictionary.GetEntryCount(entries[i]) + 0.5f) };
+			words.push_back(word);
+		}
+
+		return true;
+	}
+
+	// Write the learned words to a word list in alphabetical order, a page at a time
+	bool PredictionEngine::ExportPersonal(const KPTSysCharT *pFilePath, size_t &numWords) const
+	{
+		numWords = 0;
+		WordListWriter writer;
+		if (!writer.Open(pFilePath))
+		{
+			return false;
+		}
+
+		std::vector<WordCountT> words;
+		while (GetPersonalPage(eKPTPDViewAlphaAscending, numWords, PD_IO_BATCH, words) && !words.empty())
+		{
+			writer.WriteWords(words);
+			numWords += words.size();
+		}
+
+		return writer.Close();
+	}
+
+	// Add a batch of words read from a word list to their learned counts
+	// The user chose to import them, so they are learned whether or not they are in the lexicon
+	void PredictionEngine::ImportWords(const std::vector<WordCountT> &words)
+	{
+		for (size_t i = 0; i < words.size(); i++)
+		{
+			LearnWord(words[i].word.c_str(), words[i].word.length(), (float)words[i].count);
+		}
+		_pPartition->log.Flush();
+	}
+
+	// Set the maximum number of learned words, which named partitions keep smaller because they only learn one application's words
+	void PredictionEngine::SetPersonalCapacity(size_t capacity)
+	{
+		_personalCapacity = capacity;
+		for (std::map<std::wstring, std::unique_ptr<LearningPartitionT>>::iterator it = _partitions.begin(); it != _partitions.end(); ++it)
+		{
+			it->second->dictionary.SetCapacity(it->first.empty() ? capacity : (std::min)(capacity, (size_t)PD_PARTITION_CAPACITY));
+		}
+	}
+
+	// Learn into and suggest from the named partition, or the shared partition if the name is empty
+	// A partition is loaded the first time it is used and kept open, so switching back to it only swaps a pointer
+	bool PredictionEngine::SetPartition(const KPTUniCharT *name)
+	{
+		// Names are folder names, so only allow letters, digits, hyphens, underscores and inner spaces, and ignore case
+		std::wstring partitionName;
+		for (const KPTUniCharT *pChar = name; *pChar != L'\0'; pChar++)
+		{
+			if (!iswalnum(*pChar) && *pChar != L'-' && *pChar != L'_' && *pChar != L' ')
+			{
+				return false;
+			}
+			partitionName.push_back(Lexicon::Fold(*pChar));
+		}
+		if (partitionName.length() > MAX_PARTITION_NAME || (!partitionName.empty() && (partitionName.front() == L' ' || partitionName.back() == L' ')))
+		{
+			return false;
+		}
+
+		if (partitionName != _partitionName)
+		{
+			_pPartition->log.Flush();
+			_pPartition = OpenPartition(partitionName);
+			_partitionName = partitionName;
+		}
+
+		return true;
+	}
+
+	// Find a partition, creating it and loading its learned words from the base path if it hasn't been used yet
+	LearningPartitionT *PredictionEngine::OpenPartition(const std::wstring &name)
+	{
+		std::unique_ptr<LearningPartitionT> &pPartition = _partitions[name];
+		if (pPartition)
+		{
+			return pPartition.get();
+		}
+
+		pPartition.reset(new LearningPartitionT);
+		pPartition->dictionary.SetCapacity(name.empty() ? _personalCapacity : (std::min)(_personalCapacity, (size_t)PD_PARTITION_CAPACITY));
+		if (!_basePath.empty())
+		{
+			KPTSysCharT folderPath[MAX_PATH];
+			if (name.empty())
+			{
+				wcscpy_s(folderPath, MAX_PATH, _basePath.c_str());
+			}
+			else
+			{
+				swprintf_s(folderPath, MAX_PATH, _T("%s\\%s"), _basePath.c_str(), PD_PARTITION_FOLDER);
+				CreateDirectoryW(folderPath, NULL);
+				swprintf_s(folderPath, MAX_PATH, _T("%s\\%s\\%s"), _basePath.c_str(), PD_PARTITION_FOLDER, name.c_str());
+				CreateDirectoryW(folderPath, NULL);
+			}
+			if (!pPartition->log.Open(folderPath, pPartition->dictionary))
+			{
+				TRACE(_T("Couldn't open the learning log in %s\n"), folderPath);
+			}
+		}
+
+		return pPartition.get();
+	}
+
+	// Add to a word's learned count and log the change, compacting the log in the background when it gets large
+	void PredictionEngine::LearnWord(const KPTUniCharT *word, size_t length, float delta)
+	{
+		uint32_t timestamp = (uint32_t)time(NULL);
+		_pPartition->dictionary.AddWord(word, length, delta, timestamp);
+		_pPartition->log.Append(word, length, delta, timestamp);
+		if (_pPartition->log.NeedsCompaction())
+		{
+			_pPartition->log.Compact(_pPartition->dictionary);
+		}
+	}
+
+	// Add native suggestions for the current word prefix
+	void PredictionEngine::AddSuggestions(SuggestionList &suggestions)
+	{
+		SwapDictionaries();
+		_tokenizer.GetPrefix(_prefix);
+		const KPTUniCharT *pPrefix = _prefix.c_str();
+		size_t prefixLength = _prefix.length();
+
+		// The characters typed with grouped-letter keys are placeholders, so only their matches are worth suggesting
+		if (!_keyNodes.empty() && _keyNodes.size() == prefixLength && _tokenizer.Cursor() == _keyEnd)
+		{
+			AddAmbiguousMatches(prefixLength, suggestions);
+			return;
+		}
+
+		if (_abbreviations.IsLoaded())
+		{
+			AddExpansions(pPrefix, prefixLength, suggestions);
+		}
+
+		if (_errorCorrectionOn)
+		{
+			AddCorrections(pPrefix, prefixLength, suggestions);
+			AddSegmentation(pPrefix, prefixLength, suggestions);
+		}
+
+		if (_phraseCompletions != 0)
+		{
+			AddPhrases(prefixLength, suggestions);
+		}
+
+		// Predict the next word when the cursor follows a completed word or is at the start of a sentence
+		if (prefixLength == 0 && (_tokenizer.GetContextCount() != 0 || _tokenizer.IsSentenceStart()))
+		{
+			AddNextWords(suggestions);
+		}
+
+		if (_pPartition->dictionary.Count() != 0)
+		{
+			AddLearnedWords(pPrefix, prefixLength, suggestions);
+		}
+
+		if (_sessionCache.Count() != 0)
+		{
+			AddRecentWords(pPrefix, prefixLength, suggestions);
+			RankRecentWords(suggestions);
+		}
+	}
+
+	// Get the probability of each character that could be typed next, according to the words that extend the current prefix
+	void PredictionEngine::GetNextLetters(std::vector<NextLetterT> &letters)
+	{
+		SwapDictionaries();
+		_tokenizer.GetPrefix(_prefix);
+		const Lexicon &lexicon = _pDictionaries->lexicon;
+		lexicon.GetNextLetters(lexicon.FindPrefix(_prefix.c_str(), _prefix.length()), letters);
+	}
+
+	// Get the two words before the current one from the tokenizer, leaving either empty if there isn't one
+	void PredictionEngine::LoadContextWords(void)
+	{
+		size_t contextCount = _tokenizer.GetContextCount();
+		_word1.clear();
+		_word2.clear();
+		if (contextCount > 0)
+		{
+			_tokenizer.GetContextWord(contextCount - 1, _word2);
+		}
+		if (contextCount > 1)
+		{
+			_tokenizer.GetContextWord(contextCount - 2, _word1);
+		}
+	}
+
+	// Get a context model's predictions following the loaded context words, or NULL if the model doesn't know the previous word
+	const NextWordEntryT *PredictionEngine::GetContextPredictions(size_t modelIndex)
+	{
+		// An unknown previous word gives no context, whereas no previous word means the start of a sentence
+		const ContextModel &model = *_pDictionaries->contextModels[modelIndex];
+		uint32_t wordId2 = model.FindWord(_word2.c_str(), _word2.length());
+		uint32_t wordId1 = model.FindWord(_word1.c_str(), _word1.length());
+		if (!_word2.empty() && wordId2 == CONTEXT_NO_WORD)
+		{
+			return NULL;
+		}
+
+		return GetNextWords(modelIndex, wordId1, wordId2);
+	}
+
+	// Add the most likely next words from the context models
+	void PredictionEngine::AddNextWords(SuggestionList &suggestions)
+	{
+		LoadContextWords();
+
+		size_t added = 0;
+		for (size_t m = 0; m < _pDictionaries->contextModels.size() && added < MAX_NATIVE_PREDICTIONS; m++)
+		{
+			const ContextModel &model = *_pDictionaries->contextModels[m];
+			const NextWordEntryT *pEntry = GetContextPredictions(m);
+			if (pEntry == NULL)
+			{
+				continue;
+			}
+
+			for (size_t i = 0; i < pEntry->count && added < MAX_NATIVE_PREDICTIONS; i++)
+			{
+				// Predictions are sorted, so stop at the first that is too unlikely to be worth showing
+				if (pEntry->predictions[i].prob < MIN_NATIVE_PREDICTION_PROB)
+				{
+					break;
+				}
+
+				// Use the lexicon's capitalisation where the word is known e.g. "I" rather than "i"
+				const KPTUniCharT *text = model.GetText(pEntry->predictions[i].wordId);
+				size_t length = wcslen(text);
+				uint32_t wordId = _pDictionaries->lexicon.FindWord(text, length);
+				if (wordId != LEXICON_NO_WORD)
+				{
+					text = _pDictionaries->lexicon.GetText(wordId);
+				}
+
+				if (suggestions.AddNative(text, length, KPTSUGGSTYPE_WORD, 0))
+				{
+					added++;
+				}
+			}
+		}
+	}
+
+	// Add completions of the phrases that the current word and the words before it begin
+	// The longest match is tried first, so "thank you v" suggests "very much" before phrases that start with "v"
+	void PredictionEngine::AddPhrases(size_t prefixLength, SuggestionList &suggestions)
+	{
+		size_t contextCount = _tokenizer.GetContextCount();
+		size_t added = 0;
+		for (size_t start = 0; start <= contextCount && added < _phraseCompletions; start++)
+		{
+			// Don't complete phrases until something of them has been typed
+			if (start == contextCount && prefixLength == 0)
+			{
+				break;
+			}
+
+			_phraseText.clear();
+			for (size_t i = start; i < contextCount; i++)
+			{
+				_tokenizer.GetContextWord(i, _word1);
+				_phraseText.append(_word1);
+				_phraseText.push_back(L' ');
+			}
+			size_t wordStart = _phraseText.length();
+			_phraseText.append(_prefix);
+
+			uint32_t nodeIndex = _pDictionaries->phraseIndex.FindPrefix(_phraseText.c_str(), _phraseText.length());
+			if (nodeIndex == PHRASE_NO_NODE)
+			{
+				continue;
+			}
+
+			const uint32_t *best = _pDictionaries->phraseIndex.GetBest(nodeIndex);
+			for (size_t i = 0; i < MAX_PHRASE_COMPLETIONS && best[i] != PHRASE_NO_PHRASE && added < _phraseCompletions; i++)
+			{
+				// Suggest the rest of the phrase from the current word, if it goes beyond the current word
+				const KPTUniCharT *text = _pDictionaries->phraseIndex.GetText(best[i]) + wordStart;
+				size_t length = _pDictionaries->phraseIndex.GetPhrase(best[i]).length - wordStart;
+				if (wcschr(text + prefixLength, L' ') != NULL &&
+					suggestions.AddNative(text, length, KPTSUGGSTYPE_ELISION, prefixLength))
+				{
+					added++;
+				}
+			}
+		}
+	}
+
+	// Suggest splitting the current word into several words if it isn't a word itself, e.g. "inthe" into "in the"
+	void PredictionEngine::AddSegmentation(const KPTUniCharT *pPrefix, size_t prefixLength, SuggestionList &suggestions)
+	{
+		if (prefixLength < MIN_SEGMENT_LEN || prefixLength > MAX_SEGMENT_LEN || _pDictionaries->lexicon.FindWord(pPrefix, prefixLength) != LEXICON_NO_WORD)
+		{
+			return;
+		}
+
+		// The first word's context probability comes from the highest priority model that knows the preceding words
+		LoadContextWords();
+		_firstWords.clear();
+		for (size_t m = 0; m < _pDictionaries->contextModels.size() && _firstWords.empty(); m++)
+		{
+			const NextWordEntryT *pEntry = GetContextPredictions(m);
+			for (size_t i = 0; pEntry != NULL && i < pEntry->count; i++)
+			{
+				const KPTUniCharT *text = _pDictionaries->contextModels[m]->GetText(pEntry->predictions[i].wordId);
+				ContextPredictionT prediction = { _pDictionaries->lexicon.FindWord(text, wcslen(text)), pEntry->predictions[i].prob };
+				if (prediction.wordId != LEXICON_NO_WORD)
+				{
+					_firstWords.push_back(prediction);
+				}
+			}
+		}
+
+		if (_segmenter.Segment(pPrefix, prefixLength, _firstWords, _segmentText))
+		{
+			suggestions.AddNative(_segmentText.c_str(), _segmentText.length(), KPTSUGGSTYPE_SPACECONTRACTION, prefixLength);
+		}
+	}
+
+	// Add the learned words that complete the current prefix and have been typed often enough recently, most frequent first
+	void PredictionEngine::AddLearnedWords(const KPTUniCharT *pPrefix, size_t prefixLength, SuggestionList &suggestions)
+	{
+		const PersonalDictionary &dictionary = _pPartition->dictionary;
+		dictionary.FindCompletions(pPrefix, prefixLength, MAX_LEARNED_COMPLETIONS, _learnedMatches);
+		for (size_t i = 0; i < _learnedMatches.size(); i++)
+		{
+			if (dictionary.GetEntryCount(_learnedMatches[i]) >= MIN_LEARNED_COUNT)
+			{
+				suggestions.AddNative(dictionary.GetText(_learnedMatches[i]), dictionary.GetLength(_learnedMatches[i]), KPTSUGGSTYPE_WORD, prefixLength);
+			}
+		}
+	}
+
+	// Add the words typed earlier in the session that complete the current prefix, most recently used first
+	void PredictionEngine::AddRecentWords(const KPTUniCharT *pPrefix, size_t prefixLength, SuggestionList &suggestions)
+	{
+		_sessionCache.FindCompletions(pPrefix, prefixLength, MAX_SESSION_COMPLETIONS, _recentMatches);
+		for (size_t i = 0; i < _recentMatches.size(); i++)
+		{
+			if (_sessionCache.GetEntryWeight(_recentMatches[i]) >= MIN_SESSION_WEIGHT)
+			{
+				suggestions.AddNative(_sessionCache.GetText(_recentMatches[i]), _sessionCache.GetLength(_recentMatches[i]), KPTSUGGSTYPE_WORD, prefixLength);
+			}
+		}
+	}
+
+	// Move the suggestions that were typed recently in the session ahead of the others, by their decayed counts
+	void PredictionEngine::RankRecentWords(SuggestionList &suggestions)
+	{
+		_weights.resize(suggestions.Count());
+		for (size_t i = 0; i < suggestions.Count(); i++)
+		{
+			const std::wstring &text = suggestions.Get(i).text;
+			float weight = _sessionCache.GetWeight(text.c_str(), text.length());
+			_weights[i] = weight >= MIN_SESSION_WEIGHT ? weight : 0.0f;
+		}
+		suggestions.SortByWeight(_weights);
+	}
+
+	// Add the words typed by the current key sequence, best first, followed by the best longer words it begins
+	void PredictionEngine::AddAmbiguousMatches(size_t prefixLength, SuggestionList &suggestions)
+	{
+		uint32_t nodeIndex = _keyNodes.back();
+		if (nodeIndex == AMBIGUOUS_NO_NODE)
+		{
+			return;
+		}
+
+		const Lexicon &lexicon = _pDictionaries->lexicon;
+		const AmbiguousNodeT &node = _pDictionaries->ambiguousIndex.GetNode(nodeIndex);
+		for (uint32_t i = 0; i < node.wordCount && i < MAX_AMBIGUOUS_MATCHES; i++)
+		{
+			uint32_t wordId = _pDictionaries->ambiguousIndex.GetWordId(node.firstWord + i);
+			suggestions.AddNative(lexicon.GetText(wordId), lexicon.GetWord(wordId).length, KPTSUGGSTYPE_WORD, prefixLength);
+		}
+		for (size_t i = 0; i < MAX_AMBIGUOUS_COMPLETIONS && node.completions[i] != AMBIGUOUS_NO_WORD; i++)
+		{
+			uint32_t wordId = node.completions[i];
+			suggestions.AddNative(lexicon.GetText(wordId), lexicon.GetWord(wordId).length, KPTSUGGSTYPE_WORD, prefixLength);
+		}
+	}
+
+	// Add the expansions of the current word if it is an abbreviation, capitalised if the abbreviation was typed capitalised
+	void PredictionEngine::AddExpansions(const KPTUniCharT *pPrefix, size_t prefixLength, SuggestionList &suggestions)
+	{
+		_abbreviations.Find(pPrefix, prefixLength, _abbreviationMatches);
+		for (size_t i = 0; i < _abbreviationMatches.size(); i++)
+		{
+			_expansion.assign(_abbreviations.GetExpansion(_abbreviationMatches[i]), _abbreviations.GetExpansionLength(_abbreviationMatches[i]));
+			if (iswupper(pPrefix[0]))
+			{
+				_expansion[0] = towupper(_expansion[0]);
+			}
+			suggestions.AddNative(_expansion.c_str(), _expansion.length(), KPTSUGGSTYPE_ACRONYMEXPANSION, prefixLength);
+		}
+	}
+
+	// Add error-corrected suggestions from the lexicon
+	void PredictionEngine::AddCorrections(const KPTUniCharT *pPrefix, size_t prefixLength, SuggestionList &suggestions)
+	{
+		// Allow fewer errors in short words
+		uint32_t maxDistance;
+		if (prefixLength < 3 || !_pDictionaries->lexicon.IsLoaded())
+		{
+			return;
+		}
+		else if (prefixLength < 5)
+		{
+			maxDistance = 1;
+		}
+		else
+		{
+			maxDistance = FUZZY_MAX_EDIT_DISTANCE;
+		}
+
+		// Probe the deletion indexes if they are loaded, otherwise search the trie, which counts a transposition as one edit like the rescoring
+		// The indexes only match the first prefixLength characters of each word as a whole, so an input shorter than that,
+		// which may be the start of a longer word, is matched against the trie instead
+		const std::vector<std::unique_ptr<DeletionIndex>> &indexes = _pDictionaries->deletionIndexes;
+		if (!indexes.empty() && prefixLength >= indexes[0]->PrefixLength())
+		{
+			FindIndexCandidates(pPrefix, prefixLength);
+		}
+		else
+		{
+			_fuzzyMatcher.Sync(pPrefix, prefixLength);
+			_fuzzyMatcher.GetCandidates(maxDistance, MAX_RESCORED_CORRECTIONS, _candidates);
+		}
+		RescoreCandidates(pPrefix, prefixLength);
+
+		size_t added = 0;
+		KPTUniCharT word[MAX_WORD_LEN + 1];
+		for (size_t i = 0; i < _candidates.size() && added < MAX_NATIVE_CORRECTIONS; i++)
+		{
+			// Exact matches are left to the engine
+			if (_candidates[i].distance == 0 || _candidates[i].distance > maxDistance)
+			{
+				continue;
+			}
+
+			// Follow the capitalisation of the first character typed
+			const LexiconWordT &entry = _pDictionaries->lexicon.GetWord(_candidates[i].wordId);
+			wcsncpy_s(word, _pDictionaries->lexicon.GetText(_candidates[i].wordId), MAX_WORD_LEN + 1);
+			if (iswupper(pPrefix[0]))
+			{
+				word[0] = (KPTUniCharT)towupper(word[0]);
+			}
+
+			if (suggestions.AddNative(word, entry.length, KPTSUGGSTYPE_ERRORCORRECTION, prefixLength))
+			{
+				added++;
+			}
+		}
+	}
+
+	// Get the words that share a deletion with the input from the index of each active dictionary
+	void PredictionEngine::FindIndexCandidates(const KPTUniCharT *pPrefix, size_t prefixLength)
+	{
+		_candidates.clear();
+		for (size_t i = 0; i < _pDictionaries->deletionIndexes.size(); i++)
+		{
+			_pDictionaries->deletionIndexes[i]->Lookup(pPrefix, prefixLength, _indexMatches);
+			for (size_t j = 0; j < _indexMatches.size(); j++)
+			{
+				size_t length;
+				const KPTUniCharT *text = _pDictionaries->deletionIndexes[i]->GetText(_indexMatches[j], length);
+				uint32_t wordId = _pDictionaries->lexicon.FindWord(text, length);
+				if (wordId != LEXICON_NO_WORD)
+				{
+					FuzzyCandidateT candidate = { wordId, 0 };
+					_candidates.push_back(candidate);
+				}
+			}
+		}
+
+		// A word may be in more than one dictionary
+		std::sort(_candidates.begin(), _candidates.end(), [](const FuzzyCandidateT &a, const FuzzyCandidateT &b)
+		{
+			return a.wordId < b.wordId;
+		});
+		_candidates.erase(std::unique(_candidates.begin(), _candidates.end(), [](const FuzzyCandidateT &a, const FuzzyCandidateT &b)
+		{
+			return a.wordId == b.wordId;
+		}), _candidates.end());
+	}
+
+	// Rescore candidates with the Damerau distance between the input and the closest prefix of each word
+	void PredictionEngine::RescoreCandidates(const KPTUniCharT *pPrefix, size_t prefixLength)
+	{
+		KPTUniCharT pattern[MAX_WORD_LEN];
+		KPTUniCharT texts[EDIT_BATCH_SIZE][MAX_WORD_LEN];
+		const KPTUniCharT *textPtrs[EDIT_BATCH_SIZE];
+		size_t lengths[EDIT_BATCH_SIZE];
+		uint32_t distances[EDIT_BATCH_SIZE];
+		uint32_t prefixDistances[EDIT_BATCH_SIZE];
+		size_t i, j;
+
+		// Compare case-folded text
+		prefixLength = (std::min)(prefixLength, (size_t)MAX_WORD_LEN);
+		for (j = 0; j < prefixLength; j++)
+		{
+			pattern[j] = Lexicon::Fold(pPrefix[j]);
+		}
+		_editDistance.SetPattern(pattern, prefixLength, true);
+
+		for (size_t start = 0; start < _candidates.size(); start += EDIT_BATCH_SIZE)
+		{
+			size_t count = (std::min)(_candidates.size() - start, (size_t)EDIT_BATCH_SIZE);
+			for (i = 0; i < count; i++)
+			{
+				uint32_t wordId = _candidates[start + i].wordId;
+				const KPTUniCharT *text = _pDictionaries->lexicon.GetText(wordId);
+				lengths[i] = (std::min)((size_t)_pDictionaries->lexicon.GetWord(wordId).length, (size_t)MAX_WORD_LEN);
+				for (j = 0; j < lengths[i]; j++)
+				{
+					texts[i][j] = Lexicon::Fold(text[j]);
+				}
+				textPtrs[i] = texts[i];
+			}
+
+			_editDistance.DistanceBatch(textPtrs, lengths, count, distances, prefixDistances);
+			for (i = 0; i < count; i++)
+			{
+				_candidates[start + i].distance = prefixDistances[i];
+			}
+		}
+
+		_fuzzyMatcher.RankCandidates(_candidates);
+	}
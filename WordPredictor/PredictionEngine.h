@@ -0,0 +1,142 @@
+#pragma once
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <map>
+#include "Lexicon.h"
+#include "FuzzyMatcher.h"
+#include "EditDistance.h"
+#include "DictionaryLoader.h"
+#include "WordSegmenter.h"
+#include "AbbreviationTable.h"
+#include "SessionCache.h"
+#include "PersonalDictionary.h"
+#include "LearningLog.h"
+#include "CorpusLearner.h"
+#include "WordListFile.h"
+#include "InputTokenizer.h"
+#include "SuggestionList.h"
+
+	// Words learned while typing into one application, overlaid on the shared lexicon
+	// The unnamed partition is stored in the base path and named ones in their own subfolder of it
+	struct LearningPartitionT
+	{
+		PersonalDictionary dictionary;
+		LearningLog log;
+	};
+
+	// Native prediction structures that complement the suggestions from the OpenAdaptxt engine
+	// The engine is told about every change to the input buffer so that its state can be kept up to date incrementally
+	class PredictionEngine
+	{
+	private:
+		std::wstring _basePath;
+		std::wstring _dictList;
+		bool _errorCorrectionOn;
+		bool _learningOn;
+		uint32_t _indexMaxDistance;
+		uint32_t _indexPrefixLength;
+		std::unique_ptr<DictionarySetT> _pDictionaries;	// Dictionaries in use, replaced when a new set has loaded in the background
+		DictionaryLoader _loader;
+		std::vector<uint32_t> _indexMatches;
+		FuzzyMatcher _fuzzyMatcher;
+		std::vector<FuzzyCandidateT> _candidates;
+		EditDistance _editDistance;
+		std::vector<ContextPredictionT> _predictions;
+		size_t _phraseCompletions;
+		std::wstring _phraseText;
+		WordSegmenter _segmenter;
+		std::vector<ContextPredictionT> _firstWords;
+		std::wstring _segmentText;
+		std::vector<std::wstring> _keyGroups;
+		std::vector<uint32_t> _keyNodes;	// Ambiguous index node reached after each key of the current word
+		size_t _keyEnd;						// Cursor position after the last ambiguous key
+		AbbreviationTable _abbreviations;
+		std::vector<uint32_t> _abbreviationMatches;
+		std::wstring _expansion;
+		SessionCache _sessionCache;
+		std::vector<uint32_t> _recentMatches;
+		std::vector<float> _weights;
+		std::map<std::wstring, std::unique_ptr<LearningPartitionT>> _partitions;
+		LearningPartitionT *_pPartition;	// Partition that words are learned into and suggested from
+		std::wstring _partitionName;
+		size_t _personalCapacity;
+		CountMinSketch _candidateSketch;	// Sightings of typed words that are in neither the lexicon nor the personal dictionary
+		std::vector<uint32_t> _learnedMatches;
+		InputTokenizer _tokenizer;
+		std::wstring _prefix;
+		std::wstring _word1;
+		std::wstring _word2;
+
+	public:
+		PredictionEngine(void);
+		~PredictionEngine(void);
+
+		void Create(const KPTSysCharT *pBasePath);
+		void Destroy(void);
+		void LoadDictionaries(const KPTUniCharT *dictList);
+		void ReloadDictionaries(void);
+		void SetErrorCorrection(bool isOn) { _errorCorrectionOn = isOn; }
+		void SetLearning(bool isOn) { _learningOn = isOn; }
+		void SetPersonalCapacity(size_t capacity);
+		size_t GetPersonalCapacity(void) const { return _pPartition->dictionary.Capacity(); }
+		size_t GetPersonalCount(void) const { return _pPartition->dictionary.Count(); }
+		bool SetPartition(const KPTUniCharT *name);
+		bool GetPersonalPage(KPTPDViewOptionT view, size_t first, size_t count, std::vector<WordCountT> &words) const;
+		bool ExportPersonal(const KPTSysCharT *pFilePath, size_t &numWords) const;
+		void ImportWords(const std::vector<WordCountT> &words);
+		void SetPhraseCompletions(size_t maxCount) { _phraseCompletions = (std::min)(maxCount, (size_t)MAX_PHRASE_COMPLETIONS); }
+		bool ConfigureDeletionIndex(uint32_t maxDistance, uint32_t prefixLength);
+		size_t GetDeletionIndexSize(void) const;
+		bool SetKeyGroups(const std::vector<std::wstring> &keyGroups);
+		KPTUniCharT GetKeyChar(size_t key) const { return key < _keyGroups.size() ? _keyGroups[key][0] : L'\0'; }
+
+		void ResetInput(void);
+		void InsertString(const KPTUniCharT *str, size_t numChars);
+		void InsertAmbiguousKey(uint8_t key);
+		void MoveCursor(int offset);
+		void SetCursor(size_t position);
+		void RemoveChars(size_t numBefore, size_t numAfter);
+		void InsertSuggestion(size_t numBefore, size_t numAfter, const KPTUniCharT *text, size_t length);
+
+		void AddSuggestions(SuggestionList &suggestions);
+		void GetNextLetters(std::vector<NextLetterT> &letters);
+		void LearnCounts(std::vector<WordCountT> &counts);
+
+	private:
+		LearningPartitionT *OpenPartition(const std::wstring &name);
+		void InsertChars(const KPTUniCharT *str, size_t numChars);
+		void CommitWord(void);
+		void LearnTypedWord(const KPTUniCharT *word, size_t length);
+		void LearnWord(const KPTUniCharT *word, size_t length, float delta);
+		void AddAmbiguousMatches(size_t prefixLength, SuggestionList &suggestions);
+		void AddExpansions(const KPTUniCharT *pPrefix, size_t prefixLength, SuggestionList &suggestions);
+		void AddCorrections(const KPTUniCharT *pPrefix, size_t prefixLength, SuggestionList &suggestions);
+		void FindIndexCandidates(const KPTUniCharT *pPrefix, size_t prefixLength);
+		void RescoreCandidates(const KPTUniCharT *pPrefix, size_t prefixLength);
+		void SwapDictionaries(void);
+		void GetDictionaryRequest(DictionaryRequestT &request) const;
+		const NextWordEntryT *GetNextWords(size_t modelIndex, uint32_t word1, uint32_t word2);
+		void LoadContextWords(void);
+		const NextWordEntryT *GetContextPredictions(size_t modelIndex);
+		void AddNextWords(SuggestionList &suggestions);
+		void AddSegmentation(const KPTUniCharT *pPrefix, size_t prefixLength, SuggestionList &suggestions);
+		void AddPhrases(size_t prefixLength, SuggestionList &suggestions);
+		void AddLearnedWords(const KPTUniCharT *pPrefix, size_t prefixLength, SuggestionList &suggestions);
+		void AddRecentWords(const KPTUniCharT *pPrefix, size_t prefixLength, SuggestionList &suggestions);
+		void RankRecentWords(SuggestionList &suggestions);
+	};
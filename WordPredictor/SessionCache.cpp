@@ -0,0 +1,214 @@
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+#include "stdafx.h"
+#include <math.h>
+#include <algorithm>
+#include "Lexicon.h"
+#include "SessionCache.h"
+#include "TopEntries.h"
+
+	// Constructor
+	SessionCache::SessionCache(void)
+	{
+		_ringStart = 0;
+		_ringCount = 0;
+		_time = 0;
+		for (size_t i = 0; i < SESSION_LETTER_LISTS; i++)
+		{
+			_listHeads[i] = SESSION_NO_ENTRY;
+		}
+	}
+
+	// Destructor
+	SessionCache::~SessionCache(void)
+	{
+	}
+
+	// Allocate the storage for a window of the specified number of words, and empty the cache
+	void SessionCache::SetCapacity(size_t numWords)
+	{
+		size_t slotCount = 2;
+		while (slotCount < 2 * numWords)
+		{
+			slotCount *= 2;
+		}
+
+		_ring.assign(numWords, SESSION_NO_ENTRY);
+		_words.resize(numWords);
+		_slots.Reset(slotCount);
+		_freeEntries.reserve(numWords);
+		Clear();
+	}
+
+	// Forget all the words, keeping the storage
+	void SessionCache::Clear(void)
+	{
+		_ringStart = 0;
+		_ringCount = 0;
+		_time = 0;
+		_slots.Reset(_slots.SlotCount());
+		for (size_t i = 0; i < SESSION_LETTER_LISTS; i++)
+		{
+			_listHeads[i] = SESSION_NO_ENTRY;
+		}
+
+		// Hand out the entries in index order
+		_freeEntries.clear();
+		for (size_t entry = _words.size(); entry-- > 0; )
+		{
+			_freeEntries.push_back((uint32_t)entry);
+		}
+	}
+
+	// Add a word that the user has finished typing, forgetting the oldest word if the window is full
+	void SessionCache::AddWord(const KPTUniCharT *word, size_t length)
+	{
+		if (_ring.empty() || length == 0 || length > MAX_WORD_LEN)
+		{
+			return;
+		}
+
+		if (_ringCount == _ring.size())
+		{
+			uint32_t oldest = _ring[_ringStart];
+			_ringStart = (_ringStart + 1) % _ring.size();
+			_ringCount--;
+			if (--_words[oldest].count == 0)
+			{
+				RemoveEntry(oldest);
+			}
+		}
+
+		_time++;
+		uint64_t hash = Lexicon::HashWord(word, length);
+		uint32_t entry = Find(hash, word, length);
+		if (entry == SESSION_NO_ENTRY)
+		{
+			// There is always a free entry, because the window holds no more distinct words than its size
+			entry = _freeEntries.back();
+			_freeEntries.pop_back();
+			_slots.Insert(entry, hash);
+
+			SessionWordT &newWord = _words[entry];
+			newWord.hash = hash;
+			newWord.count = 0;
+			newWord.lastTime = _time;
+			newWord.weight = 0.0f;
+
+			// Link the word at the head of its first letter list
+			size_t list = GetListIndex(word[0]);
+			newWord.prevInList = SESSION_NO_ENTRY;
+			newWord.nextInList = _listHeads[list];
+			if (_listHeads[list] != SESSION_NO_ENTRY)
+			{
+				_words[_listHeads[list]].prevInList = entry;
+			}
+			_listHeads[list] = entry;
+		}
+
+		SessionWordT &sessionWord = _words[entry];
+		sessionWord.weight = GetEntryWeight(entry) + 1.0f;
+		sessionWord.lastTime = _time;
+		sessionWord.count++;
+		sessionWord.length = (uint16_t)length;
+		wmemcpy(sessionWord.text, word, length);
+		sessionWord.text[length] = L'\0';
+
+		_ring[(_ringStart + _ringCount) % _ring.size()] = entry;
+		_ringCount++;
+	}
+
+	// Get the decayed count of a word, or zero if it isn't in the window
+	float SessionCache::GetWeight(const KPTUniCharT *word, size_t length) const
+	{
+		if (_ringCount == 0 || length == 0 || length > MAX_WORD_LEN)
+		{
+			return 0.0f;
+		}
+
+		uint32_t entry = Find(Lexicon::HashWord(word, length), word, length);
+
+		return entry != SESSION_NO_ENTRY ? GetEntryWeight(entry) : 0.0f;
+	}
+
+	// Get the decayed count of an entry as of the last word added
+	float SessionCache::GetEntryWeight(uint32_t entry) const
+	{
+		const SessionWordT &sessionWord = _words[entry];
+
+		return sessionWord.weight * powf(SESSION_CACHE_DECAY, (float)(_time - sessionWord.lastTime));
+	}
+
+	// Find the words in the window that are longer than a prefix and start with it ignoring case, highest weight first
+	void SessionCache::FindCompletions(const KPTUniCharT *prefix, size_t length, size_t maxCount, std::vector<uint32_t> &entries) const
+	{
+		TopEntries best(entries, maxCount);
+		if (_ringCount == 0 || length == 0 || maxCount == 0)
+		{
+			return;
+		}
+
+		KPTUniCharT first = Lexicon::Fold(prefix[0]);
+		for (uint32_t entry = _listHeads[GetListIndex(first)]; entry != SESSION_NO_ENTRY; entry = _words[entry].nextInList)
+		{
+			if (_words[entry].length <= length || Lexicon::Fold(_words[entry].text[0]) != first || !WordTable::IsMatch(_words[entry].text, prefix, length))
+			{
+				continue;
+			}
+
+			best.Add(entry, GetEntryWeight(entry));
+		}
+	}
+
+	// Look up a word, returning its entry or SESSION_NO_ENTRY
+	uint32_t SessionCache::Find(uint64_t hash, const KPTUniCharT *word, size_t length) const
+	{
+		for (size_t slot = _slots.GetHome(hash); _slots.GetEntry(slot) != SESSION_NO_ENTRY; slot = _slots.GetNext(slot))
+		{
+			uint32_t entry = _slots.GetEntry(slot);
+			if (_slots.IsHashMatch(slot, hash) && _words[entry].hash == hash && _words[entry].length == length && WordTable::IsMatch(_words[entry].text, word, length))
+			{
+				return entry;
+			}
+		}
+
+		return SESSION_NO_ENTRY;
+	}
+
+	// Get the first letter list of words that start with a character, ignoring case
+	size_t SessionCache::GetListIndex(KPTUniCharT ch)
+	{
+		return Lexicon::Fold(ch) % SESSION_LETTER_LISTS;
+	}
+
+	// Remove a word that has dropped out of the window
+	void SessionCache::RemoveEntry(uint32_t entry)
+	{
+		SessionWordT &sessionWord = _words[entry];
+		if (sessionWord.prevInList != SESSION_NO_ENTRY)
+		{
+			_words[sessionWord.prevInList].nextInList = sessionWord.nextInList;
+		}
+		else
+		{
+			_listHeads[GetListIndex(sessionWord.text[0])] = sessionWord.nextInList;
+		}
+		if (sessionWord.nextInList != SESSION_NO_ENTRY)
+		{
+			_words[sessionWord.nextInList].prevInList = sessionWord.prevInList;
+		}
+
+		_slots.Remove(entry, sessionWord.hash);
+		_freeEntries.push_back(entry);
+	}
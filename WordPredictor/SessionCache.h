@@ -0,0 +1,74 @@
+#pragma once
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+
+#include <vector>
+#include "kptapi.h"
+#include "WordTable.h"
+
+	#define SESSION_NO_ENTRY WORD_TABLE_NO_ENTRY
+	#define SESSION_LETTER_LISTS 64
+
+	// A distinct word in the cache window
+	struct SessionWordT
+	{
+		uint64_t hash;			// Hash of the case-folded word
+		uint32_t count;			// Number of times the word occurs in the window
+		uint32_t lastTime;		// Value of the word clock when the word was last typed
+		float weight;			// Decayed count of the word at lastTime
+		uint32_t prevInList;	// Previous and next entries whose first letter is in the same list
+		uint32_t nextInList;
+		uint16_t length;		// Number of characters, excluding NULL
+		KPTUniCharT text[MAX_WORD_LEN + 1];	// Word as it was last typed
+	};
+
+	// Cache language model over the last words typed in the session, so that words just used, such as names and
+	// project terms, can be ranked above the static dictionary. The window is a ring buffer of entry indexes, and each
+	// distinct word has one entry with its count in the window and an exponentially decayed count that is brought up
+	// to date when it is read. All the storage is allocated up front, so adding a word is O(1) and never allocates.
+	// The words are also linked into lists by their case-folded first letter, so completing a prefix only looks at the
+	// words that start with the same letter (or another that shares its list) rather than the whole table.
+	class SessionCache
+	{
+	private:
+		std::vector<uint32_t> _ring;			// Entry index of each word in the window, oldest at _ringStart when full
+		size_t _ringStart;
+		size_t _ringCount;
+		std::vector<SessionWordT> _words;
+		std::vector<uint32_t> _freeEntries;
+		WordTable _slots;						// Entry index of each distinct word, at most half full
+		uint32_t _listHeads[SESSION_LETTER_LISTS];	// First entry of each first letter list
+		uint32_t _time;							// Number of words added
+
+	public:
+		SessionCache(void);
+		~SessionCache(void);
+
+		void SetCapacity(size_t numWords);
+		void Clear(void);
+		size_t Count(void) const { return _ringCount; }
+		size_t DistinctCount(void) const { return _words.size() - _freeEntries.size(); }
+
+		void AddWord(const KPTUniCharT *word, size_t length);
+		float GetWeight(const KPTUniCharT *word, size_t length) const;
+		void FindCompletions(const KPTUniCharT *prefix, size_t length, size_t maxCount, std::vector<uint32_t> &entries) const;
+		const KPTUniCharT *GetText(uint32_t entry) const { return _words[entry].text; }
+		size_t GetLength(uint32_t entry) const { return _words[entry].length; }
+		float GetEntryWeight(uint32_t entry) const;
+
+	private:
+		uint32_t Find(uint64_t hash, const KPTUniCharT *word, size_t length) const;
+		void RemoveEntry(uint32_t entry);
+		static size_t GetListIndex(KPTUniCharT ch);
+	};
@@ -0,0 +1,71 @@
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+#include "stdafx.h"
+#include "stdafx.h"
+#include "SortedTrie.h"
+
+	// Range of sorted items that share a prefix, used when building the trie
+	struct SortedTrieRangeT
+	{
+		uint32_t nodeIndex;
+		uint32_t first;
+		uint32_t last;
+		size_t depth;
+	};
+
+	// Build the trie for a sorted list of items, replacing any nodes
+	void SortedTrie::Build(uint32_t itemCount, SortedTrieSymbolFnT getSymbol, intptr_t context, std::vector<SortedTrieNodeT> &nodes)
+	{
+		nodes.clear();
+		SortedTrieNodeT root = { 0, 0, SORTED_TRIE_NO_NODE, 0, 0 };
+		nodes.push_back(root);
+
+		std::vector<SortedTrieRangeT> queue;
+		SortedTrieRangeT all = { SORTED_TRIE_ROOT, 0, itemCount, 0 };
+		queue.push_back(all);
+		for (size_t q = 0; q < queue.size(); q++)
+		{
+			SortedTrieRangeT range = queue[q];
+			uint32_t first = range.first;
+
+			// Items ending at this node sort before the items that extend it
+			while (first < range.last && getSymbol(first, range.depth, context) == SORTED_TRIE_END)
+			{
+				first++;
+			}
+			nodes[range.nodeIndex].first = range.first;
+			nodes[range.nodeIndex].endCount = first - range.first;
+
+			// Add a child for each distinct next symbol
+			nodes[range.nodeIndex].firstChild = (uint32_t)nodes.size();
+			while (first < range.last)
+			{
+				uint32_t symbol = getSymbol(first, range.depth, context);
+				uint32_t last = first + 1;
+				while (last < range.last && getSymbol(last, range.depth, context) == symbol)
+				{
+					last++;
+				}
+
+				SortedTrieRangeT childRange = { (uint32_t)nodes.size(), first, last, range.depth + 1 };
+				queue.push_back(childRange);
+
+				SortedTrieNodeT child = { symbol, 0, SORTED_TRIE_NO_NODE, first, 0 };
+				nodes.push_back(child);
+				nodes[range.nodeIndex].childCount++;
+
+				first = last;
+			}
+		}
+	}
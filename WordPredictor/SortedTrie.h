@@ -0,0 +1,72 @@
+#pragma once
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+
+#include <vector>
+#include "kptapi.h"
+
+	#define SORTED_TRIE_ROOT 0
+	#define SORTED_TRIE_NO_NODE 0xFFFFFFFF
+	#define SORTED_TRIE_END 0xFFFFFFFF
+
+	// Gets the symbol at a depth of an item in a sorted list, or SORTED_TRIE_END if the item is that long
+	typedef uint32_t (*SortedTrieSymbolFnT)(uint32_t item, size_t depth, intptr_t context);
+
+	// A node of a trie built from a sorted list of items
+	// The items below a node are a contiguous range of the list, and those that end at the node come first
+	struct SortedTrieNodeT
+	{
+		uint32_t symbol;		// Symbol on the edge into this node, or 0 for the root
+		uint32_t childCount;	// Number of children
+		uint32_t firstChild;	// Index of the first child
+		uint32_t first;			// First item below this node
+		uint32_t endCount;		// Number of items that end at this node
+	};
+
+	// Builds a trie over a list of items that is sorted by symbol sequence, with each item before those that extend it.
+	// The trie is built breadth first, so the children of each node are contiguous and sorted by symbol, and a child
+	// is found by a binary search. The word, phrase and key sequence tries copy the nodes into their own node types.
+	class SortedTrie
+	{
+	public:
+		static void Build(uint32_t itemCount, SortedTrieSymbolFnT getSymbol, intptr_t context, std::vector<SortedTrieNodeT> &nodes);
+
+		// Find the child of a node with the specified symbol, or return SORTED_TRIE_NO_NODE
+		template <class NodeT, class SymbolT>
+		static uint32_t FindChild(const std::vector<NodeT> &nodes, uint32_t nodeIndex, SymbolT NodeT::*pSymbol, SymbolT symbol)
+		{
+			const NodeT &node = nodes[nodeIndex];
+			uint32_t low = node.firstChild;
+			uint32_t high = node.firstChild + node.childCount;
+			while (low < high)
+			{
+				uint32_t mid = (low + high) / 2;
+				if (nodes[mid].*pSymbol < symbol)
+				{
+					low = mid + 1;
+				}
+				else
+				{
+					high = mid;
+				}
+			}
+
+			if (low < node.firstChild + node.childCount && nodes[low].*pSymbol == symbol)
+			{
+				return low;
+			}
+
+			return SORTED_TRIE_NO_NODE;
+		}
+	};
@@ -0,0 +1,103 @@
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+#include "stdafx.h"
+#include <algorithm>
+#include "SuggestionList.h"
+
+	// Constructor
+	SuggestionList::SuggestionList(void)
+	{
+	}
+
+	// Destructor
+	SuggestionList::~SuggestionList(void)
+	{
+	}
+
+	// Empty the list
+	void SuggestionList::Clear(void)
+	{
+		_suggestions.clear();
+	}
+
+	// Add the suggestions returned by the engine
+	void SuggestionList::AddEngineSuggestions(const KPTSuggWordsReplyT &reply)
+	{
+		size_t index;
+		for (index = 0; index < reply.count; index++)
+		{
+			const KPTSuggEntryT &entry = reply.suggestions[index];
+
+			SuggestionT suggestion;
+			if (entry.suggestionString != NULL)
+			{
+				suggestion.text.assign(entry.suggestionString, entry.suggestionLength);
+			}
+			suggestion.type = entry.suggestionType;
+			suggestion.engineIndex = index;
+			suggestion.replaceLength = 0;
+			_suggestions.push_back(suggestion);
+		}
+	}
+
+	// Add a native suggestion unless the list already contains the same string
+	bool SuggestionList::AddNative(const KPTUniCharT *text, size_t length, uint32_t type, size_t replaceLength)
+	{
+		if (length == 0 || Contains(text, length))
+		{
+			return false;
+		}
+
+		SuggestionT suggestion;
+		suggestion.text.assign(text, length);
+		suggestion.type = type;
+		suggestion.engineIndex = NO_ENGINE_INDEX;
+		suggestion.replaceLength = replaceLength;
+		_suggestions.push_back(suggestion);
+
+		return true;
+	}
+
+	// See whether the list contains a string
+	bool SuggestionList::Contains(const KPTUniCharT *text, size_t length) const
+	{
+		for (size_t i = 0; i < _suggestions.size(); i++)
+		{
+			if (_suggestions[i].text.compare(0, std::wstring::npos, text, length) == 0)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	// Reorder the suggestions by descending weight, keeping the current order among suggestions of equal weight
+	void SuggestionList::SortByWeight(const std::vector<float> &weights)
+	{
+		std::vector<size_t> order(_suggestions.size());
+		for (size_t i = 0; i < order.size(); i++)
+		{
+			order[i] = i;
+		}
+		std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return weights[a] > weights[b]; });
+
+		std::vector<SuggestionT> sorted;
+		sorted.reserve(_suggestions.size());
+		for (size_t i = 0; i < order.size(); i++)
+		{
+			sorted.push_back(_suggestions[order[i]]);
+		}
+		_suggestions.swap(sorted);
+	}
@@ -0,0 +1,50 @@
+#pragma once
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+
+#include <string>
+#include <vector>
+#include "kptapi.h"
+#include "kptapi_suggs.h"
+
+	#define NO_ENGINE_INDEX ((size_t)-1)
+
+	// A suggestion from the OpenAdaptxt engine or from the native prediction structures
+	struct SuggestionT
+	{
+		std::wstring text;		// Suggestion string
+		uint32_t type;			// KPTSUGGSTYPE_* value
+		size_t engineIndex;		// Index in the engine's reply, or NO_ENGINE_INDEX for native suggestions
+		size_t replaceLength;	// Number of characters before the cursor that a native suggestion replaces
+	};
+
+	// Merged list of suggestions to send to the client
+	class SuggestionList
+	{
+	private:
+		std::vector<SuggestionT> _suggestions;
+
+	public:
+		SuggestionList(void);
+		~SuggestionList(void);
+
+		void Clear(void);
+		void AddEngineSuggestions(const KPTSuggWordsReplyT &reply);
+		bool AddNative(const KPTUniCharT *text, size_t length, uint32_t type, size_t replaceLength);
+		bool Contains(const KPTUniCharT *text, size_t length) const;
+		void SortByWeight(const std::vector<float> &weights);
+
+		size_t Count(void) const { return _suggestions.size(); }
+		const SuggestionT &Get(size_t index) const { return _suggestions[index]; }
+	};
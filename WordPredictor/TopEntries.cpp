@@ -0,0 +1,47 @@
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+#include "stdafx.h"
+#include "TopEntries.h"
+
+	// Constructor, which empties the caller's list
+	TopEntries::TopEntries(std::vector<uint32_t> &entries, size_t maxCount) : _entries(entries)
+	{
+		_entries.clear();
+		_maxCount = maxCount;
+	}
+
+	// Destructor
+	TopEntries::~TopEntries(void)
+	{
+	}
+
+	// Offer an entry, which is listed if it scores higher than the last of a full list
+	void TopEntries::Add(uint32_t entry, float score)
+	{
+		size_t i = _entries.size();
+		while (i > 0 && _scores[i - 1] < score)
+		{
+			i--;
+		}
+		if (i < _maxCount)
+		{
+			_entries.insert(_entries.begin() + i, entry);
+			_scores.insert(_scores.begin() + i, score);
+			if (_entries.size() > _maxCount)
+			{
+				_entries.pop_back();
+				_scores.pop_back();
+			}
+		}
+	}
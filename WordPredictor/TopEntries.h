@@ -0,0 +1,36 @@
+#pragma once
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+
+#include <vector>
+#include "kptapi.h"
+
+	// List of the best few entries offered, highest score first, kept in a caller's vector of entry indexes.
+	// An entry that ties with one already listed goes after it, so entries offered in order keep that order.
+	class TopEntries
+	{
+	private:
+		std::vector<uint32_t> &_entries;
+		std::vector<float> _scores;
+		size_t _maxCount;
+
+	public:
+		TopEntries(std::vector<uint32_t> &entries, size_t maxCount);
+		~TopEntries(void);
+
+		void Add(uint32_t entry, float score);
+
+	private:
+		TopEntries &operator=(const TopEntries &);
+	};
@@ -0,0 +1,148 @@
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+#include "stdafx.h"
+#include "WordListFile.h"
+
+	// Constructor
+	WordListReader::WordListReader(void)
+	{
+		_pFile = NULL;
+	}
+
+	// Destructor
+	WordListReader::~WordListReader(void)
+	{
+		Close();
+	}
+
+	// Open a word list for reading
+	bool WordListReader::Open(const KPTSysCharT *pFilePath)
+	{
+		Close();
+		if (0 != _wfopen_s(&_pFile, pFilePath, _T("rt, ccs=UTF-8")) || _pFile == NULL)
+		{
+			_pFile = NULL;
+			return false;
+		}
+		setvbuf(_pFile, NULL, _IOFBF, PD_IO_BUFFER_BYTES);
+
+		return true;
+	}
+
+	// Close the file
+	void WordListReader::Close(void)
+	{
+		if (_pFile != NULL)
+		{
+			fclose(_pFile);
+			_pFile = NULL;
+		}
+	}
+
+	// Read up to a number of words, or return false at the end of the file
+	// Words with no count are given a count of one, and lines that are blank or too long are skipped
+	bool WordListReader::ReadBatch(std::vector<WordCountT> &words, size_t maxCount)
+	{
+		words.clear();
+		if (_pFile == NULL)
+		{
+			return false;
+		}
+
+		KPTUniCharT line[MAX_STR_LEN];
+		while (words.size() < maxCount && fgetws(line, MAX_STR_LEN, _pFile) != NULL)
+		{
+			size_t lineLength = wcslen(line);
+			if (lineLength == MAX_STR_LEN - 1 && line[lineLength - 1] != L'\n')
+			{
+				// Skip the rest of an overlong line
+				while (fgetws(line, MAX_STR_LEN, _pFile) != NULL && line[wcslen(line) - 1] != L'\n')
+				{
+				}
+				continue;
+			}
+
+			size_t length = wcscspn(line, _T("\t\r\n"));
+			if (length == 0 || length > MAX_WORD_LEN)
+			{
+				continue;
+			}
+
+			WordCountT word = { std::wstring(line, length), 1 };
+			if (line[length] == L'\t')
+			{
+				unsigned long count = wcstoul(&line[length + 1], NULL, 10);
+				if (count != 0)
+				{
+					word.count = (uint32_t)count;
+				}
+			}
+			words.push_back(word);
+		}
+
+		return !words.empty();
+	}
+
+	// Constructor
+	WordListWriter::WordListWriter(void)
+	{
+		_pFile = NULL;
+		_success = false;
+	}
+
+	// Destructor
+	WordListWriter::~WordListWriter(void)
+	{
+		Close();
+	}
+
+	// Create a word list, replacing any existing file
+	bool WordListWriter::Open(const KPTSysCharT *pFilePath)
+	{
+		Close();
+		if (0 != _wfopen_s(&_pFile, pFilePath, _T("wt, ccs=UTF-8")) || _pFile == NULL)
+		{
+			_pFile = NULL;
+			return false;
+		}
+		setvbuf(_pFile, NULL, _IOFBF, PD_IO_BUFFER_BYTES);
+		_success = true;
+
+		return true;
+	}
+
+	// Close the file, returning whether everything was written
+	bool WordListWriter::Close(void)
+	{
+		if (_pFile == NULL)
+		{
+			return false;
+		}
+
+		bool success = (fclose(_pFile) == 0) && _success;
+		_pFile = NULL;
+
+		return success;
+	}
+
+	// Write some words and their counts
+	void WordListWriter::WriteWords(const std::vector<WordCountT> &words)
+	{
+		wchar_t countStr[32];
+		for (size_t i = 0; i < words.size() && _success; i++)
+		{
+			swprintf_s(countStr, 32, _T("\t%u\n"), (unsigned)(std::max)(words[i].count, 1u));
+			_success = fputws(words[i].word.c_str(), _pFile) >= 0 && fputws(countStr, _pFile) >= 0;
+		}
+	}
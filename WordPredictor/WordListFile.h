@@ -0,0 +1,52 @@
+#pragma once
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+
+#include <stdio.h>
+#include <vector>
+#include "kptapi.h"
+#include "CorpusLearner.h"
+
+	// Reads a personal dictionary word list (eKPTPDFormatWordList) a batch of words at a time, so that memory use doesn't
+	// depend on the size of the file. The file is UTF-8 text with one word per line, optionally followed by a tab and its
+	// count, and is read through a fixed-size buffer.
+	class WordListReader
+	{
+	private:
+		FILE *_pFile;
+
+	public:
+		WordListReader(void);
+		~WordListReader(void);
+
+		bool Open(const KPTSysCharT *pFilePath);
+		void Close(void);
+		bool ReadBatch(std::vector<WordCountT> &words, size_t maxCount);
+	};
+
+	// Writes a personal dictionary word list in the format read by WordListReader through a fixed-size buffer
+	class WordListWriter
+	{
+	private:
+		FILE *_pFile;
+		bool _success;
+
+	public:
+		WordListWriter(void);
+		~WordListWriter(void);
+
+		bool Open(const KPTSysCharT *pFilePath);
+		bool Close(void);
+		void WriteWords(const std::vector<WordCountT> &words);
+	};
@@ -29,6 +29,30 @@ STDMETHODIMP CWordPredictorCom::Create(BSTR basePath)
 	// Install new packages
 	_framework.PACKAGE_INSTALLNEW();
 
+	// Load the native structures for the active dictionaries
+	KPTUniCharT dictList[MAX_STR_LEN];
+	KPTSuggConfigT config = { 0 };
+	uint32_t learnOptions = 0;
+	KPTPDConfigT personalConfig = { 0 };
+	_engine.Create(basePath);
+	if (KPTRESULT_ISSUCCESS(_framework.DICTIONARY_GETACTIVELIST(dictList, MAX_STR_LEN)))
+	{
+		_engine.LoadDictionaries(dictList);
+	}
+	if (KPTRESULT_ISSUCCESS(_framework.SUGGS_GETCONFIG(config)))
+	{
+		_engine.SetErrorCorrection(config.errorCorrectionOn == eKPTTrue);
+		_engine.SetPhraseCompletions(config.numElisionCompletions);
+	}
+	if (KPTRESULT_ISSUCCESS(_framework.LEARN_GETOPTIONS(learnOptions)))
+	{
+		_engine.SetLearning((learnOptions & eKPTLearnEnabled) != 0);
+	}
+	if (KPTRESULT_ISSUCCESS(_framework.PERSONAL_GETCONFIG(personalConfig)) && personalConfig.maxEntries != 0)
+	{
+		_engine.SetPersonalCapacity(personalConfig.maxEntries);
+	}
+
 	// DEBUG
 	//_framework.PACKAGE_GETAVAILABLE();
 	//_framework.PACKAGE_UNINSTALL_ALL();
@@ -46,6 +70,9 @@ STDMETHODIMP CWordPredictorCom::Create(BSTR basePath)
 STDMETHODIMP CWordPredictorCom::Destroy()
 {
 	TRACE(_T("Destroying framework...\n"));
+	_learner.Cancel();
+	_learnState = LEARN_STATE_IDLE;
+	_engine.Destroy();
 	_framework.Destroy();
 	TRACE(_T("Destroyed framework.\n"));
 
@@ -95,6 +122,32 @@ STDMETHODIMP CWordPredictorCom::ProcessRequest(SAFEARRAY *requestMeta, SAFEARRAY
 				result = ProcessUninstallPackages(); break;
 			case REQUEST_SET_ACTIVE_DICTIONARIES:
 				result = ProcessSetActiveDictionaries(inMeta, inData); break;
+			case REQUEST_CONFIGURE_CORRECTION:
+				result = ProcessConfigureCorrection(inMeta); break;
+			case REQUEST_GET_NEXT_LETTERS:
+				result = ProcessGetNextLetters(); break;
+			case REQUEST_CONFIGURE_PHRASES:
+				result = ProcessConfigurePhrases(inMeta); break;
+			case REQUEST_SET_KEY_GROUPS:
+				result = ProcessSetKeyGroups(inData); break;
+			case REQUEST_INSERT_AMBIGUOUS:
+				result = ProcessInsertAmbiguous(inMeta); break;
+			case REQUEST_SET_PERSONAL_CAPACITY:
+				result = ProcessSetPersonalCapacity(inData); break;
+			case REQUEST_GET_PERSONAL_STATUS:
+				result = ProcessGetPersonalStatus(); break;
+			case REQUEST_LEARN_FILES:
+				result = ProcessLearnFiles(inData); break;
+			case REQUEST_GET_PERSONAL_PAGE:
+				result = ProcessGetPersonalPage(inMeta, inData); break;
+			case REQUEST_EXPORT_PERSONAL:
+				result = ProcessExportPersonal(inMeta, inData); break;
+			case REQUEST_IMPORT_PERSONAL:
+				result = ProcessImportPersonal(inMeta, inData); break;
+			case REQUEST_SET_PARTITION:
+				result = ProcessSetPartition(inData); break;
+			case REQUEST_GET_LEARN_PROGRESS:
+				result = ProcessGetLearnProgress(); break;
 			default:
 				result = RESPONSE_ERROR_UNRECOGNISED_MSG_TYPE; break;
 		}
@@ -119,6 +172,7 @@ int CWordPredictorCom::ProcessReset(CComSafeArray<byte> &inMeta)
 
 	if (KPTRESULT_ISSUCCESS(_framework.INPUTMGR_RESET()))
 	{		
+		_engine.ResetInput();
 		if (inMeta.GetCount() > 1)
 		{
 			if (inMeta[1] == REQUEST_GET_SUGGESTIONS)
@@ -141,8 +195,9 @@ int CWordPredictorCom::ProcessInsertString(CComSafeArray<byte> &inMeta, CComSafe
 	int result = S_OK;
 
 	if (inData.GetCount() > 0 && 
-		KPTRESULT_ISSUCCESS(_framework.INPUTMGR_INSERTSTRING(inData[0], inData[0].Length())))
+		KPTRESULT_ISSUCCESS(_framework.INPUTMGR_INSERTSTRING(inData[0], inData[0].Length(), 0)))
 	{
+		_engine.InsertString(inData[0], inData[0].Length());
 		if (inMeta.GetCount() > 1)
 		{
 			if (inMeta[1] == REQUEST_GET_SUGGESTIONS)
@@ -169,6 +224,7 @@ int CWordPredictorCom::ProcessMoveCursorRelative(CComSafeArray<byte> &inMeta)
 	if (inMeta.GetCount() > 3 && 
 		KPTRESULT_ISSUCCESS(_framework.INPUTMGR_MOVECURSOR(eKPTSeekRelative, (int)inMeta[3] - (int)inMeta[2])))
 	{
+		_engine.MoveCursor((int)inMeta[3] - (int)inMeta[2]);
 		if (inMeta[1] == REQUEST_GET_SUGGESTIONS)
 		{
 			result = CreateSuggestionsResponse();
@@ -191,6 +247,7 @@ int CWordPredictorCom::ProcessRemoveChars(CComSafeArray<byte> &inMeta)
 	if (inMeta.GetCount() > 3 &&
 		KPTRESULT_ISSUCCESS(_framework.INPUTMGR_REMOVE(inMeta[2], inMeta[3])))
 	{
+		_engine.RemoveChars(inMeta[2], inMeta[3]);
 		if (inMeta[1] == REQUEST_GET_SUGGESTIONS)
 		{
 			result = CreateSuggestionsResponse();
@@ -208,11 +265,30 @@ int CWordPredictorCom::ProcessRemoveChars(CComSafeArray<byte> &inMeta)
 int CWordPredictorCom::ProcessInsertSuggestion(CComSafeArray<byte> &inMeta)
 {
 	int result = S_OK;
+	KPTResultT insertResult = KPTRESULT_MAKE(KPT_SV_ERROR, KPT_COMPONENTID_INVALID, KPT_SC_ERROR);
+	KPTInpMgrRemoveCharsT removed = { 0 };
+	KPTUniCharT inserted[MAX_STR_LEN];
 
 	// Index 2 is the zero-based suggestion index (not ID)
-	if (inMeta.GetCount() > 2 &&
-		KPTRESULT_ISSUCCESS(_framework.INPUTMGR_INSERTSUGG(inMeta[2])))
+	if (inMeta.GetCount() > 2 && inMeta[2] < _suggestions.Count())
 	{
+		// Engine suggestions are inserted by ID, native ones replace the current word prefix
+		const SuggestionT &suggestion = _suggestions.Get(inMeta[2]);
+		if (suggestion.engineIndex != NO_ENGINE_INDEX)
+		{
+			insertResult = _framework.INPUTMGR_INSERTSUGG(suggestion.engineIndex, removed, inserted, MAX_STR_LEN);
+		}
+		else
+		{
+			insertResult = _framework.INPUTMGR_INSERTSTRING(suggestion.text.c_str(), suggestion.text.length(), suggestion.replaceLength);
+			removed.numBeforeCursor = suggestion.replaceLength;
+			wcsncpy_s(inserted, MAX_STR_LEN, suggestion.text.c_str(), _TRUNCATE);
+		}
+	}
+
+	if (KPTRESULT_ISSUCCESS(insertResult))
+	{
+		_engine.InsertSuggestion(removed.numBeforeCursor, removed.numAfterCursor, inserted, wcslen(inserted));
 		if (inMeta[1] == REQUEST_GET_SUGGESTIONS)
 		{
 			result = CreateSuggestionsResponse();
@@ -244,6 +320,10 @@ int CWordPredictorCom::ProcessConfigureLearning(CComSafeArray<byte> &inMeta)
 		{
 			result = RESPONSE_ERROR_CONFIGURE_LEARNING;
 		}
+		else
+		{
+			_engine.SetLearning(inMeta[1] != 0);
+		}
 	}
 	else
 	{
@@ -262,6 +342,7 @@ int CWordPredictorCom::ProcessSetCursor(CComSafeArray<byte> &inMeta)
 	if (inMeta.GetCount() > 2 &&
 		KPTRESULT_ISSUCCESS(_framework.INPUTMGR_MOVECURSOR(eKPTSeekStart, (int)inMeta[2])))
 	{
+		_engine.SetCursor(inMeta[2]);
 		if (inMeta[1] == REQUEST_GET_SUGGESTIONS)
 		{
 			result = CreateSuggestionsResponse();
@@ -280,7 +361,12 @@ int CWordPredictorCom::ProcessInstallPackages()
 {
 	int result = S_OK;
 
-	if (!KPTRESULT_ISSUCCESS(_framework.PACKAGE_INSTALLNEW()))
+	if (KPTRESULT_ISSUCCESS(_framework.PACKAGE_INSTALLNEW()))
+	{
+		// Pick up any new native word lists in the background
+		_engine.ReloadDictionaries();
+	}
+	else
 	{
 		result = RESPONSE_ERROR_INSTALL_PACKAGES;
 	}
@@ -293,7 +379,11 @@ int CWordPredictorCom::ProcessUninstallPackages()
 {
 	int result = S_OK;
 
-	if (!KPTRESULT_ISSUCCESS(_framework.PACKAGE_UNINSTALLALL()))
+	if (KPTRESULT_ISSUCCESS(_framework.PACKAGE_UNINSTALLALL()))
+	{
+		_engine.ReloadDictionaries();
+	}
+	else
 	{
 		result = RESPONSE_ERROR_UNINSTALL_PACKAGES;
 	}
@@ -301,7 +391,7 @@ int CWordPredictorCom::ProcessUninstallPackages()
 	return result;
 }
 
-// Set the list of active dictionaries
+// Set the list of active dictionaries, whose native word lists are loaded in the background
 int CWordPredictorCom::ProcessSetActiveDictionaries(CComSafeArray<byte> &inMeta, CComSafeArray<BSTR> &inData)
 {
 	int result = S_OK;
@@ -309,6 +399,7 @@ int CWordPredictorCom::ProcessSetActiveDictionaries(CComSafeArray<byte> &inMeta,
 	if (inData.GetCount() > 0 && 
 		KPTRESULT_ISSUCCESS(_framework.DICTIONARY_SETACTIVELIST(inData[0])))
 	{
+		_engine.LoadDictionaries(inData[0]);
 		result = S_OK;
 	}
 	else
@@ -319,12 +410,400 @@ int CWordPredictorCom::ProcessSetActiveDictionaries(CComSafeArray<byte> &inMeta,
 	return result;
 }
 
+// Configure the error correction deletion index and report its memory footprint in bytes
+// The index is rebuilt in the background, so the footprint reported is that of the index in use until the new one is ready
+int CWordPredictorCom::ProcessConfigureCorrection(CComSafeArray<byte> &inMeta)
+{
+	int result = S_OK;
+
+	// Index 1 is the maximum edit distance to index (0 = no index), index 2 is the number of leading characters of each word to index
+	if (inMeta.GetCount() > 2 &&
+		_engine.ConfigureDeletionIndex(inMeta[1], inMeta[2]))
+	{
+		wchar_t sizeStr[32];
+		swprintf_s(sizeStr, 32, _T("%llu"), (unsigned long long)_engine.GetDeletionIndexSize());
+		WriteStringIntoResponse(sizeStr);
+	}
+	else
+	{
+		result = RESPONSE_ERROR_CONFIGURE_CORRECTION;
+	}
+
+	return result;
+}
+
+// Report the probability of each character that could be typed next, most likely first
+// The probabilities come from the word frequencies of the native lexicon. OpenAdaptxt's next letter set has no
+// probabilities, so without the native lexicon, or when no word continues the prefix, this reports an error instead.
+int CWordPredictorCom::ProcessGetNextLetters()
+{
+	int result = S_OK;
+
+	// Each string is the character (a space for the end of the word) followed by its probability
+	_engine.GetNextLetters(_nextLetters);
+	if (!_nextLetters.empty())
+	{
+		wchar_t letterStr[32];
+		for (size_t i = 0; i < _nextLetters.size(); i++)
+		{
+			swprintf_s(letterStr, 32, _T("%c%.4f"), _nextLetters[i].ch, _nextLetters[i].prob);
+			WriteStringIntoResponse(letterStr);
+		}
+	}
+	else
+	{
+		result = RESPONSE_ERROR_GET_NEXT_LETTERS;
+	}
+
+	return result;
+}
+
+// Set how many multi-word phrase completions to suggest
+int CWordPredictorCom::ProcessConfigurePhrases(CComSafeArray<byte> &inMeta)
+{
+	int result = S_OK;
+	KPTSuggConfigT config = { 0 };
+
+	// Index 1 is the maximum number of phrase completions (0 = off), which also applies to the engine's elisions
+	config.fieldMask = eKPTSuggsConfigMaxElisions;
+	config.numElisionCompletions = inMeta.GetCount() > 1 ? inMeta[1] : 0;
+	if (inMeta.GetCount() > 1 &&
+		KPTRESULT_ISSUCCESS(_framework.SUGGS_SETCONFIG(config)))
+	{
+		_engine.SetPhraseCompletions(config.numElisionCompletions);
+	}
+	else
+	{
+		result = RESPONSE_ERROR_CONFIGURE_PHRASES;
+	}
+
+	return result;
+}
+
+// Set the characters on each key of a grouped-letter keyboard
+int CWordPredictorCom::ProcessSetKeyGroups(CComSafeArray<BSTR> &inData)
+{
+	int result = S_OK;
+
+	// Each string is the characters on one key, e.g. "abc", "def", ...
+	std::vector<std::wstring> keyGroups;
+	for (LONG i = 0; i < (LONG)inData.GetCount(); i++)
+	{
+		keyGroups.push_back(std::wstring(inData[i], inData[i].Length()));
+	}
+
+	if (!_engine.SetKeyGroups(keyGroups))
+	{
+		result = RESPONSE_ERROR_SET_KEY_GROUPS;
+	}
+
+	return result;
+}
+
+// Insert the character for a grouped-letter key as ambiguous
+int CWordPredictorCom::ProcessInsertAmbiguous(CComSafeArray<byte> &inMeta)
+{
+	int result = S_OK;
+
+	// Index 2 is the zero-based key group
+	KPTUniCharT ch = inMeta.GetCount() > 2 ? _engine.GetKeyChar(inMeta[2]) : L'\0';
+	if (ch != L'\0' &&
+		KPTRESULT_ISSUCCESS(_framework.INPUTMGR_INSERTCHAR(ch, eKPTInsertAmbiguous, inMeta[2])))
+	{
+		_engine.InsertAmbiguousKey(inMeta[2]);
+		if (inMeta[1] == REQUEST_GET_SUGGESTIONS)
+		{
+			result = CreateSuggestionsResponse();
+		}
+	}
+	else
+	{
+		result = RESPONSE_ERROR_INSERT_AMBIGUOUS;
+	}
+
+	return result;
+}
+
+// Set the maximum number of words in the personal dictionaries
+int CWordPredictorCom::ProcessSetPersonalCapacity(CComSafeArray<BSTR> &inData)
+{
+	int result = S_OK;
+	KPTPDConfigT config = { 0 };
+
+	// The first string is the capacity in decimal
+	if (inData.GetCount() > 0)
+	{
+		config.maxEntries = wcstoul(inData[0], NULL, 10);
+	}
+	if (config.maxEntries != 0 &&
+		KPTRESULT_ISSUCCESS(_framework.PERSONAL_SETCONFIG(config)))
+	{
+		_engine.SetPersonalCapacity(config.maxEntries);
+	}
+	else
+	{
+		result = RESPONSE_ERROR_SET_PERSONAL_CAPACITY;
+	}
+
+	return result;
+}
+
+// Get the number of learned words and the capacity of the personal dictionary
+int CWordPredictorCom::ProcessGetPersonalStatus()
+{
+	int result = S_OK;
+
+	wchar_t numberStr[32];
+	swprintf_s(numberStr, 32, _T("%u"), (unsigned)_engine.GetPersonalCount());
+	WriteStringIntoResponse(numberStr);
+	swprintf_s(numberStr, 32, _T("%u"), (unsigned)_engine.GetPersonalCapacity());
+	WriteStringIntoResponse(numberStr);
+
+	return result;
+}
+
+// Get a page of the learned words in the personal dictionary, sorted in one of the view orders
+int CWordPredictorCom::ProcessGetPersonalPage(CComSafeArray<byte> &inMeta, CComSafeArray<BSTR> &inData)
+{
+	int result = S_OK;
+
+	// Index 1 is the view order, and the strings are the position of the first word and the number of words in decimal
+	std::vector<WordCountT> words;
+	if (inMeta.GetCount() > 1 && inData.GetCount() > 1 &&
+		_engine.GetPersonalPage((KPTPDViewOptionT)inMeta[1], wcstoul(inData[0], NULL, 10), wcstoul(inData[1], NULL, 10), words))
+	{
+		// Write the total number of words, then each word followed by its count
+		wchar_t numberStr[32];
+		swprintf_s(numberStr, 32, _T("%u"), (unsigned)_engine.GetPersonalCount());
+		WriteStringIntoResponse(numberStr);
+		for (size_t i = 0; i < words.size(); i++)
+		{
+			WriteStringIntoResponse(words[i].word.c_str());
+			swprintf_s(numberStr, 32, _T("%u"), words[i].count);
+			WriteStringIntoResponse(numberStr);
+		}
+	}
+	else
+	{
+		result = RESPONSE_ERROR_GET_PERSONAL_PAGE;
+	}
+
+	return result;
+}
+
+// Export the personal dictionary to a word list file, whose path is the first string
+// Index 1 is which dictionary to export (0 = learned words, 1 = the engine's personal dictionary)
+int CWordPredictorCom::ProcessExportPersonal(CComSafeArray<byte> &inMeta, CComSafeArray<BSTR> &inData)
+{
+	int result = S_OK;
+
+	if (inMeta.GetCount() > 1 && inData.GetCount() > 0)
+	{
+		size_t numWords = 0;
+		if (inMeta[1] == 0 && _engine.ExportPersonal(inData[0], numWords))
+		{
+			wchar_t numberStr[32];
+			swprintf_s(numberStr, 32, _T("%u"), (unsigned)numWords);
+			WriteStringIntoResponse(numberStr);
+		}
+		else if (inMeta[1] != 1 || !KPTRESULT_ISSUCCESS(_framework.PERSONAL_EXPORTTOFILE(inData[0], eKPTPDFormatWordList)))
+		{
+			result = RESPONSE_ERROR_EXPORT_PERSONAL;
+		}
+	}
+	else
+	{
+		result = RESPONSE_ERROR_EXPORT_PERSONAL;
+	}
+
+	return result;
+}
+
+// Import a word list file, whose path is the first string, into the personal dictionary
+// Index 1 is how to import it (0 = stream it into both dictionaries a batch at a time, 1 = the engine's own import only)
+int CWordPredictorCom::ProcessImportPersonal(CComSafeArray<byte> &inMeta, CComSafeArray<BSTR> &inData)
+{
+	int result = S_OK;
+
+	if (inMeta.GetCount() < 2 || inData.GetCount() < 1)
+	{
+		return RESPONSE_ERROR_IMPORT_PERSONAL;
+	}
+	if (inMeta[1] == 1)
+	{
+		return KPTRESULT_ISSUCCESS(_framework.PERSONAL_IMPORTFROMFILE(inData[0], eKPTPDFormatWordList)) ? S_OK : RESPONSE_ERROR_IMPORT_PERSONAL;
+	}
+
+	WordListReader reader;
+	if (inMeta[1] != 0 || !reader.Open(inData[0]))
+	{
+		return RESPONSE_ERROR_IMPORT_PERSONAL;
+	}
+
+	// Add each batch to the engine's personal dictionary as well as the learned words
+	size_t numWords = 0;
+	std::vector<WordCountT> words;
+	std::vector<KPTUniCharT *> wordPointers;
+	while (reader.ReadBatch(words, PD_IO_BATCH))
+	{
+		_engine.ImportWords(words);
+
+		wordPointers.clear();
+		for (size_t i = 0; i < words.size(); i++)
+		{
+			wordPointers.push_back(const_cast<KPTUniCharT *>(words[i].word.c_str()));
+		}
+		KPTPDAddWordsT addWords = { 0 };
+		addWords.numToAdd = wordPointers.size();
+		addWords.wordsToAdd = wordPointers.data();
+		if (!KPTRESULT_ISSUCCESS(_framework.PERSONAL_ADDWORDS(addWords)))
+		{
+			result = RESPONSE_ERROR_IMPORT_PERSONAL;
+		}
+		numWords += words.size();
+	}
+
+	wchar_t numberStr[32];
+	swprintf_s(numberStr, 32, _T("%u"), (unsigned)numWords);
+	WriteStringIntoResponse(numberStr);
+
+	return result;
+}
+
+// Learn into the partition named by the first string e.g. the application's name, or the shared partition if it is empty or missing
+// Only the engine's personal dictionary is partitioned, as the OpenAdaptxt engine keeps a single one
+int CWordPredictorCom::ProcessSetPartition(CComSafeArray<BSTR> &inData)
+{
+	int result = S_OK;
+
+	const wchar_t *name = (inData.GetCount() > 0 && inData[0] != NULL) ? (const wchar_t *)inData[0] : _T("");
+	if (_engine.SetPartition(name))
+	{
+		// Write the number of words learned in the partition
+		wchar_t numberStr[32];
+		swprintf_s(numberStr, 32, _T("%u"), (unsigned)_engine.GetPersonalCount());
+		WriteStringIntoResponse(numberStr);
+	}
+	else
+	{
+		result = RESPONSE_ERROR_SET_PARTITION;
+	}
+
+	return result;
+}
+
+// Trace the progress of counting the words in files, which is called on the counting thread
+static KPTResultT KPT_CALLB LearnFilesProgress(const KPTProgressDataT *pProgress, intptr_t context)
+{
+	TRACE(_T("Learning from files: %u of %u files, %u of %u bytes\n"),
+		(unsigned)pProgress->current.position, (unsigned)pProgress->current.maximum,
+		(unsigned)pProgress->overall.position, (unsigned)pProgress->overall.maximum);
+
+	return KPTRESULT_SUCCESS;
+}
+
+// Start learning the words in a set of text files, one file path per string
+// The files are counted in parallel in the background, and the client polls for progress with REQUEST_GET_LEARN_PROGRESS,
+// which learns the words once they have been counted
+int CWordPredictorCom::ProcessLearnFiles(CComSafeArray<BSTR> &inData)
+{
+	int result = S_OK;
+
+	std::vector<std::wstring> filePaths;
+	for (LONG i = 0; i < (LONG)inData.GetCount(); i++)
+	{
+		filePaths.push_back(std::wstring(inData[i]));
+	}
+
+	if (!filePaths.empty() && (_learnState == LEARN_STATE_IDLE || _learnState == LEARN_STATE_DONE) && _learner.Start(filePaths, LearnFilesProgress, 0))
+	{
+		_learnState = LEARN_STATE_COUNTING;
+		_learnDistinct = 0;
+		_learnAdmitted = 0;
+
+		// Write the number of files to be read
+		wchar_t numberStr[32];
+		swprintf_s(numberStr, 32, _T("%u"), (unsigned)filePaths.size());
+		WriteStringIntoResponse(numberStr);
+	}
+	else
+	{
+		result = RESPONSE_ERROR_LEARN_FILES;
+	}
+
+	return result;
+}
+
+// Report the progress of learning from files, and learn the words once they have been counted
+// The engine can only be used on this thread, so the counted words are learned here, a few buffers per request
+int CWordPredictorCom::ProcessGetLearnProgress()
+{
+	int result = S_OK;
+
+	if (_learnState == LEARN_STATE_COUNTING && _learner.IsCounted())
+	{
+		if (_learner.FinishCounting())
+		{
+			_learnDistinct = _learner.Counts().size();
+			_engine.LearnCounts(_learner.Counts());
+			_learnAdmitted = _learner.Counts().size();
+			_learnState = LEARN_STATE_LEARNING;
+		}
+		else
+		{
+			_learnState = LEARN_STATE_IDLE;
+			result = RESPONSE_ERROR_GET_LEARN_PROGRESS;
+		}
+	}
+
+	// Send the admitted words to the engine, each repeated as often as it occurred, up to a cap
+	if (_learnState == LEARN_STATE_LEARNING)
+	{
+		std::vector<KPTUniCharT> buffer;
+		KPTLearningStageT stage;
+		for (size_t i = 0; i < LEARN_BUFFERS_PER_REQUEST && result == S_OK; i++)
+		{
+			if (!_learner.GetLearnBuffer(buffer, stage))
+			{
+				break;
+			}
+			if (!KPTRESULT_ISSUCCESS(_framework.LEARN_BUFFER(buffer.data(), buffer.size(), stage)))
+			{
+				result = RESPONSE_ERROR_GET_LEARN_PROGRESS;
+			}
+		}
+		if (result != S_OK || _learner.LearnedCount() == _learnAdmitted)
+		{
+			_learnState = LEARN_STATE_DONE;
+		}
+	}
+
+	if (result == S_OK)
+	{
+		// Write the state, files read, bytes read, distinct words found, words admitted, words sent to the engine and total words
+		KPTProgressDataT progress;
+		_learner.GetProgress(progress);
+		unsigned long long values[] = { (unsigned long long)_learnState,
+			(unsigned long long)progress.current.position, (unsigned long long)progress.current.maximum,
+			(unsigned long long)progress.overall.position, (unsigned long long)progress.overall.maximum,
+			(unsigned long long)_learnDistinct, (unsigned long long)_learnAdmitted,
+			(unsigned long long)_learner.LearnedCount(), (unsigned long long)_learner.TokenCount() };
+		wchar_t numberStr[32];
+		for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+		{
+			swprintf_s(numberStr, 32, _T("%llu"), values[i]);
+			WriteStringIntoResponse(numberStr);
+		}
+	}
+
+	return result;
+}
+
 // Create a message containing word suggestions to send to the client
 int CWordPredictorCom::CreateSuggestionsResponse()
 {
 	int result = S_OK;
 	size_t sugLoop;
-	const KPTUniCharT *pStr;
 	KPTInpMgrCurrentWordT currentWord = { 0 };
 	const KPTUniCharT *pPrefix = NULL;
 	const KPTUniCharT *pSuffix = NULL;
@@ -344,14 +823,17 @@ int CWordPredictorCom::CreateSuggestionsResponse()
 
 	if (KPTRESULT_ISSUCCESS(_framework.SUGGS_GETSUGGESTIONS()))
 	{
-		const KPTSuggWordsReplyT suggReply = _framework.GetCurrentSuggestions();
-		for (sugLoop = 0; sugLoop < suggReply.count; sugLoop++)
+		// Merge the engine's suggestions with native ones
+		_suggestions.Clear();
+		_suggestions.AddEngineSuggestions(_framework.GetCurrentSuggestions());
+		_engine.AddSuggestions(_suggestions);
+
+		for (sugLoop = 0; sugLoop < _suggestions.Count(); sugLoop++)
 		{
-			pStr = suggReply.suggestions[sugLoop].suggestionString;
-			//TRACE(_T("Suggestion: %s\n"), pStr);
+			//TRACE(_T("Suggestion: %s\n"), _suggestions.Get(sugLoop).text.c_str());
 
 			// Write the string into the response
-			WriteStringIntoResponse(pStr);
+			WriteStringIntoResponse(_suggestions.Get(sugLoop).text.c_str());
 		}
 	}
 	else
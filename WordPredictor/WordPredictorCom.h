@@ -19,6 +19,8 @@
 // WordPredictor includes
 #include "Constants.h"
 #include "FrameworkWrapper.h"
+#include "PredictionEngine.h"
+#include "SuggestionList.h"
 
 
 #if defined(_WIN32_WCE) && !defined(_CE_DCOM) && !defined(_CE_ALLOW_SINGLE_THREADED_OBJECTS_IN_MTA)
@@ -38,6 +40,9 @@ class ATL_NO_VTABLE CWordPredictorCom :
 public:
 	CWordPredictorCom()
 	{
+		_learnState = LEARN_STATE_IDLE;
+		_learnDistinct = 0;
+		_learnAdmitted = 0;
 	}
 
 DECLARE_REGISTRY_RESOURCEID(IDR_WORDPREDICTORCOM)
@@ -72,7 +77,14 @@ public:
 private:
 
 	FrameworkWrapper _framework;
+	PredictionEngine _engine;
+	SuggestionList _suggestions;
+	std::vector<NextLetterT> _nextLetters;
 	CComSafeArray<BSTR> _outData;
+	CorpusLearner _learner;
+	int _learnState;
+	size_t _learnDistinct;
+	size_t _learnAdmitted;
 
 	int ProcessReset(CComSafeArray<byte> &inMeta);
 	int ProcessInsertString(CComSafeArray<byte> &inMeta, CComSafeArray<BSTR> &inData);
@@ -84,6 +96,19 @@ private:
 	int ProcessInstallPackages();
 	int ProcessUninstallPackages();
 	int ProcessSetActiveDictionaries(CComSafeArray<byte> &inMeta, CComSafeArray<BSTR> &inData);
+	int ProcessConfigureCorrection(CComSafeArray<byte> &inMeta);
+	int ProcessGetNextLetters();
+	int ProcessConfigurePhrases(CComSafeArray<byte> &inMeta);
+	int ProcessSetKeyGroups(CComSafeArray<BSTR> &inData);
+	int ProcessInsertAmbiguous(CComSafeArray<byte> &inMeta);
+	int ProcessSetPersonalCapacity(CComSafeArray<BSTR> &inData);
+	int ProcessGetPersonalStatus();
+	int ProcessLearnFiles(CComSafeArray<BSTR> &inData);
+	int ProcessGetPersonalPage(CComSafeArray<byte> &inMeta, CComSafeArray<BSTR> &inData);
+	int ProcessExportPersonal(CComSafeArray<byte> &inMeta, CComSafeArray<BSTR> &inData);
+	int ProcessImportPersonal(CComSafeArray<byte> &inMeta, CComSafeArray<BSTR> &inData);
+	int ProcessSetPartition(CComSafeArray<BSTR> &inData);
+	int ProcessGetLearnProgress();
 
 	int CreateSuggestionsResponse();
 	void WriteStringIntoResponse(const wchar_t *pStr);
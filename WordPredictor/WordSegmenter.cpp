@@ -0,0 +1,131 @@
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+#include "stdafx.h"
+#include <math.h>
+#include <float.h>
+#include <wctype.h>
+#include "WordSegmenter.h"
+
+	// Constructor
+	WordSegmenter::WordSegmenter(void)
+	{
+		_pLexicon = NULL;
+	}
+
+	// Destructor
+	WordSegmenter::~WordSegmenter(void)
+	{
+	}
+
+	// Find the most likely split of some text into two or more words, and return false if there isn't one
+	// firstWords lists lexicon words that are likely to follow the preceding words, with their probabilities
+	bool WordSegmenter::Segment(const KPTUniCharT *text, size_t length, const std::vector<ContextPredictionT> &firstWords, std::wstring &result)
+	{
+		result.clear();
+		if (_pLexicon == NULL || !_pLexicon->IsLoaded() || length < 2 || length > MAX_SEGMENT_LEN)
+		{
+			return false;
+		}
+
+		float totalFrequency = _pLexicon->GetNode(LEXICON_ROOT).totalFrequency;
+		_scores.assign(length + 1, -FLT_MAX);
+		_starts.resize(length + 1);
+		_wordIds.resize(length + 1);
+		_scores[0] = 0.0f;
+		for (size_t start = 0; start < length; start++)
+		{
+			if (_scores[start] == -FLT_MAX)
+			{
+				continue;
+			}
+
+			// Extend the best path to this position by each word that starts here
+			uint32_t nodeIndex = LEXICON_ROOT;
+			for (size_t end = start; end < length && end - start < MAX_WORD_LEN; end++)
+			{
+				nodeIndex = _pLexicon->FindChild(nodeIndex, text[end]);
+				if (nodeIndex == LEXICON_NO_NODE)
+				{
+					break;
+				}
+
+				uint32_t wordId = _pLexicon->GetNode(nodeIndex).wordId;
+				if (wordId != LEXICON_NO_WORD)
+				{
+					float score = _scores[start] + GetWordScore(wordId, totalFrequency, start == 0 ? &firstWords : NULL);
+					if (score > _scores[end + 1])
+					{
+						_scores[end + 1] = score;
+						_starts[end + 1] = (uint32_t)start;
+						_wordIds[end + 1] = wordId;
+					}
+				}
+			}
+		}
+
+		// Trace the best path back from the end
+		if (_scores[length] == -FLT_MAX)
+		{
+			return false;
+		}
+		_path.clear();
+		for (size_t end = length; end > 0; end = _starts[end])
+		{
+			_path.push_back((uint32_t)end);
+		}
+		if (_path.size() < 2)
+		{
+			return false;
+		}
+
+		// Use the lexicon's capitalisation unless a word was typed starting with a capital
+		while (!_path.empty())
+		{
+			size_t end = _path.back();
+			_path.pop_back();
+			size_t start = _starts[end];
+			if (!result.empty())
+			{
+				result.push_back(L' ');
+			}
+			result.append(_pLexicon->GetText(_wordIds[end]));
+			if (iswupper(text[start]))
+			{
+				result[result.length() - (end - start)] = text[start];
+			}
+		}
+
+		return true;
+	}
+
+	// Get the log probability of a word, mixing in its probability given the preceding words if it starts the text
+	float WordSegmenter::GetWordScore(uint32_t wordId, float totalFrequency, const std::vector<ContextPredictionT> *pFirstWords) const
+	{
+		float prob = (float)(std::max)(_pLexicon->GetWord(wordId).frequency, 1u) / totalFrequency;
+		if (pFirstWords != NULL && !pFirstWords->empty())
+		{
+			float contextProb = 0.0f;
+			for (size_t i = 0; i < pFirstWords->size(); i++)
+			{
+				if ((*pFirstWords)[i].wordId == wordId)
+				{
+					contextProb = (*pFirstWords)[i].prob;
+					break;
+				}
+			}
+			prob = (1.0f - SEGMENT_CONTEXT_WEIGHT) * prob + SEGMENT_CONTEXT_WEIGHT * contextProb;
+		}
+
+		return log10f(prob);
+	}
@@ -0,0 +1,43 @@
+#pragma once
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+
+#include <string>
+#include <vector>
+#include "Lexicon.h"
+#include "ContextModel.h"
+
+	// Splits text typed without spaces into the most likely sequence of lexicon words e.g. "inthe" into "in the"
+	// Dynamic programming over the end position of each word: from every reachable position the trie is walked forwards,
+	// so each word ending there is found in one pass and the cost is O(length * MAX_WORD_LEN). Words are scored by their
+	// unigram probability, with the first word's probability mixed with its probability given the preceding words.
+	class WordSegmenter
+	{
+	private:
+		const Lexicon *_pLexicon;
+		std::vector<float> _scores;			// Best log probability of the text up to each position
+		std::vector<uint32_t> _starts;		// Start of the last word on the best path to each position
+		std::vector<uint32_t> _wordIds;		// Last word on the best path to each position
+		std::vector<uint32_t> _path;
+
+	public:
+		WordSegmenter(void);
+		~WordSegmenter(void);
+
+		void SetLexicon(const Lexicon *pLexicon) { _pLexicon = pLexicon; }
+		bool Segment(const KPTUniCharT *text, size_t length, const std::vector<ContextPredictionT> &firstWords, std::wstring &result);
+
+	private:
+		float GetWordScore(uint32_t wordId, float totalFrequency, const std::vector<ContextPredictionT> *pFirstWords) const;
+	};
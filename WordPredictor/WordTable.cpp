@@ -0,0 +1,104 @@
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+#include "stdafx.h"
+#include <algorithm>
+#include "Lexicon.h"
+#include "WordTable.h"
+
+	// Constructor
+	WordTable::WordTable(void)
+	{
+		_mask = 0;
+	}
+
+	// Destructor
+	WordTable::~WordTable(void)
+	{
+	}
+
+	// Empty the table, giving it a power of two number of slots
+	void WordTable::Reset(size_t slotCount)
+	{
+		WordSlotT emptySlot = { WORD_TABLE_NO_ENTRY, 0 };
+		_slots.assign(slotCount, emptySlot);
+		_mask = slotCount != 0 ? slotCount - 1 : 0;
+	}
+
+	// Empty the table and free its slots
+	void WordTable::Release(void)
+	{
+		std::vector<WordSlotT>().swap(_slots);
+		_mask = 0;
+	}
+
+	// Add a word that isn't in the table, in the first empty slot of its probe sequence
+	void WordTable::Insert(uint32_t entry, uint64_t hash)
+	{
+		size_t slot = GetHome(hash);
+		while (_slots[slot].entry != WORD_TABLE_NO_ENTRY)
+		{
+			slot = GetNext(slot);
+		}
+		_slots[slot].entry = entry;
+		_slots[slot].hash = (uint32_t)hash;
+	}
+
+	// Remove a word, shifting back any later words in its probe sequence
+	void WordTable::Remove(uint32_t entry, uint64_t hash)
+	{
+		size_t hole = FindSlot(entry, hash);
+		for (size_t next = GetNext(hole); _slots[next].entry != WORD_TABLE_NO_ENTRY; next = GetNext(next))
+		{
+			// A word can fill the hole unless its home slot lies cyclically after the hole
+			size_t home = (size_t)_slots[next].hash & _mask;
+			if (((next - home) & _mask) >= ((next - hole) & _mask))
+			{
+				_slots[hole] = _slots[next];
+				hole = next;
+			}
+		}
+		_slots[hole].entry = WORD_TABLE_NO_ENTRY;
+	}
+
+	// Record that the owner has moved a word to a different index
+	void WordTable::Renumber(uint32_t entry, uint32_t newEntry, uint64_t hash)
+	{
+		_slots[FindSlot(entry, hash)].entry = newEntry;
+	}
+
+	// See whether a word starts with some text, ignoring case
+	bool WordTable::IsMatch(const KPTUniCharT *text, const KPTUniCharT *word, size_t length)
+	{
+		for (size_t i = 0; i < length; i++)
+		{
+			if (Lexicon::Fold(text[i]) != Lexicon::Fold(word[i]))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// Find the slot of a word that is in the table
+	size_t WordTable::FindSlot(uint32_t entry, uint64_t hash) const
+	{
+		size_t slot = GetHome(hash);
+		while (_slots[slot].entry != entry)
+		{
+			slot = GetNext(slot);
+		}
+
+		return slot;
+	}
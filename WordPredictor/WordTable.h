@@ -0,0 +1,57 @@
+#pragma once
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+
+#include <vector>
+#include "kptapi.h"
+
+	#define WORD_TABLE_NO_ENTRY 0xFFFFFFFF
+
+	// Slot of a word hash table
+	struct WordSlotT
+	{
+		uint32_t entry;			// Index of the word, or WORD_TABLE_NO_ENTRY if the slot is empty
+		uint32_t hash;			// Low bits of the hash of the case-folded word
+	};
+
+	// Open-addressing hash table with linear probing that maps words to the indexes where their owner stores them,
+	// with a power of two number of slots that the owner keeps at most half full. Each slot keeps the low bits of its
+	// word's hash, so a word can be removed by shifting back the later words in its probe sequence without looking
+	// them up, and most mismatches in a probe are ruled out without reading the words.
+	class WordTable
+	{
+	private:
+		std::vector<WordSlotT> _slots;
+		size_t _mask;
+
+	public:
+		WordTable(void);
+		~WordTable(void);
+
+		void Reset(size_t slotCount);
+		void Release(void);
+		size_t SlotCount(void) const { return _slots.size(); }
+		uint32_t GetEntry(size_t slot) const { return _slots[slot].entry; }
+		size_t GetHome(uint64_t hash) const { return (size_t)hash & _mask; }
+		size_t GetNext(size_t slot) const { return (slot + 1) & _mask; }
+		bool IsHashMatch(size_t slot, uint64_t hash) const { return _slots[slot].hash == (uint32_t)hash; }
+
+		void Insert(uint32_t entry, uint64_t hash);
+		void Remove(uint32_t entry, uint64_t hash);
+		void Renumber(uint32_t entry, uint32_t newEntry, uint64_t hash);
+		static bool IsMatch(const KPTUniCharT *text, const KPTUniCharT *word, size_t length);
+
+	private:
+		size_t FindSlot(uint32_t entry, uint64_t hash) const;
+	};
@@ -0,0 +1,105 @@
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+
+#include "stdafx.h"
+#include <string>
+#include <vector>
+#include "AbbreviationTable.h"
+#include "Constants.h"
+#include "TestUtils.h"
+
+#define TEST_ABBREVIATION_FILLERS 200
+
+// Write an abbreviations file to a folder
+static bool WriteAbbreviations(const std::wstring &folderPath, const std::string &text)
+{
+	std::vector<uint8_t> data(text.begin(), text.end());
+
+	return WriteTestFile(GetTestFilePath(folderPath, ABBREVIATION_FILE), data);
+}
+
+// Get the expansions of a word as a comma-delimited list
+static std::wstring GetExpansions(const AbbreviationTable &table, const wchar_t *word)
+{
+	std::vector<uint32_t> entries;
+	table.Find(word, wcslen(word), entries);
+
+	std::wstring list;
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		if (i != 0)
+		{
+			list += L",";
+		}
+		list.append(table.GetExpansion(entries[i]), table.GetExpansionLength(entries[i]));
+	}
+
+	return list;
+}
+
+// Check that the expansions of an abbreviation listed more than once are found in file order among many other entries
+static void TestAbbreviationOrder(void)
+{
+	std::wstring folderPath = GetTestFolder(L"AbbreviationTable");
+	std::string text = "brb\tbe right back\n";
+	char line[64];
+	for (int i = 0; i < TEST_ABBREVIATION_FILLERS; i++)
+	{
+		sprintf_s(line, sizeof(line), "a%d\tfiller %d\n", i, i);
+		text += line;
+		if (i == TEST_ABBREVIATION_FILLERS / 2)
+		{
+			text += "BRB\tbathroom break\n";
+		}
+	}
+	text += "brb\tbig red button\nno expansion\nlol\t\n\tempty\r\nttyl\ttalk to you later\r\n";
+	CHECK(WriteAbbreviations(folderPath, text));
+
+	AbbreviationTable table;
+	CHECK(table.Load(folderPath.c_str()));
+	CHECK(table.Count() == TEST_ABBREVIATION_FILLERS + 4);
+	CHECK(GetExpansions(table, L"brb") == L"be right back,bathroom break,big red button");
+	CHECK(GetExpansions(table, L"Brb") == L"be right back,bathroom break,big red button");
+	CHECK(GetExpansions(table, L"ttyl") == L"talk to you later");
+	CHECK(GetExpansions(table, L"a150") == L"filler 150");
+	CHECK(GetExpansions(table, L"br") == L"");
+	CHECK(GetExpansions(table, L"lol") == L"");
+	CHECK(GetExpansions(table, L"no") == L"");
+
+	// Every filler is found however far its probe sequence runs
+	int found = 0;
+	wchar_t word[16];
+	for (int i = 0; i < TEST_ABBREVIATION_FILLERS; i++)
+	{
+		swprintf_s(word, _countof(word), L"a%d", i);
+		std::vector<uint32_t> entries;
+		table.Find(word, wcslen(word), entries);
+		if (entries.size() == 1 && wcstol(table.GetExpansion(entries[0]) + 7, NULL, 10) == i)
+		{
+			found++;
+		}
+	}
+	CHECK(found == TEST_ABBREVIATION_FILLERS);
+
+	// A file without any valid entries leaves the table empty
+	CHECK(WriteAbbreviations(folderPath, "no expansion\n"));
+	CHECK(!table.Load(folderPath.c_str()));
+	CHECK(!table.IsLoaded() && GetExpansions(table, L"brb") == L"");
+}
+
+// Test the abbreviation table
+void TestAbbreviationTable(void)
+{
+	TestAbbreviationOrder();
+}
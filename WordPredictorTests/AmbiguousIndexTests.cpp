@@ -0,0 +1,131 @@
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+
+#include "stdafx.h"
+#include <string>
+#include <vector>
+#include "AmbiguousIndex.h"
+#include "Lexicon.h"
+#include "TestUtils.h"
+
+// Words typed with the phone keypad groups, where "home", "good", "gone", "hood" and "hone" share the keys 4663
+#define TEST_AMBIGUOUS_WORDS "good\t50\nhome\t80\ngone\t30\nhood\t10\ngoods\t5\nhomes\t40\nin\t90\ngo\t70\nx-ray\t60\n"
+#define TEST_AMBIGUOUS_EXTRA_WORDS "hone\t1000\nhome\t1\n"
+
+// Get the keypad groups
+static std::vector<std::wstring> GetKeypadGroups(void)
+{
+	const wchar_t *groups[] = { L"abc", L"def", L"ghi", L"jkl", L"mno", L"pqrs", L"tuv", L"wxyz" };
+
+	return std::vector<std::wstring>(groups, groups + _countof(groups));
+}
+
+// Follow the keys that type a word from the root, or return AMBIGUOUS_NO_NODE if no indexed word starts with them
+static uint32_t FindKeyNode(const AmbiguousIndex &index, const wchar_t *word)
+{
+	const std::vector<std::wstring> &groups = index.GetKeyGroups();
+	uint32_t nodeIndex = AMBIGUOUS_ROOT;
+	for (size_t i = 0; word[i] != L'\0' && nodeIndex != AMBIGUOUS_NO_NODE; i++)
+	{
+		uint8_t key = 0;
+		while (key < groups.size() && groups[key].find(word[i]) == std::wstring::npos)
+		{
+			key++;
+		}
+		nodeIndex = index.FindChild(nodeIndex, key);
+	}
+
+	return nodeIndex;
+}
+
+// Get the words whose keys end at a node, followed by its best longer words after a semicolon
+static std::wstring GetNodeWords(const AmbiguousIndex &index, const Lexicon &lexicon, uint32_t nodeIndex)
+{
+	const AmbiguousNodeT &node = index.GetNode(nodeIndex);
+	std::wstring list;
+	for (uint32_t i = 0; i < node.wordCount; i++)
+	{
+		list += std::wstring(i != 0 ? L"," : L"") + lexicon.GetText(index.GetWordId(node.firstWord + i));
+	}
+	list += L";";
+	for (size_t i = 0; i < MAX_AMBIGUOUS_COMPLETIONS && node.completions[i] != AMBIGUOUS_NO_WORD; i++)
+	{
+		list += std::wstring(i != 0 ? L"," : L"") + lexicon.GetText(node.completions[i]);
+	}
+
+	return list;
+}
+
+// Check which key groups are accepted
+static void TestAmbiguousKeyGroups(void)
+{
+	std::vector<std::wstring> groups = GetKeypadGroups();
+	CHECK(AmbiguousIndex::IsValidKeyGroups(groups));
+
+	AmbiguousIndex index;
+	CHECK(index.SetKeyGroups(groups));
+	CHECK(index.KeyGroupCount() == groups.size() && index.GetKeyChar(1) == L'd' && index.GetKeyChar(groups.size()) == L'\0');
+
+	// An empty group or too many groups are rejected and leave the index without any
+	groups[3].clear();
+	CHECK(!index.SetKeyGroups(groups));
+	CHECK(index.KeyGroupCount() == 0);
+	CHECK(!AmbiguousIndex::IsValidKeyGroups(std::vector<std::wstring>(MAX_KEY_GROUPS + 1, L"a")));
+}
+
+// Check the words listed at each node of the key sequence trie, best first
+static void TestAmbiguousWords(void)
+{
+	std::wstring basePath = GetTestFolder(L"AmbiguousIndex");
+	CHECK(WriteTestWordList(basePath, L"ambig1", TEST_AMBIGUOUS_WORDS));
+	CHECK(WriteTestWordList(basePath, L"ambig2", TEST_AMBIGUOUS_EXTRA_WORDS));
+
+	Lexicon lexicon;
+	CHECK(lexicon.Load(basePath.c_str(), L"ambig1"));
+	AmbiguousIndex index;
+	index.Build(lexicon);
+	CHECK(!index.IsLoaded());
+	CHECK(index.SetKeyGroups(GetKeypadGroups()));
+	index.Build(lexicon);
+	CHECK(index.IsLoaded());
+
+	// Words sharing keys are in frequency order and each node lists the best longer words below it
+	uint32_t nodeIndex = FindKeyNode(index, L"go");
+	CHECK(nodeIndex != AMBIGUOUS_NO_NODE && nodeIndex == FindKeyNode(index, L"in"));
+	CHECK(GetNodeWords(index, lexicon, nodeIndex) == L"in,go;home,good,homes");
+	nodeIndex = FindKeyNode(index, L"good");
+	CHECK(GetNodeWords(index, lexicon, nodeIndex) == L"home,good,gone,hood;homes,goods");
+	CHECK(GetNodeWords(index, lexicon, FindKeyNode(index, L"homes")) == L"homes,goods;");
+	CHECK(GetNodeWords(index, lexicon, FindKeyNode(index, L"goo")) == L";home,good,homes");
+
+	// Words with a character that isn't on any key can't be typed, and there are no nodes past the longest word
+	CHECK(FindKeyNode(index, L"x") == AMBIGUOUS_NO_NODE);
+	CHECK(FindKeyNode(index, L"goodsa") == AMBIGUOUS_NO_NODE);
+
+	// Words from a lower priority dictionary come after the others however frequent they are
+	CHECK(lexicon.Load(basePath.c_str(), L"ambig1,ambig2"));
+	index.Build(lexicon);
+	CHECK(GetNodeWords(index, lexicon, FindKeyNode(index, L"good")) == L"home,good,gone,hood,hone;homes,goods");
+
+	// Changing the key groups clears the index until it is rebuilt
+	CHECK(index.SetKeyGroups(GetKeypadGroups()));
+	CHECK(!index.IsLoaded());
+}
+
+// Test the ambiguous key index
+void TestAmbiguousIndex(void)
+{
+	TestAmbiguousKeyGroups();
+	TestAmbiguousWords();
+}
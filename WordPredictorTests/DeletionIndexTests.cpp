@@ -0,0 +1,173 @@
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+
+#include "stdafx.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "DeletionIndex.h"
+#include "EditDistance.h"
+#include "Lexicon.h"
+#include "TestUtils.h"
+
+#define TEST_DELETION_WORDS 400
+#define TEST_DELETION_PROBES 300
+#define TEST_DELETION_MAX_DISTANCE 2
+#define TEST_DELETION_PREFIX_LEN 7
+
+// Get the next pseudo-random number
+static uint32_t NextRandom(uint32_t &seed)
+{
+	seed = seed * 1103515245 + 12345;
+
+	return seed >> 16;
+}
+
+// Generate a word list of random words over a small alphabet, so that many words are close to each other
+static std::string MakeDeletionWordList(uint32_t &seed)
+{
+	std::string text;
+	for (int i = 0; i < TEST_DELETION_WORDS; i++)
+	{
+		size_t length = 3 + NextRandom(seed) % 8;
+		for (size_t j = 0; j < length; j++)
+		{
+			text += (char)('a' + NextRandom(seed) % 5);
+		}
+		text += "\n";
+	}
+
+	return text;
+}
+
+// Make an input by applying one or two random deletions, insertions, substitutions or transpositions to a word
+static std::wstring MakeProbe(uint32_t &seed, const std::wstring &word)
+{
+	std::wstring probe = word;
+	uint32_t edits = 1 + NextRandom(seed) % 2;
+	for (uint32_t e = 0; e < edits && !probe.empty(); e++)
+	{
+		size_t i = NextRandom(seed) % probe.length();
+		wchar_t ch = (wchar_t)(L'a' + NextRandom(seed) % 5);
+		switch (NextRandom(seed) % 4)
+		{
+		case 0:
+			probe.erase(i, 1);
+			break;
+		case 1:
+			probe.insert(i, 1, ch);
+			break;
+		case 2:
+			probe[i] = ch;
+			break;
+		default:
+			if (i + 1 < probe.length())
+			{
+				std::swap(probe[i], probe[i + 1]);
+			}
+			break;
+		}
+	}
+
+	return probe;
+}
+
+// Check that a lookup returns every word within the maximum edit distance of the input over the indexed prefix
+static void TestDeletionRecall(void)
+{
+	uint32_t seed = 4321;
+	std::wstring basePath = GetTestFolder(L"DeletionIndex");
+	CHECK(WriteTestWordList(basePath, L"deletion", MakeDeletionWordList(seed).c_str()));
+
+	Lexicon lexicon;
+	CHECK(lexicon.Load(basePath.c_str(), L"deletion"));
+	DeletionIndex index;
+	CHECK(index.Load(basePath.c_str(), L"deletion", TEST_DELETION_MAX_DISTANCE, TEST_DELETION_PREFIX_LEN));
+	CHECK(index.IsLoaded() && index.PrefixLength() == TEST_DELETION_PREFIX_LEN);
+
+	std::vector<uint32_t> wordIndexes;
+	size_t missed = 0;
+	size_t expectedCount = 0;
+	for (int p = 0; p < TEST_DELETION_PROBES; p++)
+	{
+		uint32_t wordId = NextRandom(seed) % lexicon.WordCount();
+		std::wstring probe = MakeProbe(seed, std::wstring(lexicon.GetText(wordId), lexicon.GetWord(wordId).length));
+		size_t probeLength = (std::min)(probe.length(), (size_t)TEST_DELETION_PREFIX_LEN);
+		index.Lookup(probe.c_str(), probe.length(), wordIndexes);
+
+		for (uint32_t w = 0; w < lexicon.WordCount(); w++)
+		{
+			size_t length;
+			const KPTUniCharT *text = index.GetText(w, length);
+			length = (std::min)(length, (size_t)TEST_DELETION_PREFIX_LEN);
+			if (EditDistance::DistanceDP(probe.c_str(), probeLength, text, length, false, NULL) <= TEST_DELETION_MAX_DISTANCE)
+			{
+				expectedCount++;
+				if (!std::binary_search(wordIndexes.begin(), wordIndexes.end(), w))
+				{
+					missed++;
+				}
+			}
+		}
+	}
+	CHECK(expectedCount >= TEST_DELETION_PROBES);
+	CHECK(missed == 0);
+
+	// Inputs are matched ignoring case
+	index.Lookup(L"ABC", 3, wordIndexes);
+	std::vector<uint32_t> lowerIndexes;
+	index.Lookup(L"abc", 3, lowerIndexes);
+	CHECK(!wordIndexes.empty() && wordIndexes == lowerIndexes);
+}
+
+// Check that the saved image is reused, and rebuilt when the word list or the settings change
+static void TestDeletionImage(void)
+{
+	std::wstring basePath = GetTestFolder(L"DeletionIndex");
+	CHECK(WriteTestWordList(basePath, L"rebuild", "colour\nflavour\n"));
+
+	DeletionIndex index;
+	std::vector<uint32_t> wordIndexes;
+	CHECK(index.Load(basePath.c_str(), L"rebuild", 1, TEST_DELETION_PREFIX_LEN));
+	index.Lookup(L"color", 5, wordIndexes);
+	CHECK(wordIndexes.size() == 1);
+	index.Lookup(L"colr", 4, wordIndexes);
+	CHECK(wordIndexes.empty());
+	index.Close();
+	CHECK(!index.IsLoaded());
+
+	// Mapping the saved image again, or with a larger distance, which means building a new image
+	CHECK(index.Load(basePath.c_str(), L"rebuild", 1, TEST_DELETION_PREFIX_LEN));
+	CHECK(index.Load(basePath.c_str(), L"rebuild", 2, TEST_DELETION_PREFIX_LEN));
+	index.Lookup(L"colr", 4, wordIndexes);
+	CHECK(wordIndexes.size() == 1);
+
+	// A changed word list replaces the image
+	index.Close();
+	CHECK(WriteTestWordList(basePath, L"rebuild", "colour\nflavour\ncolor\n"));
+	CHECK(index.Load(basePath.c_str(), L"rebuild", 2, TEST_DELETION_PREFIX_LEN));
+	index.Lookup(L"colr", 4, wordIndexes);
+	CHECK(wordIndexes.size() == 2);
+
+	// There is no index without a word list
+	CHECK(!index.Load(basePath.c_str(), L"missing", 2, TEST_DELETION_PREFIX_LEN));
+	CHECK(!index.IsLoaded());
+}
+
+// Test the deletion index
+void TestDeletionIndex(void)
+{
+	TestDeletionRecall();
+	TestDeletionImage();
+}
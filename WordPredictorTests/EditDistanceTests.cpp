@@ -0,0 +1,162 @@
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+#include "stdafx.h"
+#include <vector>
+#include <chrono>
+#include "EditDistance.h"
+#include "TestUtils.h"
+
+#define TEST_EDIT_PATTERNS 256
+#define TEST_EDIT_TEXTS (4 * EDIT_BATCH_SIZE + 3)
+#define TEST_EDIT_SHORT_LENGTH 16
+
+// Characters that random words are made of, including some outside ASCII, so that there are plenty of matches
+static const KPTUniCharT s_editAlphabet[] = { L'a', L'b', L'c', L'd', L'e', L'f', 0x00E9, 0x0101 };
+
+// Generate random words, mostly short but some up to a maximum length
+static void MakeWords(uint32_t &seed, size_t count, size_t minLength, size_t maxLength, std::vector<std::vector<KPTUniCharT>> &words)
+{
+	words.resize(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		size_t longest = (i % 16 == 15) ? maxLength : TEST_EDIT_SHORT_LENGTH;
+		size_t length = minLength + (seed >> 16) % (longest - minLength + 1);
+		words[i].resize(length);
+		for (size_t j = 0; j < length; j++)
+		{
+			seed = seed * 1103515245 + 12345;
+			words[i][j] = s_editAlphabet[(seed >> 16) % (sizeof(s_editAlphabet) / sizeof(s_editAlphabet[0]))];
+		}
+	}
+}
+
+// Check the bit-parallel kernel and each batch kernel that the CPU supports against the DP, timing them if benchmarking
+static void TestEditKernels(bool transpositions)
+{
+	uint32_t seed = 12345;
+	std::vector<std::vector<KPTUniCharT>> patterns;
+	std::vector<std::vector<KPTUniCharT>> words;
+	MakeWords(seed, TEST_EDIT_PATTERNS, 1, EDIT_MAX_PATTERN_LEN + 2, patterns);
+	MakeWords(seed, TEST_EDIT_TEXTS, 0, EDIT_MAX_PATTERN_LEN + 8, words);
+
+	const KPTUniCharT *texts[TEST_EDIT_TEXTS];
+	size_t lengths[TEST_EDIT_TEXTS];
+	size_t i, j;
+	for (j = 0; j < TEST_EDIT_TEXTS; j++)
+	{
+		texts[j] = words[j].data();
+		lengths[j] = words[j].size();
+	}
+
+	std::vector<uint32_t> expected(TEST_EDIT_PATTERNS * TEST_EDIT_TEXTS);
+	std::vector<uint32_t> expectedPrefix(TEST_EDIT_PATTERNS * TEST_EDIT_TEXTS);
+	uint32_t distances[TEST_EDIT_TEXTS];
+	uint32_t prefixDistances[TEST_EDIT_TEXTS];
+	EditDistance editDistance;
+	EditSimdLevelT simdLevel = editDistance.GetSimdLevel();
+
+	static const char *methodNames[] = { "Scalar DP", "Bit-parallel", "SSE4.1 batch", "AVX2 batch" };
+	for (int method = 0; method < 4; method++)
+	{
+		if ((method == 2 && simdLevel < eEditSimdSSE41) || (method == 3 && simdLevel < eEditSimdAVX2))
+		{
+			continue;
+		}
+
+		size_t mismatches = 0;
+		size_t prefixMismatches = 0;
+		std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+		for (i = 0; i < TEST_EDIT_PATTERNS; i++)
+		{
+			const KPTUniCharT *pattern = patterns[i].data();
+			size_t patternLength = patterns[i].size();
+			if (method == 0)
+			{
+				for (j = 0; j < TEST_EDIT_TEXTS; j++)
+				{
+					expected[i * TEST_EDIT_TEXTS + j] = EditDistance::DistanceDP(pattern, patternLength, texts[j], lengths[j], transpositions, &expectedPrefix[i * TEST_EDIT_TEXTS + j]);
+				}
+				continue;
+			}
+
+			editDistance.SetPattern(pattern, patternLength, transpositions);
+			if (method == 1)
+			{
+				for (j = 0; j < TEST_EDIT_TEXTS; j++)
+				{
+					distances[j] = editDistance.Distance(texts[j], lengths[j], &prefixDistances[j]);
+				}
+			}
+			else
+			{
+				editDistance.SetSimdLevel(method == 2 ? eEditSimdSSE41 : eEditSimdAVX2);
+				editDistance.DistanceBatch(texts, lengths, TEST_EDIT_TEXTS, distances, prefixDistances);
+			}
+
+			for (j = 0; j < TEST_EDIT_TEXTS; j++)
+			{
+				if (distances[j] != expected[i * TEST_EDIT_TEXTS + j])
+				{
+					mismatches++;
+				}
+				if (prefixDistances[j] != expectedPrefix[i * TEST_EDIT_TEXTS + j])
+				{
+					prefixMismatches++;
+				}
+			}
+		}
+		std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+
+		if (IsBenchmark())
+		{
+			long long micros = (long long)std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+			printf("%s%s: %u comparisons in %lld us\n", methodNames[method], transpositions ? " with transpositions" : "",
+				(unsigned)(TEST_EDIT_PATTERNS * TEST_EDIT_TEXTS), micros);
+		}
+		CHECK(mismatches == 0);
+		CHECK(prefixMismatches == 0);
+	}
+}
+
+// Check some distances that are known
+static void TestEditExamples(void)
+{
+	uint32_t prefixDistance;
+	CHECK(EditDistance::DistanceDP(L"kitten", 6, L"sitting", 7, false, &prefixDistance) == 3);
+	CHECK(EditDistance::DistanceDP(L"teh", 3, L"the", 3, false, &prefixDistance) == 2);
+	CHECK(EditDistance::DistanceDP(L"teh", 3, L"the", 3, true, &prefixDistance) == 1);
+	CHECK(EditDistance::DistanceDP(L"hel", 3, L"hello", 5, false, &prefixDistance) == 2 && prefixDistance == 0);
+	CHECK(EditDistance::DistanceDP(L"", 0, L"abc", 3, false, &prefixDistance) == 3 && prefixDistance == 0);
+
+	EditDistance editDistance;
+	editDistance.SetPattern(L"recieve", 7, true);
+	CHECK(editDistance.Distance(L"receive", 7, &prefixDistance) == 1);
+	CHECK(editDistance.Distance(L"", 0, &prefixDistance) == 7 && prefixDistance == 7);
+
+	// A batch kernel that the machine doesn't support is never selected
+	CHECK(editDistance.GetSimdLevel() == EditDistance::DetectSimdLevel());
+	editDistance.SetSimdLevel(eEditSimdAVX2);
+	CHECK(editDistance.GetSimdLevel() == EditDistance::DetectSimdLevel());
+	editDistance.SetSimdLevel(eEditSimdNone);
+	CHECK(editDistance.GetSimdLevel() == eEditSimdNone);
+}
+
+// Test the edit distance kernels
+void TestEditDistance(void)
+{
+	TestEditExamples();
+	TestEditKernels(false);
+	TestEditKernels(true);
+}
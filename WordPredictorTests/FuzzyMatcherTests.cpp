@@ -0,0 +1,227 @@
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+
+#include "stdafx.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "EditDistance.h"
+#include "FuzzyMatcher.h"
+#include "Lexicon.h"
+#include "TestUtils.h"
+
+#define TEST_FUZZY_WORDS 300
+#define TEST_FUZZY_INPUTS 200
+
+// Get the next pseudo-random number
+static uint32_t NextRandom(uint32_t &seed)
+{
+	seed = seed * 1103515245 + 12345;
+
+	return seed >> 16;
+}
+
+// Generate a word list of random words over a small alphabet, so that many words are close to each other
+static std::string MakeFuzzyWordList(uint32_t &seed)
+{
+	std::string text;
+	for (int i = 0; i < TEST_FUZZY_WORDS; i++)
+	{
+		size_t length = 2 + NextRandom(seed) % 7;
+		for (size_t j = 0; j < length; j++)
+		{
+			text += (char)('a' + NextRandom(seed) % 4);
+		}
+		text += "\n";
+	}
+
+	return text;
+}
+
+// Load a lexicon from a word list in the suite's scratch folder
+static bool LoadFuzzyLexicon(Lexicon &lexicon, const wchar_t *pDictName, const char *pWords)
+{
+	std::wstring basePath = GetTestFolder(L"FuzzyMatcher");
+
+	return WriteTestWordList(basePath, pDictName, pWords) && lexicon.Load(basePath.c_str(), pDictName);
+}
+
+// Type a word into a matcher from the start
+static void TypeFuzzyWord(FuzzyMatcher &matcher, const wchar_t *word)
+{
+	matcher.Reset();
+	for (size_t i = 0; word[i] != L'\0'; i++)
+	{
+		matcher.AppendChar(word[i]);
+	}
+}
+
+// Get the distance at which a word is a candidate, or UINT32_MAX if it isn't one
+static uint32_t GetCandidateDistance(const FuzzyMatcher &matcher, const Lexicon &lexicon, const wchar_t *word)
+{
+	std::vector<FuzzyCandidateT> candidates;
+	matcher.GetCandidates(FUZZY_MAX_EDIT_DISTANCE, lexicon.WordCount(), candidates);
+	uint32_t wordId = lexicon.FindWord(word, wcslen(word));
+	for (size_t i = 0; i < candidates.size(); i++)
+	{
+		if (candidates[i].wordId == wordId)
+		{
+			return candidates[i].distance;
+		}
+	}
+
+	return UINT32_MAX;
+}
+
+// Check that the candidates match an optimal string alignment distance calculation for random inputs:
+// every word within the maximum distance is found, and nothing is closer than its nearest prefix
+static void TestFuzzyDistances(void)
+{
+	uint32_t seed = 2468;
+	Lexicon lexicon;
+	CHECK(LoadFuzzyLexicon(lexicon, L"fuzzy", MakeFuzzyWordList(seed).c_str()));
+
+	FuzzyMatcher matcher;
+	matcher.SetLexicon(&lexicon);
+	std::vector<FuzzyCandidateT> candidates;
+	std::vector<uint32_t> found(lexicon.WordCount());
+	size_t missed = 0;
+	size_t tooClose = 0;
+	size_t expectedCount = 0;
+	for (int n = 0; n < TEST_FUZZY_INPUTS; n++)
+	{
+		std::wstring input;
+		size_t length = 1 + NextRandom(seed) % 8;
+		for (size_t j = 0; j < length; j++)
+		{
+			input += (wchar_t)(L'a' + NextRandom(seed) % 4);
+		}
+		TypeFuzzyWord(matcher, input.c_str());
+		matcher.GetCandidates(FUZZY_MAX_EDIT_DISTANCE, lexicon.WordCount(), candidates);
+
+		std::fill(found.begin(), found.end(), UINT32_MAX);
+		for (size_t i = 0; i < candidates.size(); i++)
+		{
+			found[candidates[i].wordId] = candidates[i].distance;
+		}
+		for (uint32_t wordId = 0; wordId < lexicon.WordCount(); wordId++)
+		{
+			uint32_t prefixDistance;
+			uint32_t distance = EditDistance::DistanceDP(input.c_str(), input.length(), lexicon.GetText(wordId), lexicon.GetWord(wordId).length, true, &prefixDistance);
+			if (distance <= FUZZY_MAX_EDIT_DISTANCE)
+			{
+				expectedCount++;
+				if (found[wordId] > distance)
+				{
+					missed++;
+				}
+			}
+			if (found[wordId] < prefixDistance)
+			{
+				tooClose++;
+			}
+		}
+	}
+	CHECK(expectedCount >= TEST_FUZZY_INPUTS);
+	CHECK(missed == 0);
+	CHECK(tooClose == 0);
+}
+
+// Check that swapping adjacent characters counts as one edit at each position, and twice for two swaps
+static void TestFuzzyTranspositions(void)
+{
+	Lexicon lexicon;
+	CHECK(LoadFuzzyLexicon(lexicon, L"swaps", "form\t10\nfrom\t20\nfirm\t5\nsoon\t5\n"));
+	FuzzyMatcher matcher;
+	matcher.SetLexicon(&lexicon);
+
+	TypeFuzzyWord(matcher, L"form");
+	CHECK(GetCandidateDistance(matcher, lexicon, L"form") == 0);
+	CHECK(GetCandidateDistance(matcher, lexicon, L"from") == 1);
+	CHECK(GetCandidateDistance(matcher, lexicon, L"firm") == 1);
+	TypeFuzzyWord(matcher, L"ofrm");
+	CHECK(GetCandidateDistance(matcher, lexicon, L"form") == 1);
+	TypeFuzzyWord(matcher, L"fomr");
+	CHECK(GetCandidateDistance(matcher, lexicon, L"form") == 1);
+	TypeFuzzyWord(matcher, L"ofmr");
+	CHECK(GetCandidateDistance(matcher, lexicon, L"form") == 2);
+
+	// Swapping a doubled letter changes nothing, and matching ignores case
+	TypeFuzzyWord(matcher, L"SOON");
+	CHECK(GetCandidateDistance(matcher, lexicon, L"soon") == 0);
+
+	// Candidates are ranked by distance before frequency
+	std::vector<FuzzyCandidateT> candidates;
+	TypeFuzzyWord(matcher, L"form");
+	matcher.GetCandidates(FUZZY_MAX_EDIT_DISTANCE, 2, candidates);
+	CHECK(candidates.size() == 2 && candidates[0].wordId == lexicon.FindWord(L"form", 4) && candidates[1].wordId == lexicon.FindWord(L"from", 4));
+}
+
+// Check that removing characters pops back to the frontier of the shorter input, as if it had been typed afresh
+static void TestFuzzyRemoveChars(void)
+{
+	Lexicon lexicon;
+	CHECK(LoadFuzzyLexicon(lexicon, L"remove", "form\t10\nfrom\t20\nformat\t30\nforest\t15\nfoam\t5\n"));
+	FuzzyMatcher matcher;
+	FuzzyMatcher fresh;
+	matcher.SetLexicon(&lexicon);
+	fresh.SetLexicon(&lexicon);
+	std::vector<FuzzyCandidateT> candidates;
+	std::vector<FuzzyCandidateT> freshCandidates;
+
+	const wchar_t *prefixes[] = { L"", L"f", L"fr", L"fro", L"from", L"froma", L"fromat" };
+	TypeFuzzyWord(matcher, L"fromat");
+	size_t matches = 0;
+	for (size_t length = _countof(prefixes) - 1; length-- > 0; )
+	{
+		matcher.RemoveChars(1);
+		TypeFuzzyWord(fresh, prefixes[length]);
+		matcher.GetCandidates(FUZZY_MAX_EDIT_DISTANCE, lexicon.WordCount(), candidates);
+		fresh.GetCandidates(FUZZY_MAX_EDIT_DISTANCE, lexicon.WordCount(), freshCandidates);
+		if (matcher.IsValid() && matcher.Length() == length && candidates.size() == freshCandidates.size() &&
+			std::equal(candidates.begin(), candidates.end(), freshCandidates.begin(), [](const FuzzyCandidateT &a, const FuzzyCandidateT &b)
+			{
+				return a.wordId == b.wordId && a.distance == b.distance;
+			}))
+		{
+			matches++;
+		}
+	}
+	CHECK(matches == _countof(prefixes) - 1);
+
+	// Typing again after popping back extends the shorter frontier
+	TypeFuzzyWord(matcher, L"foxm");
+	matcher.RemoveChars(2);
+	matcher.AppendChar(L'r');
+	matcher.AppendChar(L'm');
+	CHECK(GetCandidateDistance(matcher, lexicon, L"form") == 0);
+
+	// Syncing keeps the common prefix and removing more characters than were typed invalidates the search
+	matcher.Sync(L"forest", 6);
+	CHECK(matcher.Length() == 6 && GetCandidateDistance(matcher, lexicon, L"forest") == 0);
+	matcher.RemoveChars(7);
+	CHECK(!matcher.IsValid());
+	matcher.GetCandidates(FUZZY_MAX_EDIT_DISTANCE, lexicon.WordCount(), candidates);
+	CHECK(candidates.empty());
+	matcher.Sync(L"foam", 4);
+	CHECK(matcher.IsValid() && GetCandidateDistance(matcher, lexicon, L"foam") == 0);
+}
+
+// Test the error-tolerant trie search
+void TestFuzzyMatcher(void)
+{
+	TestFuzzyDistances();
+	TestFuzzyTranspositions();
+	TestFuzzyRemoveChars();
+}
@@ -0,0 +1,129 @@
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+
+#include "stdafx.h"
+#include <string>
+#include "GapBuffer.h"
+#include "TestUtils.h"
+
+#define TEST_GAP_LENGTH (3 * INPUT_RETENTION_WINDOW + 7)
+#define TEST_GAP_MAX_FOOTPRINT ((2 * INPUT_RETENTION_WINDOW + MIN_INPUT_GAP_SIZE) * sizeof(KPTUniCharT))
+
+// Make text whose characters differ from their neighbours
+static std::wstring MakeGapText(size_t length)
+{
+	std::wstring text(length, L' ');
+	for (size_t i = 0; i < length; i++)
+	{
+		text[i] = (wchar_t)(L'a' + i % 26);
+	}
+
+	return text;
+}
+
+// Check that the characters held are the ones at the same positions in the text
+static bool IsHeldTextCorrect(const GapBuffer &buffer, const std::wstring &text)
+{
+	std::wstring held;
+	buffer.GetText(buffer.Start(), buffer.End() - buffer.Start(), held);
+
+	return buffer.Length() == text.size() && held == text.substr(buffer.Start(), held.size());
+}
+
+// Check that typing and pasting long text keeps only the retention window either side of the cursor
+static void TestGapTrim(void)
+{
+	std::wstring text = MakeGapText(TEST_GAP_LENGTH);
+
+	// Typed a character at a time
+	GapBuffer buffer;
+	size_t i;
+	for (i = 0; i < text.size(); i++)
+	{
+		buffer.Insert(&text[i], 1);
+	}
+	CHECK(buffer.Cursor() == text.size());
+	CHECK(buffer.Start() > 0 && buffer.Cursor() - buffer.Start() <= 2 * INPUT_RETENTION_WINDOW);
+	CHECK(IsHeldTextCorrect(buffer, text));
+	CHECK(buffer.MemoryFootprint() <= TEST_GAP_MAX_FOOTPRINT);
+
+	// Pasted all at once, which needs a wider gap until the start is discarded
+	buffer.Clear();
+	buffer.Insert(text.c_str(), text.size());
+	CHECK(buffer.Cursor() - buffer.Start() == INPUT_RETENTION_WINDOW);
+	CHECK(IsHeldTextCorrect(buffer, text));
+	CHECK(buffer.MemoryFootprint() <= TEST_GAP_MAX_FOOTPRINT);
+
+	// Moving back within the characters held
+	size_t position = buffer.Start() + 10;
+	buffer.MoveCursor(position);
+	CHECK(buffer.Cursor() == position);
+	CHECK(buffer.CharAt(position) == text[position]);
+	CHECK(IsHeldTextCorrect(buffer, text));
+}
+
+// Check moving the cursor into text that has been discarded, and editing there
+static void TestGapDiscardedText(void)
+{
+	std::wstring text = MakeGapText(TEST_GAP_LENGTH);
+	GapBuffer buffer;
+	buffer.Insert(text.c_str(), text.size());
+
+	// Nothing is known about the text there, so nothing is held
+	buffer.MoveCursor(100);
+	CHECK(buffer.Cursor() == 100 && buffer.Start() == 100 && buffer.End() == 100);
+	CHECK(buffer.Length() == text.size());
+
+	buffer.Insert(L"xyz", 3);
+	text.insert(100, L"xyz");
+	CHECK(buffer.Cursor() == 103 && buffer.CharAt(100) == L'x');
+	CHECK(IsHeldTextCorrect(buffer, text));
+
+	// Removing text after the cursor that has been discarded
+	CHECK(buffer.RemoveAfter(5) == 5);
+	text.erase(103, 5);
+	CHECK(buffer.Length() == text.size());
+	CHECK(buffer.RemoveAfter(text.size()) == text.size() - 103);
+	CHECK(buffer.Length() == 103);
+}
+
+// Check removing characters before the cursor that go back past the first character held
+static void TestGapRemoveAcrossOrigin(void)
+{
+	std::wstring text = MakeGapText(TEST_GAP_LENGTH);
+	GapBuffer buffer;
+	buffer.Insert(text.c_str(), text.size());
+
+	size_t start = buffer.Start();
+	buffer.MoveCursor(start + 5);
+	CHECK(buffer.RemoveBefore(10) == 10);
+	text.erase(start - 5, 10);
+	CHECK(buffer.Cursor() == start - 5 && buffer.Start() == start - 5);
+	CHECK(buffer.CharAt(buffer.Cursor()) == text[start - 5]);
+	CHECK(IsHeldTextCorrect(buffer, text));
+
+	// Removing more than there is stops at the start of the text
+	CHECK(buffer.RemoveBefore(text.size()) == start - 5);
+	CHECK(buffer.Cursor() == 0 && buffer.Start() == 0);
+	text.erase(0, start - 5);
+	CHECK(IsHeldTextCorrect(buffer, text));
+}
+
+// Test the gap buffer
+void TestGapBuffer(void)
+{
+	TestGapTrim();
+	TestGapDiscardedText();
+	TestGapRemoveAcrossOrigin();
+}
@@ -0,0 +1,98 @@
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+
+#include "stdafx.h"
+#include <string>
+#include "InputTokenizer.h"
+#include "TestUtils.h"
+
+// Type some text and check the current word and the words before it, as they are tracked and after rescanning
+static void TestTokenizerContext(void)
+{
+	InputTokenizer tokenizer;
+	std::wstring text(L"Hello there. The quick bro");
+	tokenizer.InsertString(text.c_str(), text.size());
+
+	std::wstring word;
+	tokenizer.GetPrefix(word);
+	CHECK(word == L"bro");
+	CHECK(tokenizer.GetContextCount() == 2);
+	tokenizer.GetContextWord(0, word);
+	CHECK(word == L"The");
+	tokenizer.GetContextWord(1, word);
+	CHECK(word == L"quick");
+	CHECK(!tokenizer.IsSentenceStart());
+
+	// Moving back to the first word of the text
+	tokenizer.SetCursor(5);
+	tokenizer.GetPrefix(word);
+	CHECK(word == L"Hello");
+	CHECK(tokenizer.GetContextCount() == 0);
+	CHECK(tokenizer.IsSentenceStart());
+
+	// Backspacing over the current word and the space before it
+	tokenizer.SetCursor(text.size());
+	tokenizer.RemoveChars(4, 0);
+	tokenizer.GetPrefix(word);
+	CHECK(word == L"quick");
+	CHECK(tokenizer.GetContextCount() == 1);
+	tokenizer.GetContextWord(0, word);
+	CHECK(word == L"The");
+}
+
+// Type repeated words until the start of the text is discarded, and return the position of the first character held
+static size_t TypeTrimmedText(InputTokenizer &tokenizer, const wchar_t *pWords, const wchar_t *pEnd)
+{
+	tokenizer.Reset();
+	std::wstring text;
+	while (text.size() < 4 * INPUT_RETENTION_WINDOW)
+	{
+		text += pWords;
+	}
+	text += pEnd;
+	tokenizer.InsertString(text.c_str(), text.size());
+
+	// Only the retention window before the cursor is kept
+	return text.size() - INPUT_RETENTION_WINDOW;
+}
+
+// Check that the text before the characters held isn't guessed at when the context is worked out
+static void TestTokenizerTrimmedStart(void)
+{
+	InputTokenizer tokenizer;
+	std::wstring word;
+
+	// The first character held is the "c" of a word, which can't be used as context
+	size_t start = TypeTrimmedText(tokenizer, L"abc ", L"ab");
+	tokenizer.SetCursor(start + 5);
+	tokenizer.GetPrefix(word);
+	CHECK(word == L"abc");
+	CHECK(tokenizer.GetContextCount() == 0);
+	CHECK(!tokenizer.IsSentenceStart());
+
+	// The first character held is a space, and it isn't known whether a sentence ended before it
+	start = TypeTrimmedText(tokenizer, L"abc. ", L"");
+	tokenizer.SetCursor(start + 4);
+	tokenizer.GetPrefix(word);
+	CHECK(word == L"abc");
+	CHECK(tokenizer.GetContextCount() == 0);
+	CHECK(!tokenizer.IsSentenceStart());
+}
+
+// Test the input tokenizer
+void TestInputTokenizer(void)
+{
+	TestTokenizerContext();
+	TestTokenizerTrimmedStart();
+}
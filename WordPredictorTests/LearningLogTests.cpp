@@ -0,0 +1,214 @@
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+#include "stdafx.h"
+#include <math.h>
+#include <vector>
+#include "LearningLog.h"
+#include "PersonalDictionary.h"
+#include "TestUtils.h"
+
+#define TEST_LOG_WORDS 300
+
+// Delete the files of a learned dictionary
+static void DeleteLearnedFiles(const std::wstring &folderPath)
+{
+	DeleteFileW(GetTestFilePath(folderPath, PD_IMAGE_FILE).c_str());
+	DeleteFileW(GetTestFilePath(folderPath, PD_LOG_FILE).c_str());
+	DeleteFileW(GetTestFilePath(folderPath, PD_OLD_LOG_FILE).c_str());
+}
+
+// Learn a word as the engine does, adding it to the dictionary and the log
+static void LearnWord(PersonalDictionary &dictionary, LearningLog &log, const wchar_t *word, uint32_t timestamp)
+{
+	size_t length = wcslen(word);
+	dictionary.AddWord(word, length, 1.0f, timestamp);
+	log.Append(word, length, 1.0f, timestamp);
+}
+
+// Make a word that differs from its neighbours
+static std::wstring MakeLogWord(size_t index)
+{
+	wchar_t word[16];
+	swprintf_s(word, 16, _T("w%uq%c"), (unsigned)index, (wchar_t)(L'a' + index % 26));
+
+	return word;
+}
+
+// Check that a reloaded dictionary has the same words and counts as the original
+static bool IsSameDictionary(const PersonalDictionary &expected, const PersonalDictionary &actual)
+{
+	if (expected.Count() != actual.Count())
+	{
+		return false;
+	}
+
+	for (uint32_t entry = 0; entry < expected.Count(); entry++)
+	{
+		float count = actual.GetCount(expected.GetText(entry), expected.GetLength(entry));
+		if (fabs(count - expected.GetEntryCount(entry)) > 0.001f)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Check that the log is replayed and that a torn or damaged record ends the replay without losing the records before it
+static void TestLogReplay(void)
+{
+	std::wstring folderPath = GetTestFolder(_T("LearningLog"));
+	std::wstring logPath = GetTestFilePath(folderPath, PD_LOG_FILE);
+	DeleteLearnedFiles(folderPath);
+
+	PersonalDictionary dictionary;
+	PersonalDictionary reloaded;
+	LearningLog log;
+	CHECK(log.Open(folderPath.c_str(), dictionary));
+	CHECK(dictionary.Count() == 0);
+	uint32_t i;
+	for (i = 0; i < TEST_LOG_WORDS; i++)
+	{
+		LearnWord(dictionary, log, MakeLogWord(i % 97).c_str(), i);
+	}
+	log.Close();
+	CHECK(log.Open(folderPath.c_str(), reloaded));
+	CHECK(reloaded.Count() == 97);
+	CHECK(IsSameDictionary(dictionary, reloaded));
+	log.Close();
+
+	// Tear the last record, as if the program stopped while writing it
+	DeleteLearnedFiles(folderPath);
+	CHECK(log.Open(folderPath.c_str(), dictionary));
+	for (i = 0; i < 10; i++)
+	{
+		LearnWord(dictionary, log, _T("alpha"), i);
+	}
+	for (i = 0; i < 5; i++)
+	{
+		LearnWord(dictionary, log, _T("beta"), i);
+	}
+	log.Close();
+
+	std::vector<uint8_t> data;
+	CHECK(ReadTestFile(logPath, data));
+	data.resize(data.size() - 3);
+	CHECK(WriteTestFile(logPath, data));
+	CHECK(log.Open(folderPath.c_str(), reloaded));
+	CHECK(reloaded.GetCount(_T("alpha"), 5) == 10.0f);
+	CHECK(reloaded.GetCount(_T("beta"), 4) == 4.0f);
+
+	// New records go after the last good one, replacing the torn bytes
+	LearnWord(reloaded, log, _T("gamma"), 20);
+	LearnWord(reloaded, log, _T("gamma"), 21);
+	log.Close();
+	CHECK(log.Open(folderPath.c_str(), dictionary));
+	CHECK(dictionary.GetCount(_T("alpha"), 5) == 10.0f);
+	CHECK(dictionary.GetCount(_T("beta"), 4) == 4.0f);
+	CHECK(dictionary.GetCount(_T("gamma"), 5) == 2.0f);
+	log.Close();
+
+	// Damage the text of the third record, which ends the replay there
+	DeleteLearnedFiles(folderPath);
+	CHECK(log.Open(folderPath.c_str(), dictionary));
+	LearnWord(dictionary, log, _T("alpha"), 1);
+	LearnWord(dictionary, log, _T("alpha"), 2);
+	LearnWord(dictionary, log, _T("beta"), 3);
+	LearnWord(dictionary, log, _T("gamma"), 4);
+	log.Close();
+
+	CHECK(ReadTestFile(logPath, data));
+	size_t offset = sizeof(LearningLogHeaderT) + 2 * (sizeof(LearningRecordT) + 5 * sizeof(KPTUniCharT)) + sizeof(LearningRecordT);
+	CHECK(offset < data.size());
+	if (offset < data.size())
+	{
+		data[offset] ^= 0x20;
+		CHECK(WriteTestFile(logPath, data));
+	}
+	CHECK(log.Open(folderPath.c_str(), reloaded));
+	CHECK(reloaded.Count() == 1);
+	CHECK(reloaded.GetCount(_T("alpha"), 5) == 2.0f);
+	CHECK(reloaded.GetCount(_T("beta"), 4) == 0.0f);
+	log.Close();
+
+	DeleteLearnedFiles(folderPath);
+}
+
+// Check that compaction saves an image, that a stale old log is ignored, and that an interrupted compaction is recovered
+static void TestLogGenerations(void)
+{
+	std::wstring folderPath = GetTestFolder(_T("LearningLog"));
+	std::wstring imagePath = GetTestFilePath(folderPath, PD_IMAGE_FILE);
+	std::wstring logPath = GetTestFilePath(folderPath, PD_LOG_FILE);
+	std::wstring oldLogPath = GetTestFilePath(folderPath, PD_OLD_LOG_FILE);
+	DeleteLearnedFiles(folderPath);
+
+	PersonalDictionary dictionary;
+	PersonalDictionary reloaded;
+	LearningLog log;
+	CHECK(log.Open(folderPath.c_str(), dictionary));
+	uint32_t i;
+	for (i = 0; i < TEST_LOG_WORDS; i++)
+	{
+		LearnWord(dictionary, log, MakeLogWord(i % 61).c_str(), i);
+	}
+	log.Flush();
+	std::vector<uint8_t> firstLog;
+	CHECK(ReadTestFile(logPath, firstLog));
+
+	// Compact, then learn more in the second generation's log
+	log.Compact(dictionary);
+	for (i = 0; i < TEST_LOG_WORDS; i++)
+	{
+		LearnWord(dictionary, log, MakeLogWord(40 + i % 53).c_str(), TEST_LOG_WORDS + i);
+	}
+	log.Close();
+
+	std::vector<uint8_t> data;
+	CHECK(ReadTestFile(imagePath, data));
+	CHECK(!ReadTestFile(oldLogPath, data));
+	CHECK(log.Open(folderPath.c_str(), reloaded));
+	CHECK(IsSameDictionary(dictionary, reloaded));
+	log.Close();
+
+	// An old log that is already in the image must not be replayed again
+	CHECK(WriteTestFile(oldLogPath, firstLog));
+	CHECK(log.Open(folderPath.c_str(), reloaded));
+	CHECK(IsSameDictionary(dictionary, reloaded));
+	CHECK(!ReadTestFile(oldLogPath, data));
+	log.Close();
+
+	// Set the current log aside as compaction does, but without writing the image
+	CHECK(ReadTestFile(logPath, data));
+	CHECK(WriteTestFile(oldLogPath, data));
+	DeleteFileW(logPath.c_str());
+	CHECK(log.Open(folderPath.c_str(), reloaded));
+	CHECK(IsSameDictionary(dictionary, reloaded));
+	CHECK(!ReadTestFile(oldLogPath, data));
+	log.Close();
+
+	// The recovered words are now in the image
+	CHECK(log.Open(folderPath.c_str(), reloaded));
+	CHECK(IsSameDictionary(dictionary, reloaded));
+	log.Close();
+
+	DeleteLearnedFiles(folderPath);
+}
+
+// Test the learning log
+void TestLearningLog(void)
+{
+	TestLogReplay();
+	TestLogGenerations();
+}
@@ -0,0 +1,78 @@
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+#include "stdafx.h"
+#include <vector>
+#include "PerfectHash.h"
+#include "TestUtils.h"
+
+#define TEST_HASH_KEYS 100000
+
+// Build a perfect hash and check that it maps the keys one to one onto the key indexes
+static bool IsPerfect(const std::vector<uint64_t> &keyHashes)
+{
+	std::vector<uint64_t> image;
+	PerfectHash perfectHash;
+	if (!PerfectHash::Build(keyHashes, image) || !perfectHash.Attach(image.data(), image.size()))
+	{
+		return false;
+	}
+
+	std::vector<bool> isUsed(keyHashes.size(), false);
+	for (size_t i = 0; i < keyHashes.size(); i++)
+	{
+		uint32_t index = perfectHash.Lookup(keyHashes[i]);
+		if (index >= keyHashes.size() || isUsed[index])
+		{
+			return false;
+		}
+		isUsed[index] = true;
+	}
+
+	return true;
+}
+
+// Test building and looking up minimal perfect hashes
+void TestPerfectHash(void)
+{
+	std::vector<uint64_t> keyHashes;
+	CHECK(IsPerfect(keyHashes));
+	keyHashes.push_back(PerfectHash::Mix(1));
+	CHECK(IsPerfect(keyHashes));
+
+	for (uint64_t i = 2; i <= TEST_HASH_KEYS; i++)
+	{
+		keyHashes.push_back(PerfectHash::Mix(i));
+	}
+	CHECK(IsPerfect(keyHashes));
+
+	// Keys that aren't in the set give an index in range, or none
+	std::vector<uint64_t> image;
+	PerfectHash perfectHash;
+	CHECK(PerfectHash::Build(keyHashes, image) && perfectHash.Attach(image.data(), image.size()));
+	size_t badLookups = 0;
+	for (uint64_t i = TEST_HASH_KEYS + 1; i <= 2 * TEST_HASH_KEYS; i++)
+	{
+		uint32_t index = perfectHash.Lookup(PerfectHash::Mix(i));
+		if (index != PERFECT_HASH_NOT_FOUND && index >= TEST_HASH_KEYS)
+		{
+			badLookups++;
+		}
+	}
+	CHECK(badLookups == 0);
+	CHECK(image.size() * 64 < 4 * TEST_HASH_KEYS);
+
+	// Two keys with the same hash can never be separated
+	keyHashes.push_back(keyHashes[0]);
+	CHECK(!PerfectHash::Build(keyHashes, image));
+}
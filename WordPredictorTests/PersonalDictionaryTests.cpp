@@ -0,0 +1,237 @@
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+#include "stdafx.h"
+#include <algorithm>
+#include <vector>
+#include "CountMinSketch.h"
+#include "PerfectHash.h"
+#include "PersonalDictionary.h"
+#include "TestUtils.h"
+
+#define TEST_PD_CAPACITY 64
+#define TEST_PD_PAGING_WORDS 600
+#define TEST_PD_REDUCED_CAPACITY 400
+
+// Make a word for the eviction tests
+static std::wstring MakeEvictionWord(const wchar_t *pPrefix, size_t index)
+{
+	wchar_t word[16];
+	swprintf_s(word, 16, _T("%s%u"), pPrefix, (unsigned)index);
+
+	return word;
+}
+
+// Learn a word a number of times
+static void LearnWord(PersonalDictionary &dictionary, const std::wstring &word, size_t repeats)
+{
+	for (size_t i = 0; i < repeats; i++)
+	{
+		dictionary.AddWord(word.c_str(), word.size(), 1.0f, 0);
+	}
+}
+
+// Check that the sketch never undercounts and that its counts are halved after each reset interval
+static void TestSketch(void)
+{
+	CountMinSketch sketch;
+	sketch.SetSize(256, 1000);
+
+	uint64_t hashes[100];
+	uint32_t counts[100] = { 0 };
+	uint64_t hash = 1;
+	size_t i;
+	for (i = 0; i < 100; i++)
+	{
+		hash = PerfectHash::Mix(hash + i);
+		hashes[i] = hash;
+	}
+
+	bool isOver = true;
+	for (i = 0; i < 900; i++)
+	{
+		size_t key = (i * i) % 100;
+		sketch.Add(hashes[key]);
+		counts[key]++;
+	}
+	for (i = 0; i < 100; i++)
+	{
+		isOver = isOver && sketch.Estimate(hashes[i]) >= counts[i];
+	}
+	CHECK(isOver);
+
+	// Reach the reset interval, allowing for the last sighting sharing a counter
+	for (i = 0; i < 99; i++)
+	{
+		sketch.Add(hashes[99]);
+	}
+	uint32_t before = sketch.Estimate(hashes[0]);
+	sketch.Add(hashes[99]);
+	uint32_t after = sketch.Estimate(hashes[0]);
+	CHECK(after >= before / 2 && after <= (before + 1) / 2);
+
+	sketch.Clear();
+	CHECK(sketch.Estimate(hashes[0]) == 0);
+}
+
+// Check that CLOCK evicts a word that hasn't been used since the hand last passed, and that TinyLFU admission keeps frequent words
+static void TestEviction(void)
+{
+	PersonalDictionary dictionary;
+	dictionary.SetCapacity(TEST_PD_CAPACITY);
+	size_t i;
+	for (i = 0; i < TEST_PD_CAPACITY; i++)
+	{
+		LearnWord(dictionary, MakeEvictionWord(_T("w"), i), 3);
+	}
+	CHECK(dictionary.Count() == TEST_PD_CAPACITY);
+
+	// A word seen once isn't admitted over a more frequent word, but the hand clears the used flags on the way round
+	LearnWord(dictionary, _T("z"), 1);
+	CHECK(dictionary.Find(_T("z"), 1) == PD_NO_ENTRY);
+
+	// Use every word again except the first, so the hand stops there until something is admitted
+	for (i = 1; i < TEST_PD_CAPACITY; i++)
+	{
+		LearnWord(dictionary, MakeEvictionWord(_T("w"), i), 1);
+	}
+	size_t tries = 1;
+	while (dictionary.Find(_T("z"), 1) == PD_NO_ENTRY && tries < 50)
+	{
+		LearnWord(dictionary, _T("z"), 1);
+		tries++;
+	}
+	CHECK(dictionary.Find(_T("z"), 1) != PD_NO_ENTRY);
+	CHECK(dictionary.Find(_T("w0"), 2) == PD_NO_ENTRY);
+	size_t kept = 0;
+	for (i = 1; i < TEST_PD_CAPACITY; i++)
+	{
+		std::wstring word = MakeEvictionWord(_T("w"), i);
+		if (dictionary.Find(word.c_str(), word.size()) != PD_NO_ENTRY)
+		{
+			kept++;
+		}
+	}
+	CHECK(kept == TEST_PD_CAPACITY - 1);
+	CHECK(dictionary.Count() == TEST_PD_CAPACITY);
+
+	// A scan of words seen once displaces few of the frequent words
+	for (i = 0; i < TEST_PD_CAPACITY; i++)
+	{
+		LearnWord(dictionary, MakeEvictionWord(_T("x"), i), 1);
+	}
+	kept = 0;
+	for (i = 1; i < TEST_PD_CAPACITY; i++)
+	{
+		std::wstring word = MakeEvictionWord(_T("w"), i);
+		if (dictionary.Find(word.c_str(), word.size()) != PD_NO_ENTRY)
+		{
+			kept++;
+		}
+	}
+	CHECK(kept >= (TEST_PD_CAPACITY * 3) / 4);
+	CHECK(dictionary.Count() == TEST_PD_CAPACITY);
+}
+
+// Check every page of each view against the words sorted directly
+static bool IsPagingCorrect(const PersonalDictionary &dictionary)
+{
+	static const KPTPDViewOptionT views[] = { eKPTPDViewAlphaAscending, eKPTPDViewAlphaDescending, eKPTPDViewMostFrequentFirst,
+		eKPTPDViewLeastFrequentFirst, eKPTPDViewNewestFirst, eKPTPDViewOldestFirst };
+	static const PersonalOrderT orders[] = { ePersonalOrderAlpha, ePersonalOrderAlpha, ePersonalOrderFrequency,
+		ePersonalOrderFrequency, ePersonalOrderTime, ePersonalOrderTime };
+
+	size_t count = dictionary.Count();
+	std::vector<uint32_t> expected(count);
+	std::vector<uint32_t> page;
+	for (size_t v = 0; v < sizeof(views) / sizeof(views[0]); v++)
+	{
+		for (uint32_t entry = 0; entry < count; entry++)
+		{
+			expected[entry] = entry;
+		}
+		std::sort(expected.begin(), expected.end(), [&](uint32_t a, uint32_t b) { return dictionary.IsBefore(orders[v], a, b); });
+		if (views[v] == eKPTPDViewAlphaDescending || views[v] == eKPTPDViewMostFrequentFirst || views[v] == eKPTPDViewNewestFirst)
+		{
+			std::reverse(expected.begin(), expected.end());
+		}
+
+		size_t firsts[] = { 0, 1, PD_PAGE_WORDS - 1, PD_PAGE_WORDS, count / 2, count - 10, count };
+		for (size_t f = 0; f < sizeof(firsts) / sizeof(firsts[0]); f++)
+		{
+			size_t first = firsts[f];
+			if (!dictionary.GetPage(views[v], first, PD_PAGE_WORDS, page))
+			{
+				return false;
+			}
+
+			size_t end = (std::min)(first + PD_PAGE_WORDS, count);
+			if (page.size() != end - first || !std::equal(page.begin(), page.end(), expected.begin() + first))
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+// Check the sorted views, after learning and after words are removed when the capacity is reduced
+static void TestPaging(void)
+{
+	PersonalDictionary dictionary;
+	uint32_t seed = 4321;
+	size_t i;
+	for (i = 0; i < TEST_PD_PAGING_WORDS; i++)
+	{
+		wchar_t word[16];
+		size_t length = 0;
+		seed = seed * 1103515245 + 12345;
+		size_t wordLength = 2 + (seed >> 16) % 8;
+		while (length < wordLength)
+		{
+			seed = seed * 1103515245 + 12345;
+			wchar_t ch = (wchar_t)(L'a' + (seed >> 16) % 6);
+			word[length] = (length == 0 && (seed & 0x10000000) != 0) ? (wchar_t)towupper(ch) : ch;
+			length++;
+		}
+		word[length] = L'\0';
+		seed = seed * 1103515245 + 12345;
+		float delta = 1.0f + (seed >> 16) % 5;
+		dictionary.AddWord(word, length, delta, (seed >> 8) % 1000);
+	}
+	CHECK(dictionary.Count() > PD_PAGE_WORDS * 2);
+	CHECK(IsPagingCorrect(dictionary));
+
+	// Learning a known word again moves it in the frequency view only
+	dictionary.AddWord(dictionary.GetText(0), dictionary.GetLength(0), 20.0f, 5000);
+	CHECK(IsPagingCorrect(dictionary));
+
+	if (dictionary.Count() > TEST_PD_REDUCED_CAPACITY)
+	{
+		dictionary.SetCapacity(TEST_PD_REDUCED_CAPACITY);
+		CHECK(dictionary.Count() == TEST_PD_REDUCED_CAPACITY);
+		CHECK(IsPagingCorrect(dictionary));
+	}
+
+	std::vector<uint32_t> page;
+	CHECK(!dictionary.GetPage((KPTPDViewOptionT)0, 0, PD_PAGE_WORDS, page) && page.empty());
+}
+
+// Test the personal dictionary's frequency sketch, eviction and sorted views
+void TestPersonalDictionary(void)
+{
+	TestSketch();
+	TestEviction();
+	TestPaging();
+}
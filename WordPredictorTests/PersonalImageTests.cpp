@@ -0,0 +1,134 @@
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+#include "stdafx.h"
+#include <map>
+#include <string>
+#include <vector>
+#include "PersonalDictionary.h"
+#include "PersonalImage.h"
+#include "TestUtils.h"
+
+#define TEST_IMAGE_WORDS 500
+
+// Expected fields of a saved word
+struct TestImageWordT
+{
+	float count;
+	uint32_t firstLearned;
+};
+
+// Check that the words of a dictionary come back from its blocked image with their counts and times, and that damage is confined to its block
+static void TestImageRoundTrip(void)
+{
+	// Words with shared prefixes, including a character outside ASCII, learned at times that go backwards as well as forwards
+	PersonalDictionary dictionary;
+	std::map<std::wstring, TestImageWordT> expected;
+	uint32_t seed = 777;
+	size_t i;
+	for (i = 0; i < TEST_IMAGE_WORDS; i++)
+	{
+		static const wchar_t s_imageAlphabet[] = { L'a', L'b', L'c', L'd', 0x00E9 };
+		std::wstring word;
+		seed = seed * 1103515245 + 12345;
+		size_t length = 1 + (seed >> 16) % 10;
+		while (word.size() < length)
+		{
+			seed = seed * 1103515245 + 12345;
+			word += s_imageAlphabet[(seed >> 16) % (sizeof(s_imageAlphabet) / sizeof(s_imageAlphabet[0]))];
+		}
+		seed = seed * 1103515245 + 12345;
+		uint32_t timestamp = 1000000 + (seed >> 12);
+		dictionary.AddWord(word.c_str(), word.size(), 1.0f, timestamp);
+		if (expected.find(word) == expected.end())
+		{
+			expected[word].firstLearned = timestamp;
+		}
+	}
+	for (uint32_t entry = 0; entry < dictionary.Count(); entry++)
+	{
+		expected[std::wstring(dictionary.GetText(entry), dictionary.GetLength(entry))].count = dictionary.GetEntryCount(entry);
+	}
+
+	std::wstring folderPath = GetTestFolder(_T("PersonalImage"));
+	std::wstring imagePath = GetTestFilePath(folderPath, PD_IMAGE_FILE);
+	PersonalSnapshotT snapshot;
+	dictionary.Snapshot(snapshot);
+	CHECK(PersonalImage::Write(imagePath.c_str(), snapshot, 7));
+
+	PersonalImage image;
+	CHECK(image.Open(imagePath.c_str()));
+	CHECK(image.Header().generation == 7);
+	CHECK(image.Header().wordCount == dictionary.Count());
+	size_t blockCount = (dictionary.Count() + PD_IMAGE_BLOCK_WORDS - 1) / PD_IMAGE_BLOCK_WORDS;
+	CHECK(image.BlockCount() == blockCount);
+
+	std::vector<PersonalImageEntryT> entries;
+	size_t wordCount = 0;
+	size_t mismatches = 0;
+	for (size_t block = 0; block < image.BlockCount(); block++)
+	{
+		CHECK(image.ReadBlock(block, entries));
+		for (i = 0; i < entries.size(); i++)
+		{
+			std::map<std::wstring, TestImageWordT>::const_iterator it = expected.find(std::wstring(entries[i].text, entries[i].length));
+			if (it == expected.end() || it->second.count != entries[i].count || it->second.firstLearned != entries[i].firstLearned ||
+				entries[i].text[entries[i].length] != L'\0')
+			{
+				mismatches++;
+			}
+		}
+		wordCount += entries.size();
+	}
+	CHECK(wordCount == expected.size());
+	CHECK(mismatches == 0);
+	CHECK(!image.ReadBlock(blockCount, entries));
+	image.Close();
+
+	// Damage the last byte, which belongs to the last block
+	std::vector<uint8_t> data;
+	CHECK(ReadTestFile(imagePath, data));
+	data.back() ^= 0x01;
+	CHECK(WriteTestFile(imagePath, data));
+	CHECK(image.Open(imagePath.c_str()));
+	CHECK(image.ReadBlock(0, entries) && entries.size() == PD_IMAGE_BLOCK_WORDS);
+	CHECK(!image.ReadBlock(blockCount - 1, entries));
+	image.Close();
+
+	DeleteFileW(imagePath.c_str());
+}
+
+// Check that an empty dictionary is saved
+static void TestImageEmpty(void)
+{
+	std::wstring folderPath = GetTestFolder(_T("PersonalImage"));
+	std::wstring imagePath = GetTestFilePath(folderPath, PD_IMAGE_FILE);
+	PersonalDictionary dictionary;
+	PersonalSnapshotT snapshot;
+	dictionary.Snapshot(snapshot);
+	CHECK(PersonalImage::Write(imagePath.c_str(), snapshot, 1));
+
+	PersonalImage image;
+	CHECK(image.Open(imagePath.c_str()));
+	CHECK(image.BlockCount() == 0);
+	image.Close();
+
+	DeleteFileW(imagePath.c_str());
+}
+
+// Test the front-coded personal dictionary image
+void TestPersonalImage(void)
+{
+	TestImageRoundTrip();
+	TestImageEmpty();
+}
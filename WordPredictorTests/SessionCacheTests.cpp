@@ -0,0 +1,114 @@
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+
+#include "stdafx.h"
+#include <math.h>
+#include <string>
+#include <vector>
+#include "SessionCache.h"
+#include "TestUtils.h"
+
+// Add a word to the cache
+static void AddSessionWord(SessionCache &cache, const wchar_t *word)
+{
+	cache.AddWord(word, wcslen(word));
+}
+
+// Get the completions of a prefix as a comma-delimited list, highest weight first
+static std::wstring GetSessionCompletions(const SessionCache &cache, const wchar_t *prefix)
+{
+	std::vector<uint32_t> entries;
+	cache.FindCompletions(prefix, wcslen(prefix), 8, entries);
+
+	std::wstring list;
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		if (i != 0)
+		{
+			list += L",";
+		}
+		list.append(cache.GetText(entries[i]), cache.GetLength(entries[i]));
+	}
+
+	return list;
+}
+
+// Check that recent and repeated words rank higher, and that the weights decay as more words are typed
+static void TestSessionDecay(void)
+{
+	SessionCache cache;
+	cache.SetCapacity(16);
+	AddSessionWord(cache, L"alpha");
+	AddSessionWord(cache, L"alpine");
+	AddSessionWord(cache, L"Also");
+	CHECK(GetSessionCompletions(cache, L"al") == L"Also,alpine,alpha");
+	CHECK(GetSessionCompletions(cache, L"ALP") == L"alpine,alpha");
+	CHECK(GetSessionCompletions(cache, L"also") == L"");
+
+	// A word typed again is ranked above words typed once since
+	AddSessionWord(cache, L"alpha");
+	CHECK(GetSessionCompletions(cache, L"al") == L"alpha,Also,alpine");
+	CHECK(cache.GetWeight(L"ALPHA", 5) > 1.0f);
+
+	float weight = cache.GetWeight(L"also", 4);
+	CHECK(fabs(weight - SESSION_CACHE_DECAY) < 1e-5f);
+	AddSessionWord(cache, L"beta");
+	CHECK(fabs(cache.GetWeight(L"also", 4) - weight * SESSION_CACHE_DECAY) < 1e-5f);
+	CHECK(cache.GetWeight(L"gamma", 5) == 0.0f);
+}
+
+// Check that a word is forgotten once its last occurrence leaves the window
+static void TestSessionEviction(void)
+{
+	SessionCache cache;
+	cache.SetCapacity(4);
+	AddSessionWord(cache, L"one");
+	AddSessionWord(cache, L"two");
+	AddSessionWord(cache, L"one");
+	AddSessionWord(cache, L"three");
+	CHECK(cache.Count() == 4 && cache.DistinctCount() == 3);
+
+	// The first "one" leaves the window, but the second is still in it
+	AddSessionWord(cache, L"four");
+	CHECK(cache.Count() == 4 && cache.DistinctCount() == 4);
+	CHECK(cache.GetWeight(L"one", 3) > 0.0f);
+	CHECK(GetSessionCompletions(cache, L"o") == L"one");
+
+	AddSessionWord(cache, L"tea");
+	CHECK(cache.GetWeight(L"two", 3) == 0.0f);
+	CHECK(GetSessionCompletions(cache, L"t") == L"tea,three");
+	AddSessionWord(cache, L"ten");
+	CHECK(cache.GetWeight(L"one", 3) == 0.0f);
+	CHECK(GetSessionCompletions(cache, L"o") == L"");
+	CHECK(cache.Count() == 4 && cache.DistinctCount() == 4);
+
+	// Words leaving the middle and end of a first letter list don't break it
+	AddSessionWord(cache, L"fig");
+	AddSessionWord(cache, L"tan");
+	CHECK(GetSessionCompletions(cache, L"t") == L"tan,ten,tea");
+	AddSessionWord(cache, L"five");
+	AddSessionWord(cache, L"fun");
+	CHECK(GetSessionCompletions(cache, L"t") == L"tan");
+	CHECK(GetSessionCompletions(cache, L"f") == L"fun,five,fig");
+
+	cache.Clear();
+	CHECK(cache.Count() == 0 && GetSessionCompletions(cache, L"f") == L"");
+}
+
+// Test the session cache
+void TestSessionCache(void)
+{
+	TestSessionDecay();
+	TestSessionEviction();
+}
@@ -0,0 +1,137 @@
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+#include "stdafx.h"
+#include <string.h>
+#include "Constants.h"
+#include "TestUtils.h"
+
+static unsigned s_checkCount = 0;
+static unsigned s_failureCount = 0;
+static bool s_isBenchmark = false;
+
+// Record the result of a check, reporting where it failed
+bool CheckTest(bool condition, const char *text, const char *file, int line)
+{
+	s_checkCount++;
+	if (!condition)
+	{
+		s_failureCount++;
+		printf("FAILED: %s (%s:%d)\n", text, file, line);
+	}
+
+	return condition;
+}
+
+// Whether timings should be reported
+bool IsBenchmark(void)
+{
+	return s_isBenchmark;
+}
+
+// Get the path of a folder for a suite's scratch files in the temporary folder, creating it if need be
+std::wstring GetTestFolder(const wchar_t *pName)
+{
+	wchar_t tempPath[MAX_PATH];
+	if (GetTempPathW(MAX_PATH, tempPath) == 0)
+	{
+		wcscpy_s(tempPath, MAX_PATH, _T(".\\"));
+	}
+
+	std::wstring folderPath = std::wstring(tempPath) + _T("WordPredictorTests");
+	CreateDirectoryW(folderPath.c_str(), NULL);
+	folderPath += std::wstring(_T("\\")) + pName;
+	CreateDirectoryW(folderPath.c_str(), NULL);
+
+	return folderPath;
+}
+
+// Get the path of a file in a folder
+std::wstring GetTestFilePath(const std::wstring &folderPath, const wchar_t *pFileName)
+{
+	return folderPath + _T("\\") + pFileName;
+}
+
+// Read the whole of a file, or return false if it can't be read
+bool ReadTestFile(const std::wstring &filePath, std::vector<uint8_t> &data)
+{
+	data.clear();
+	FILE *pFile = NULL;
+	if (_wfopen_s(&pFile, filePath.c_str(), _T("rb")) != 0 || pFile == NULL)
+	{
+		return false;
+	}
+
+	uint8_t buffer[4096];
+	size_t numRead;
+	while ((numRead = fread(buffer, 1, sizeof(buffer), pFile)) > 0)
+	{
+		data.insert(data.end(), buffer, buffer + numRead);
+	}
+	fclose(pFile);
+
+	return true;
+}
+
+// Replace the contents of a file
+bool WriteTestFile(const std::wstring &filePath, const std::vector<uint8_t> &data)
+{
+	FILE *pFile = NULL;
+	if (_wfopen_s(&pFile, filePath.c_str(), _T("wb")) != 0 || pFile == NULL)
+	{
+		return false;
+	}
+
+	bool success = fwrite(data.data(), 1, data.size(), pFile) == data.size();
+
+	return (fclose(pFile) == 0) && success;
+}
+
+// Write a dictionary's word list, with one word[<tab>frequency] entry per line, to the Lexicon folder of a base path
+bool WriteTestWordList(const std::wstring &basePath, const wchar_t *pDictName, const char *pWords)
+{
+	std::wstring folderPath = GetTestFilePath(basePath, LEXICON_FOLDER);
+	CreateDirectoryW(folderPath.c_str(), NULL);
+
+	std::vector<uint8_t> data(pWords, pWords + strlen(pWords));
+	return WriteTestFile(GetTestFilePath(folderPath, (std::wstring(pDictName) + LEXICON_FILE_EXT).c_str()), data);
+}
+
+// Run the test suites, and return the number of failed checks
+int main(int argc, char *argv[])
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--benchmark") == 0)
+		{
+			s_isBenchmark = true;
+		}
+	}
+
+	TestAbbreviationTable();
+	TestAmbiguousIndex();
+	TestDeletionIndex();
+	TestEditDistance();
+	TestFuzzyMatcher();
+	TestGapBuffer();
+	TestInputTokenizer();
+	TestLearningLog();
+	TestPersonalDictionary();
+	TestPersonalImage();
+	TestPerfectHash();
+	TestSessionCache();
+
+	printf("%u checks, %u failed\n", s_checkCount, s_failureCount);
+
+	return s_failureCount != 0 ? 1 : 0;
+}
@@ -0,0 +1,47 @@
+#pragma once
+/******************************************************************************
+*
+* Copyright 2019 Tim Brogden
+* All rights reserved. The Keysticks software and accompanying materials
+* are made available under the terms of the Eclipse Public License v1.0
+* which accompanies this distribution, and is available at
+* http://www.eclipse.org/legal/epl-v10.html
+*
+* Contributors:
+* KeyPoint Technologies (UK) Ltd - OpenAdaptxt API and implementation
+* Tim Brogden - WordPredictor COM component with demo application
+*
+*****************************************************************************/
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+	// Record the result of a check, reporting where it failed
+	#define CHECK(condition) CheckTest((condition), #condition, __FILE__, __LINE__)
+
+	bool CheckTest(bool condition, const char *text, const char *file, int line);
+
+	// Whether timings should be reported, when the tests are run with --benchmark
+	bool IsBenchmark(void);
+
+	// Scratch files in the temporary folder
+	std::wstring GetTestFolder(const wchar_t *pName);
+	std::wstring GetTestFilePath(const std::wstring &folderPath, const wchar_t *pFileName);
+	bool ReadTestFile(const std::wstring &filePath, std::vector<uint8_t> &data);
+	bool WriteTestFile(const std::wstring &filePath, const std::vector<uint8_t> &data);
+	bool WriteTestWordList(const std::wstring &basePath, const wchar_t *pDictName, const char *pWords);
+
+	// Test suites
+	void TestAbbreviationTable(void);
+	void TestAmbiguousIndex(void);
+	void TestDeletionIndex(void);
+	void TestEditDistance(void);
+	void TestFuzzyMatcher(void);
+	void TestGapBuffer(void);
+	void TestInputTokenizer(void);
+	void TestLearningLog(void);
+	void TestPersonalDictionary(void);
+	void TestPersonalImage(void);
+	void TestPerfectHash(void);
+	void TestSessionCache(void);